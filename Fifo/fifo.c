@@ -1,4 +1,7 @@
 // *** INCLUDES ***
+#ifndef _GNU_SOURCE
+#define _GNU_SOURCE     // memfd_create() for FIFO_MIRROR
+#endif
 #include "fifo.h"
 #include <string.h> // memcpy 
 #ifdef _DEBUG
@@ -6,11 +9,571 @@
 #endif
 #if FIFO_ALLOW_MALLOC == true
     #include <malloc.h>
+    #include <stdlib.h> // aligned_alloc
 #endif /* FIFO_ALLOW_MALLOC */
+#if FIFO_MIRROR && FIFO_ALLOW_MALLOC
+    #include <sys/mman.h>
+    #include <unistd.h>
+#endif /* FIFO_MIRROR */
+#if FIFO_NOTIFY
+    #include <stdint.h>
+    #include <sys/eventfd.h>
+    #include <unistd.h>
+#endif /* FIFO_NOTIFY */
+#if FIFO_WAIT
+    #include <errno.h>
+    #include <limits.h>
+    #include <linux/futex.h>
+    #include <sys/syscall.h>
+    #include <unistd.h>
+#endif /* FIFO_WAIT */
 
 // *** DEFINES ***
 #define _WRITE_LOCK 0x01
 #define _READ_LOCK  0x02
+#define _RECORD_PAD UINT32_MAX      // length prefix of the skip marker at the end of the fifo memory
+
+#if FIFO_SPSC
+    // the index of the other side is loaded with acquire and the own index is published with release,
+    // so the element memory is always complete before the other side can see the index that covers it
+    #define _LOAD_IDX(idx)          __atomic_load_n(&(idx), __ATOMIC_ACQUIRE)
+    #define _STORE_IDX(idx, val)    __atomic_store_n(&(idx), (val), __ATOMIC_RELEASE)
+    #define _IS_LOCKED(pHandle, lock)   false
+    #define _ENTER_CRITICAL()
+    #define _LEAVE_CRITICAL()
+#else
+    #define _LOAD_IDX(idx)          (idx)
+    #define _STORE_IDX(idx, val)    ((idx) = (val))
+    #define _IS_LOCKED(pHandle, lock)   ((pHandle)->_lock & (lock))
+    #define _ENTER_CRITICAL()       FIFO_ENTER_CRITICAL()
+    #define _LEAVE_CRITICAL()       FIFO_LEAVE_CRITICAL()
+#endif
+
+#if FIFO_OVERWRITE
+    // an overwriting producer moves read_idx, so the consumer has to load it like the index of the other side
+    #define _OWN_READ_IDX(pHandle)  _LOAD_IDX((pHandle)->read_idx)
+    // only fifo_get() releases with a compare and swap, the other read functions would undo a drop of the producer
+    #define _IS_OVERWRITING(pHandle)    ((pHandle)->overwrite)
+    // loaded by the consumer before read_idx, if no element was dropped until the release the read_idx seen is current
+    #define _DROPPED(pHandle)           __atomic_load_n(&(pHandle)->dropped, __ATOMIC_ACQUIRE)
+#else
+    #define _OWN_READ_IDX(pHandle)  ((pHandle)->read_idx)
+    #define _IS_OVERWRITING(pHandle)    false
+    #define _DROPPED(pHandle)           0
+#endif
+
+#if FIFO_WAIT
+    // wake the threads parked in fifo_get_wait() / fifo_put_wait() after elements were put / got
+    #define _NOTIFY_DATA(pHandle)   _wake(&(pHandle)->_data_seq, &(pHandle)->_data_waiters)
+    #define _NOTIFY_SPACE(pHandle)  _wake(&(pHandle)->_space_seq, &(pHandle)->_space_waiters)
+#else
+    #define _NOTIFY_DATA(pHandle)
+    #define _NOTIFY_SPACE(pHandle)
+#endif
+
+#if FIFO_NOTIFY
+    // call the notify callback of a fifo that was empty before the elements after write_idx were published
+    #define _NOTIFY_READY(pHandle, write_idx)   _notifyReady(pHandle, write_idx)
+    // look at write_idx a last time before the consumer returns FIFO_EMPTY, true = elements were put in the meantime
+    #define _RECHECK_EMPTY(pHandle, read_idx, pWriteIdx)   _recheckEmpty(pHandle, read_idx, pWriteIdx)
+#else
+    #define _NOTIFY_READY(pHandle, write_idx)
+    #define _RECHECK_EMPTY(pHandle, read_idx, pWriteIdx)   false
+#endif
+
+// *** STATIC FUNCTIONS ***
+/**
+ * @brief sets a lock flag of the handle
+ * @retval true = locked by this call
+ * @retval false = the flag was already set
+ */
+static inline bool _lock(volatile fifo_handle_t *pHandle, uint8_t lock)
+{
+#if FIFO_SPSC
+    (void)pHandle;
+    (void)lock;
+    return true;
+#else
+    if (pHandle->_lock & lock)
+    {
+        return false;
+    }
+    FIFO_ENTER_CRITICAL();  // writing to lock may not be a atomic operation
+    pHandle->_lock |= lock;
+    FIFO_LEAVE_CRITICAL();
+    return true;
+#endif
+}
+
+/**
+ * @brief clears a lock flag of the handle
+ */
+static inline void _unlock(volatile fifo_handle_t *pHandle, uint8_t lock)
+{
+#if FIFO_SPSC
+    (void)pHandle;
+    (void)lock;
+#else
+    FIFO_ENTER_CRITICAL();
+    pHandle->_lock &= ~lock;
+    FIFO_LEAVE_CRITICAL();
+#endif
+}
+
+#if FIFO_WAIT
+/**
+ * @brief wakes all threads parked on a futex word, the system call is only made if a thread is registered in *pWaiters
+ * @note the fence orders the index update of the caller before the load of *pWaiters, a waiter registers in *pWaiters
+ * before it checks the fifo a last time, so either the waiter sees the new index or the caller sees the waiter
+ */
+static inline void _wake(volatile uint32_t *pSeq, volatile uint32_t *pWaiters)
+{
+    __atomic_thread_fence(__ATOMIC_SEQ_CST);
+    if (__atomic_load_n(pWaiters, __ATOMIC_RELAXED) != 0)
+    {
+        __atomic_fetch_add(pSeq, 1, __ATOMIC_RELEASE);
+        syscall(SYS_futex, (uint32_t *)pSeq, FUTEX_WAKE_PRIVATE, INT_MAX, NULL, NULL, 0);
+    }
+}
+
+/**
+ * @brief parks the calling thread until *pSeq is no longer seq, it gets woken or pDeadline has passed
+ * @param pDeadline absolute CLOCK_MONOTONIC time, NULL = no deadline
+ * @retval false = the deadline has passed
+ */
+static bool _park(volatile uint32_t *pSeq, uint32_t seq, const struct timespec *pDeadline)
+{
+    long ret = syscall(SYS_futex, (uint32_t *)pSeq, FUTEX_WAIT_BITSET_PRIVATE, seq, pDeadline, NULL, FUTEX_BITSET_MATCH_ANY);
+    return !(ret == -1 && errno == ETIMEDOUT);
+}
+
+/**
+ * @brief checks if pDeadline has passed, clock_gettime() of the vDSO makes no system call
+ * @param pDeadline absolute CLOCK_MONOTONIC time, NULL = no deadline
+ * @retval true = the deadline has passed
+ */
+static bool _expired(const struct timespec *pDeadline)
+{
+    struct timespec now;
+    if (pDeadline == NULL)
+    {
+        return false;
+    }
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return now.tv_sec > pDeadline->tv_sec || (now.tv_sec == pDeadline->tv_sec && now.tv_nsec >= pDeadline->tv_nsec);
+}
+
+/**
+ * @brief converts a relative timeout into an absolute CLOCK_MONOTONIC deadline
+ * @retval NULL = negative timeout, wait forever
+ * @return pDeadline
+ */
+static const struct timespec *_deadline(struct timespec *pDeadline, int32_t timeout_ms)
+{
+    if (timeout_ms < 0)
+    {
+        return NULL;
+    }
+    clock_gettime(CLOCK_MONOTONIC, pDeadline);
+    pDeadline->tv_sec += timeout_ms / 1000;
+    pDeadline->tv_nsec += (long)(timeout_ms % 1000) * 1000000L;
+    if (pDeadline->tv_nsec >= 1000000000L)
+    {
+        pDeadline->tv_sec++;
+        pDeadline->tv_nsec -= 1000000000L;
+    }
+    return pDeadline;
+}
+#endif  /* FIFO_WAIT */
+
+#if FIFO_NOTIFY
+/**
+ * @brief calls the notify callback if the fifo was empty before the producer published the elements after write_idx
+ * @note the fence orders the store of write_idx before the load of read_idx, it pairs with the one in
+ * _recheckEmpty(), so either the consumer sees the new elements before it returns FIFO_EMPTY or the producer sees
+ * that the consumer emptied the fifo
+ */
+static inline void _notifyReady(volatile fifo_handle_t *pHandle, FIFO_INDEX_TYPE write_idx)
+{
+    fifo_notify_callback_t notify = __atomic_load_n(&pHandle->notify, __ATOMIC_ACQUIRE);   // pNotifyCtx is set before
+    if (notify != NULL && pHandle->write_idx != write_idx)
+    {
+        __atomic_thread_fence(__ATOMIC_SEQ_CST);
+        if (_LOAD_IDX(pHandle->read_idx) == write_idx)
+        {
+            notify(pHandle->pNotifyCtx);
+        }
+    }
+}
+
+/**
+ * @brief looks at write_idx a last time before the consumer returns FIFO_EMPTY
+ * @note the fence orders the last store of read_idx before the load of write_idx, it pairs with the one in
+ * _notifyReady(). Without it the consumer could miss an element and the producer could miss the empty fifo.
+ * @param [in,out] pWriteIdx write_idx seen by the consumer, gets the current one
+ * @retval true = elements were put in the meantime, the fifo is not empty
+ */
+static inline bool _recheckEmpty(volatile fifo_handle_t *pHandle, FIFO_INDEX_TYPE read_idx, FIFO_INDEX_TYPE *pWriteIdx)
+{
+    if (__atomic_load_n(&pHandle->notify, __ATOMIC_ACQUIRE) == NULL)    // nobody waits for a notification
+    {
+        return false;
+    }
+    __atomic_thread_fence(__ATOMIC_SEQ_CST);
+    *pWriteIdx = _LOAD_IDX(pHandle->write_idx);
+#if FIFO_SPSC
+    pHandle->write_idx_cache = *pWriteIdx;
+#endif
+    return *pWriteIdx != read_idx;
+}
+#endif  /* FIFO_NOTIFY */
+
+/**
+ * @brief returns the offset in bytes of the slot after idx, this is where the next element is written / read
+ */
+static inline size_t _slot(volatile fifo_handle_t *pHandle, size_t idx)
+{
+#if FIFO_POW2
+    return (idx & pHandle->mask) * pHandle->basetype_size;
+#else
+    idx += pHandle->basetype_size;
+    if (idx >= pHandle->size)
+    {
+        idx = 0;
+    }
+    return idx;
+#endif
+}
+
+/**
+ * @brief advances an index by n elements
+ */
+static inline FIFO_INDEX_TYPE _advance(volatile fifo_handle_t *pHandle, size_t idx, size_t n)
+{
+#if FIFO_POW2
+    (void)pHandle;
+    return (FIFO_INDEX_TYPE)(idx + n);  // free running, wraps with the index type
+#else
+    idx += n * pHandle->basetype_size;
+    if (idx >= pHandle->size)
+    {
+        idx -= pHandle->size;
+    }
+    return idx;
+#endif
+}
+
+/**
+ * @brief returns the number of elements between read_idx and write_idx
+ */
+static inline size_t _level(volatile fifo_handle_t *pHandle, size_t write_idx, size_t read_idx)
+{
+#if FIFO_POW2
+    (void)pHandle;
+    return (FIFO_INDEX_TYPE)(write_idx - read_idx);
+#else
+    return ((write_idx >= read_idx) ? write_idx - read_idx : write_idx + pHandle->size - read_idx) / pHandle->basetype_size;
+#endif
+}
+
+/**
+ * @brief returns the number of free slots
+ */
+static inline size_t _space(volatile fifo_handle_t *pHandle, size_t write_idx, size_t read_idx)
+{
+#if FIFO_POW2
+    return pHandle->mask + 1 - _level(pHandle, write_idx, read_idx);
+#else
+    return (pHandle->size / pHandle->basetype_size) - _level(pHandle, write_idx, read_idx) -1; // maximum fifo fill is size / basetype -1
+#endif
+}
+
+/**
+ * @brief checks if there is no free slot
+ */
+static inline bool _isFull(volatile fifo_handle_t *pHandle, size_t write_idx, size_t read_idx)
+{
+#if FIFO_POW2
+    return _level(pHandle, write_idx, read_idx) > pHandle->mask;
+#else
+    return _slot(pHandle, write_idx) == read_idx;
+#endif
+}
+
+/**
+ * @brief returns read_idx for the producer, so that at least n slots are free if the fifo has them
+ * With FIFO_SPSC the copy in read_idx_cache is used, read_idx is only loaded when the copy shows less than n free slots.
+ * The copy can only be behind read_idx, so the free space it shows is never too big.
+ */
+static inline FIFO_INDEX_TYPE _readIdxOfProducer(volatile fifo_handle_t *pHandle, FIFO_INDEX_TYPE write_idx, size_t n)
+{
+#if FIFO_SPSC
+    FIFO_INDEX_TYPE read_idx = pHandle->read_idx_cache;
+    if (_space(pHandle, write_idx, read_idx) < n)
+    {
+        read_idx = _LOAD_IDX(pHandle->read_idx);
+        pHandle->read_idx_cache = read_idx;
+    }
+    return read_idx;
+#else
+    (void)write_idx;
+    (void)n;
+    return pHandle->read_idx;
+#endif
+}
+
+/**
+ * @brief returns write_idx for the consumer, so that at least n elements are available if the fifo has them
+ * With FIFO_SPSC the copy in write_idx_cache is used, write_idx is only loaded when the copy shows less than n elements.
+ */
+static inline FIFO_INDEX_TYPE _writeIdxOfConsumer(volatile fifo_handle_t *pHandle, FIFO_INDEX_TYPE read_idx, size_t n)
+{
+#if FIFO_SPSC
+    FIFO_INDEX_TYPE write_idx = pHandle->write_idx_cache;
+#if FIFO_OVERWRITE
+    // an overwriting producer may move read_idx past the copy, then the level it shows is wrong
+    if (pHandle->overwrite || _level(pHandle, write_idx, read_idx) < n)
+#else
+    if (_level(pHandle, write_idx, read_idx) < n)
+#endif
+    {
+        write_idx = _LOAD_IDX(pHandle->write_idx);
+        pHandle->write_idx_cache = write_idx;
+    }
+    return write_idx;
+#else
+    (void)read_idx;
+    (void)n;
+    return pHandle->write_idx;
+#endif
+}
+
+#if FIFO_OVERWRITE
+#if FIFO_SPSC
+/**
+ * @brief read_idx and the dropped counter after it in the handle
+ */
+typedef struct{
+    FIFO_INDEX_TYPE read_idx;
+    uint32_t dropped;
+}__attribute__((aligned(FIFO_READ_POS_ALIGN(FIFO_INDEX_TYPE)))) _read_pos_t;
+
+/**
+ * @brief fills a _read_pos_t, the padding is set to 0 like in the handle because the compare and swap compares it too
+ */
+static inline void _setReadPos(_read_pos_t *pPos, FIFO_INDEX_TYPE read_idx, uint32_t dropped)
+{
+    memset(pPos, 0, sizeof(*pPos));
+    pPos->read_idx = read_idx;
+    pPos->dropped = dropped;
+}
+#endif
+
+/**
+ * @brief moves read_idx and dropped from *pExpected / *pDropped to desired / desired_dropped, unless the other side
+ * moved them in the meantime
+ * Every drop of the producer counts up dropped, so a consumer that was lapped sees a different dropped even if
+ * read_idx has the same value again.
+ * @param [in,out] pExpected read_idx seen by the caller, gets the current read_idx if it was moved
+ * @param [in,out] pDropped dropped seen by the caller, gets the current dropped if it was moved
+ * @retval true = read_idx was moved to desired
+ */
+static inline bool _casReadIdx(volatile fifo_handle_t *pHandle, FIFO_INDEX_TYPE *pExpected, uint32_t *pDropped, FIFO_INDEX_TYPE desired, uint32_t desired_dropped)
+{
+#if FIFO_SPSC
+    _read_pos_t expected, next;
+    _setReadPos(&expected, *pExpected, *pDropped);
+    _setReadPos(&next, desired, desired_dropped);
+    // release: the copy of the consumer is done before, acquire: the producer overwrites the slot after
+    bool moved = __atomic_compare_exchange((_read_pos_t *)&pHandle->read_idx, &expected, &next, false, __ATOMIC_ACQ_REL, __ATOMIC_ACQUIRE);
+    *pExpected = expected.read_idx;
+    *pDropped = expected.dropped;
+    return moved;
+#else
+    bool moved;
+_ENTER_CRITICAL();
+    moved = (pHandle->read_idx == *pExpected && pHandle->dropped == *pDropped);
+    if (moved)
+    {
+        pHandle->read_idx = desired;
+        pHandle->dropped = desired_dropped;
+    }
+    else
+    {
+        *pExpected = pHandle->read_idx;
+        *pDropped = pHandle->dropped;
+    }
+_LEAVE_CRITICAL();
+    return moved;
+#endif
+}
+
+/**
+ * @brief drops the oldest element of a full overwriting fifo, called by the producer
+ * @return read_idx after the drop
+ */
+static FIFO_INDEX_TYPE _dropOldest(volatile fifo_handle_t *pHandle, FIFO_INDEX_TYPE write_idx, FIFO_INDEX_TYPE read_idx)
+{
+    uint32_t dropped = pHandle->dropped;    // only the producer changes it
+    while (_isFull(pHandle, write_idx, read_idx))     // the consumer may have made space in the meantime
+    {
+        FIFO_INDEX_TYPE next = _advance(pHandle, read_idx, 1);
+        if (_casReadIdx(pHandle, &read_idx, &dropped, next, dropped + 1))
+        {
+            read_idx = next;
+            dropped++;
+        }
+    }
+#if FIFO_SPSC
+    pHandle->read_idx_cache = read_idx;
+#endif
+    return read_idx;
+}
+#endif  /* FIFO_OVERWRITE */
+
+/**
+ * @brief removes the element after read_idx after it was copied
+ * @param dropped dropped seen before read_idx was loaded, not used by a fifo that does not overwrite
+ * @retval false = an overwriting producer dropped the element in the meantime, the copy may be torn
+ */
+static inline bool _releaseOne(volatile fifo_handle_t *pHandle, FIFO_INDEX_TYPE read_idx, uint32_t dropped)
+{
+#if FIFO_OVERWRITE
+    if (pHandle->overwrite)
+    {
+        return _casReadIdx(pHandle, &read_idx, &dropped, _advance(pHandle, read_idx, 1), dropped);
+    }
+#endif
+    (void)dropped;
+    _STORE_IDX(pHandle->read_idx, _advance(pHandle, read_idx, 1));
+    return true;
+}
+
+/**
+ * @brief returns the number of bytes that can be accessed in one piece from the offset first on
+ * @note a mirrored fifo can be accessed in one piece up to its full size
+ */
+static inline size_t _contiguous(volatile fifo_handle_t *pHandle, size_t first)
+{
+#if FIFO_MIRROR
+    if (pHandle->mirrored)
+    {
+        return pHandle->size;
+    }
+#endif
+    return pHandle->size - first;
+}
+
+/**
+ * @brief copies n elements into the fifo memory, the first element goes to the slot after idx
+ * @note at most two memcpy calls are made, one up to the end of the fifo memory and one from its start
+ */
+static void _copyToFifo(volatile fifo_handle_t *pHandle, size_t idx, const void *pData, size_t n)
+{
+    size_t first = _slot(pHandle, idx), bytes = n * pHandle->basetype_size;
+    size_t contiguous = _contiguous(pHandle, first);
+    if (bytes <= contiguous)
+    {
+        memcpy((uint8_t *)pHandle->pFifo + first, pData, bytes);
+    }
+    else    // wraps around
+    {
+        memcpy((uint8_t *)pHandle->pFifo + first, pData, contiguous);
+        memcpy(pHandle->pFifo, (const uint8_t *)pData + contiguous, bytes - contiguous);
+    }
+}
+
+/**
+ * @brief copies n elements out of the fifo memory, the first element is the slot after idx
+ * @note at most two memcpy calls are made, one up to the end of the fifo memory and one from its start
+ */
+static void _copyFromFifo(volatile fifo_handle_t *pHandle, size_t idx, void *pData, size_t n)
+{
+    size_t first = _slot(pHandle, idx), bytes = n * pHandle->basetype_size;
+    size_t contiguous = _contiguous(pHandle, first);
+    if (bytes <= contiguous)
+    {
+        memcpy(pData, (uint8_t *)pHandle->pFifo + first, bytes);
+    }
+    else    // wraps around
+    {
+        memcpy(pData, (uint8_t *)pHandle->pFifo + first, contiguous);
+        memcpy((uint8_t *)pData + contiguous, pHandle->pFifo, bytes - contiguous);
+    }
+}
+
+/**
+ * @brief finds the record after read_idx
+ * Where less than a length prefix fits before the end of the fifo memory, or a skip marker was written there,
+ * the record starts at the beginning of the fifo memory.
+ * @param [out] ppRecord pointer to the length prefix of the record
+ * @param [out] pLen length of the record
+ * @return bytes from read_idx to the end of the record
+ */
+static size_t _findRecord(volatile fifo_handle_t *pHandle, size_t read_idx, uint8_t **ppRecord, uint32_t *pLen)
+{
+    size_t first = _slot(pHandle, read_idx);
+    size_t skip = _contiguous(pHandle, first);
+    uint8_t *pRecord = (uint8_t *)pHandle->pFifo + first;
+    *pLen = 0;
+    if (skip >= FIFO_RECORD_HEADER_SIZE)
+    {
+        memcpy(pLen, pRecord, FIFO_RECORD_HEADER_SIZE);
+        if (*pLen != _RECORD_PAD)
+        {
+            skip = 0;
+        }
+    }
+    if (skip > 0)   // wrapped to the start of the fifo memory
+    {
+        pRecord = (uint8_t *)pHandle->pFifo;
+        memcpy(pLen, pRecord, FIFO_RECORD_HEADER_SIZE);
+    }
+    *ppRecord = pRecord;
+    return skip + FIFO_RECORD_HEADER_SIZE + *pLen;
+}
+
+/**
+ * @brief sets every field of a handle, the parameters have to be checked by the caller
+ * @param size_fifo size of the fifo memory in bytes
+ */
+static void _initHandle(volatile fifo_handle_t *pHandle, void *pFifo, FIFO_INDEX_TYPE size_fifo, SIZE_FIFO_BASE_TYPE basetype_size)
+{
+#if FIFO_OVERWRITE && FIFO_SPSC
+    memset((void *)&pHandle->read_idx, 0, sizeof(_read_pos_t));    // the padding of the pair is compared by _casReadIdx()
+#endif
+    pHandle->size = size_fifo;
+    pHandle->basetype_size = basetype_size;
+    pHandle->pFifo = pFifo;
+    pHandle->read_idx = 0;
+    pHandle->write_idx = 0;
+#if FIFO_POW2
+    pHandle->mask = size_fifo / basetype_size -1;
+#endif
+#if FIFO_SPSC
+    pHandle->read_idx_cache = 0;
+    pHandle->write_idx_cache = 0;
+#else
+    pHandle->_lock = 0;
+#endif
+#if FIFO_MIRROR
+    pHandle->mirrored = false;
+#endif
+#if FIFO_OVERWRITE
+    pHandle->overwrite = false;
+    pHandle->dropped = 0;
+#endif
+#if FIFO_NOTIFY
+    pHandle->notify = NULL;
+    pHandle->pNotifyCtx = NULL;
+#endif
+#if FIFO_WAIT
+    pHandle->_data_seq = 0;
+    pHandle->_data_waiters = 0;
+    pHandle->_space_seq = 0;
+    pHandle->_space_waiters = 0;
+#endif
+}
 
 /**
  * @brief initializes a fifo handle
@@ -24,6 +587,7 @@
  * @retval -2 = invalid fifo size
  * @retval -3 = invalid basetype_size
  * @retval -4 = size_fifo is not a multiple of basetype_size
+ * @retval -5 = size_fifo / basetype_size is not a power of two (FIFO_POW2)
  */
 int8_t fifo_init(volatile fifo_handle_t *pHandle, void *pFifo, FIFO_INDEX_TYPE size_fifo, SIZE_FIFO_BASE_TYPE basetype_size)
 {
@@ -44,62 +608,79 @@ int8_t fifo_init(volatile fifo_handle_t *pHandle, void *pFifo, FIFO_INDEX_TYPE s
         return -3;
     if (size_fifo % basetype_size != 0)
         return -4;
+#if FIFO_POW2
+    FIFO_INDEX_TYPE capacity = size_fifo / basetype_size;
+    if ((capacity & (capacity -1)) != 0)
+        return -5;
+#endif
 
-    // *** Initialize Handle ***
-    pHandle->size = size_fifo;
-    pHandle->basetype_size = basetype_size;
-    pHandle->pFifo = pFifo;
-    pHandle->read_idx = 0;
-    pHandle->write_idx = 0;
-    pHandle->_lock = 0;
+    _initHandle(pHandle, pFifo, size_fifo, basetype_size);
     return 0;
 }
 
 #if FIFO_ALLOW_MALLOC
 /**
  * @brief allocates a fifo handle and the fifo memory, and initializes it
+ * The handle and the fifo memory are one block, the fifo memory is aligned to FIFO_CACHE_LINE_SIZE
  * @note If _DEBUG is defined every Parameter will be checked with assert()
  * @note memory has to be freed with fifo_deinit_free()
  * @param size_fifo size of the fifo in elements
  * @param basetype_size size of the fifo basetype eg: sizeof(uint8_t)
  * @retval NULL = failed, may be a size_fifo 0 or bigger than MAX_FIFO_SIZE or basetype_size 0 or bigger than FIFO_MAX_BASETYPE_SIZE
+ *                 or a size in bytes that does not fit into FIFO_INDEX_TYPE
+ *                 or size_fifo not a power of two with FIFO_POW2
  * @return pointer to the fifo handle
  */
 fifo_handle_t* fifo_init_malloc(FIFO_INDEX_TYPE size_fifo, SIZE_FIFO_BASE_TYPE basetype_size)
+{
+    return fifo_init_malloc_aligned(size_fifo, basetype_size, FIFO_CACHE_LINE_SIZE);
+}
+
+/**
+ * @brief allocates a fifo handle and the fifo memory in one aligned block, and initializes it
+ * The block starts with the handle, the fifo memory follows on the next multiple of alignment
+ * @note If _DEBUG is defined every Parameter will be checked with assert()
+ * @note memory has to be freed with fifo_deinit_free()
+ * @param size_fifo size of the fifo in elements
+ * @param basetype_size size of the fifo basetype eg: sizeof(uint8_t)
+ * @param alignment alignment of the handle and the fifo memory in bytes, a power of two and at least sizeof(void *),
+ * raised to the alignment of the handle if it is smaller
+ * @retval NULL = failed, invalid parameter (see fifo_init_malloc()) or alignment
+ * @return pointer to the fifo handle
+ */
+fifo_handle_t* fifo_init_malloc_aligned(FIFO_INDEX_TYPE size_fifo, SIZE_FIFO_BASE_TYPE basetype_size, size_t alignment)
 {
  #ifdef _DEBUG
     assert(size_fifo <= MAX_FIFO_SIZE && size_fifo > 0);
     assert(basetype_size > 0 && basetype_size <= FIFO_MAX_BASETYPE_SIZE);
+    assert(alignment >= sizeof(void *) && (alignment & (alignment -1)) == 0);
 #endif
     // *** Checking Parameters ***
     if (size_fifo > MAX_FIFO_SIZE || size_fifo == 0)
         return NULL;
     if (basetype_size == 0 || basetype_size > FIFO_MAX_BASETYPE_SIZE)
         return NULL;
-    
-    fifo_handle_t *myHandle = NULL;
+    if (size_fifo > ((FIFO_INDEX_TYPE)-1) / basetype_size)     // size in bytes has to fit into the index type
+        return NULL;
+    if (alignment < sizeof(void *) || (alignment & (alignment -1)) != 0)
+        return NULL;
+#if FIFO_POW2
+    if ((size_fifo & (size_fifo -1)) != 0)
+        return NULL;
+#endif
+    if (alignment < __alignof__(fifo_handle_t))     // read_idx of an overwriting FIFO_SPSC fifo is aligned for the compare and swap
+        alignment = __alignof__(fifo_handle_t);
 
-    // *** Allocate Handle ***
-    myHandle = (fifo_handle_t *)malloc(sizeof(*myHandle));
+    // *** Allocate Handle and Buffer in one block ***
+    size_t offset = (sizeof(fifo_handle_t) + alignment -1) & ~(alignment -1);
+    size_t bytes = (size_t)size_fifo * basetype_size;
+    size_t total = (offset + bytes + alignment -1) & ~(alignment -1);     // aligned_alloc() wants a multiple of alignment
+    fifo_handle_t *myHandle = (fifo_handle_t *)aligned_alloc(alignment, total);
 
+    // *** Initialize Handle ***
     if (myHandle != NULL)
     {
-        // *** Allocate Buffer ***
-        myHandle->pFifo = malloc(size_fifo * basetype_size);
-        if (myHandle->pFifo != NULL)
-        {
-            // *** Initialize Handle ***
-            myHandle->size = size_fifo * basetype_size; // size fifo is in elements and size is in bytes
-            myHandle->basetype_size = basetype_size;
-            myHandle->read_idx = 0;
-            myHandle->write_idx = 0;
-            myHandle->_lock = 0;
-        }
-        else     // buffer allocation failed
-        {
-            free((void *)myHandle);     // therefore free previously allocated memory
-            myHandle = NULL;
-        }
+        _initHandle(myHandle, (uint8_t *)myHandle + offset, bytes, basetype_size);
     }
     return myHandle;
 }
@@ -107,31 +688,92 @@ fifo_handle_t* fifo_init_malloc(FIFO_INDEX_TYPE size_fifo, SIZE_FIFO_BASE_TYPE b
 /**
  * @brief deallocates a fifo handle and its buffer
  * @note if _DEBUG is defined pHandle gets checked with assert()
- * @param pHandle pointer to the Fifo handle
+ * @param pHandle pointer to the Fifo handle from fifo_init_malloc(), fifo_init_malloc_aligned() or fifo_wide_init_mirror()
  */
 void fifo_deinit_free(volatile fifo_handle_t *pHandle)
 {
 #ifdef _DEBUG
     assert(pHandle != NULL);
 #endif
-    if (pHandle->pFifo != NULL)
-    {
-        free(pHandle->pFifo);
-    }
     if (pHandle != NULL)
     {
-        free((void *)pHandle);
+#if FIFO_MIRROR
+        if (pHandle->mirrored)
+        {
+            munmap(pHandle->pFifo, 2 * (size_t)pHandle->size);
+        }
+#endif
+        free((void *)pHandle);      // the fifo memory is part of the same block
     }
 }
-#endif  /* FIFO_ALLOW_MALLOC */
 
+#if FIFO_MIRROR && defined(_FIFO_WIDE)     // only for wide fifos, the small ones are too small to be a multiple of the page size
 /**
- * @brief puts an element into the fifo.
- * @note If _DEBUG is defined every Parameter will be checked with assert()
- * @param pHandle pointer to the fifo handle
- * @param [in] pData pointer to the data to be put onto the fifo
- * @return fifoerror_t
- */
+ * @brief allocates a fifo handle and fifo memory that is mapped twice back to back, and initializes it
+ * One memfd is mapped at pFifo and at pFifo + size, so a write behind the end of the fifo memory lands at its start.
+ * @note memory has to be freed with fifo_deinit_free()
+ * @param size_fifo size of the fifo in elements, size_fifo * basetype_size has to be a multiple of the page size
+ * @param basetype_size size of the fifo basetype eg: sizeof(uint8_t)
+ * @retval NULL = failed, invalid size or the memory could not be mapped
+ * @return pointer to the fifo handle
+ */
+fifo_handle_t* fifo_init_mirror(FIFO_INDEX_TYPE size_fifo, SIZE_FIFO_BASE_TYPE basetype_size)
+{
+    // *** Checking Parameters ***
+    if (size_fifo > MAX_FIFO_SIZE || size_fifo == 0)
+        return NULL;
+    if (basetype_size == 0 || basetype_size > FIFO_MAX_BASETYPE_SIZE)
+        return NULL;
+    if (size_fifo > ((FIFO_INDEX_TYPE)-1) / basetype_size)     // size in bytes has to fit into the index type
+        return NULL;
+    size_t bytes = (size_t)size_fifo * basetype_size;
+    if (bytes % (size_t)sysconf(_SC_PAGESIZE) != 0)
+        return NULL;
+
+    fifo_handle_t *myHandle = (fifo_handle_t *)malloc(sizeof(*myHandle));
+    if (myHandle == NULL)
+        return NULL;
+
+    // *** Reserve twice the size, then map the same memory into both halves ***
+    uint8_t *pFifo = MAP_FAILED;
+    int fd = memfd_create("fifo", MFD_CLOEXEC);
+    if (fd >= 0 && ftruncate(fd, bytes) == 0)
+    {
+        pFifo = mmap(NULL, 2 * bytes, PROT_NONE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+        if (pFifo != MAP_FAILED
+            && (mmap(pFifo, bytes, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_FIXED, fd, 0) == MAP_FAILED
+             || mmap(pFifo + bytes, bytes, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_FIXED, fd, 0) == MAP_FAILED))
+        {
+            munmap(pFifo, 2 * bytes);
+            pFifo = MAP_FAILED;
+        }
+    }
+    if (fd >= 0)
+    {
+        close(fd);      // the mappings keep the memory
+    }
+    if (pFifo == MAP_FAILED || fifo_init(myHandle, pFifo, bytes, basetype_size) != 0)
+    {
+        if (pFifo != MAP_FAILED)
+        {
+            munmap(pFifo, 2 * bytes);
+        }
+        free(myHandle);
+        return NULL;
+    }
+    myHandle->mirrored = true;
+    return myHandle;
+}
+#endif  /* FIFO_MIRROR */
+#endif  /* FIFO_ALLOW_MALLOC */
+
+/**
+ * @brief puts an element into the fifo.
+ * @note If _DEBUG is defined every Parameter will be checked with assert()
+ * @param pHandle pointer to the fifo handle
+ * @param [in] pData pointer to the data to be put onto the fifo
+ * @return fifoerror_t
+ */
 fifoerror_t fifo_put(volatile fifo_handle_t *pHandle, const void *pData)
 {
     fifoerror_t ret = FIFO_BUISY;
@@ -145,35 +787,33 @@ fifoerror_t fifo_put(volatile fifo_handle_t *pHandle, const void *pData)
     if (pData == NULL)
         return FIFO_WRONG_PARAM;
 
-
-    if (!(pHandle->_lock & _WRITE_LOCK))   // fifo is write-locked
+    if (_lock(pHandle, _WRITE_LOCK))
     {
-    FIFO_ENTER_CRITICAL();  // writing to lock may not be a atomic operation
-        pHandle->_lock |= _WRITE_LOCK;      // lock the handle
-
-        // *** Ring ***
-        FIFO_INDEX_TYPE idx_temp = pHandle->write_idx + pHandle->basetype_size, read_idx = pHandle->read_idx;
-    FIFO_LEAVE_CRITICAL();
-
-        if (idx_temp >= pHandle->size)
+    _ENTER_CRITICAL();
+        FIFO_INDEX_TYPE write_idx = pHandle->write_idx, read_idx = _readIdxOfProducer(pHandle, write_idx, 1);
+    _LEAVE_CRITICAL();
+#if FIFO_OVERWRITE
+        if (pHandle->overwrite)     // make space by dropping the oldest element
         {
-            idx_temp = 0;
+            read_idx = _dropOldest(pHandle, write_idx, read_idx);
         }
+#endif
 
         // *** Check if space available ***
-        if (idx_temp == read_idx)  // No space
+        if (_isFull(pHandle, write_idx, read_idx))  // No space
         {
             ret = FIFO_FULL;
         }
         else        // space available
         {
-            // *** Write to the fifo ***
-            memcpy(((uint8_t *)(pHandle->pFifo) + (pHandle->write_idx = idx_temp)), pData, pHandle->basetype_size);
+            // *** Write to the fifo, then publish the element ***
+            memcpy((uint8_t *)pHandle->pFifo + _slot(pHandle, write_idx), pData, pHandle->basetype_size);
+            _STORE_IDX(pHandle->write_idx, _advance(pHandle, write_idx, 1));
+            _NOTIFY_DATA(pHandle);
+            _NOTIFY_READY(pHandle, write_idx);
             ret = FIFO_NO_ERROR;
         }
-    FIFO_ENTER_CRITICAL();
-        pHandle->_lock &= ~_WRITE_LOCK;     // unlock the handle
-    FIFO_LEAVE_CRITICAL();
+        _unlock(pHandle, _WRITE_LOCK);
     }
     return ret;
 }
@@ -197,310 +837,1077 @@ fifoerror_t fifo_get(volatile fifo_handle_t *pHandle, void *pData)
     if (pData == NULL)
         return FIFO_WRONG_PARAM;
 
-    FIFO_INDEX_TYPE idx_temp, write_idx;
     fifoerror_t ret = FIFO_BUISY;
 
-    if (!(pHandle->_lock & _READ_LOCK))   // fifo is read-locked
+    if (_lock(pHandle, _READ_LOCK))
     {
-    FIFO_ENTER_CRITICAL();
-        pHandle->_lock |= _READ_LOCK;      // lock the handle
-        write_idx = pHandle->write_idx;     // looking at write_idx may not be a atomic operation
-    FIFO_LEAVE_CRITICAL();
-        // *** Check if data available ***
-        if (write_idx != pHandle->read_idx)  // no data in fifo
+        while (ret == FIFO_BUISY)   // only repeated when an overwriting producer dropped the element while it was copied
         {
-            ret = FIFO_NO_ERROR;
-            // *** Ring ***
-            idx_temp = pHandle->read_idx + pHandle->basetype_size; 
+        _ENTER_CRITICAL();
+            uint32_t dropped = _DROPPED(pHandle);
+            FIFO_INDEX_TYPE read_idx = _OWN_READ_IDX(pHandle), write_idx = _writeIdxOfConsumer(pHandle, read_idx, 1);     // looking at write_idx may not be a atomic operation
+        _LEAVE_CRITICAL();
 
-            if (idx_temp >= pHandle->size) 
+            // *** Check if data available ***
+            if (write_idx != read_idx)
+            {
+                // *** Copy the data, then release the slot ***
+                memcpy(pData, (uint8_t *)pHandle->pFifo + _slot(pHandle, read_idx), pHandle->basetype_size);
+                if (_releaseOne(pHandle, read_idx, dropped))
+                {
+                    _NOTIFY_SPACE(pHandle);
+                    ret = FIFO_NO_ERROR;
+                }
+            }
+            else if (!_RECHECK_EMPTY(pHandle, read_idx, &write_idx))    // no data in fifo
             {
-                idx_temp = 0;
+                ret = FIFO_EMPTY;
             }
+        }
+        _unlock(pHandle, _READ_LOCK);
+    }
+
+    return ret;
+}
+
+
+/**
+ * @brief puts up to n elements into the fifo with one lock and one update of write_idx
+ * @note If _DEBUG is defined every Parameter will be checked with assert()
+ * @param pHandle pointer to the fifo handle
+ * @param [in] pData pointer to the n elements to be put onto the fifo
+ * @param n ammount of elements
+ * @param [out] pWritten number of elements put onto the fifo, may be NULL
+ * @retval FIFO_NO_ERROR    all n elements were put onto the fifo
+ * @retval FIFO_FULL        only *pWritten elements fitted into the fifo
+ * @return fifoerror_t
+ */
+fifoerror_t fifo_put_n(volatile fifo_handle_t *pHandle, const void *pData, FIFO_INDEX_TYPE n, FIFO_INDEX_TYPE *pWritten)
+{
+    FIFO_INDEX_TYPE written = 0;
+    fifoerror_t ret = FIFO_BUISY;
+#ifdef _DEBUG
+    assert(pHandle != NULL);
+    assert(pData != NULL || n == 0);
+#endif
+    // *** Checking Parameters ***
+    if (pHandle == NULL || (pData == NULL && n != 0))
+        return FIFO_WRONG_PARAM;
+
+    if (_lock(pHandle, _WRITE_LOCK))
+    {
+    _ENTER_CRITICAL();
+        FIFO_INDEX_TYPE write_idx = pHandle->write_idx, read_idx = _readIdxOfProducer(pHandle, write_idx, n);
+    _LEAVE_CRITICAL();
+
+        // *** Limit to the space available ***
+        size_t space = _space(pHandle, write_idx, read_idx);
+        written = (n > space) ? space : n;
+        ret = (written == n) ? FIFO_NO_ERROR : FIFO_FULL;
+
+        // *** Write to the fifo, then publish all elements at once ***
+        if (written > 0)
+        {
+            _copyToFifo(pHandle, write_idx, pData, written);
+            _STORE_IDX(pHandle->write_idx, _advance(pHandle, write_idx, written));
+            _NOTIFY_DATA(pHandle);
+            _NOTIFY_READY(pHandle, write_idx);
+        }
+        _unlock(pHandle, _WRITE_LOCK);
+    }
+    if (pWritten != NULL)
+    {
+        *pWritten = written;
+    }
+    return ret;
+}
+
+/**
+ * @brief gets up to n elements from the fifo with one lock and one update of read_idx
+ * @note If _DEBUG is defined every Parameter will be checked with assert()
+ * @param pHandle pointer to the fifo handle
+ * @param [out] pData pointer to the storage for n elements
+ * @param n ammount of elements
+ * @param [out] pRead number of elements read from the fifo, may be NULL
+ * @retval FIFO_NO_ERROR    all n elements were read
+ * @retval FIFO_EMPTY       only *pRead elements were in the fifo
+ * @return fifoerror_t
+ */
+fifoerror_t fifo_get_n(volatile fifo_handle_t *pHandle, void *pData, FIFO_INDEX_TYPE n, FIFO_INDEX_TYPE *pRead)
+{
+    FIFO_INDEX_TYPE read = 0;
+    fifoerror_t ret = FIFO_BUISY;
+#ifdef _DEBUG
+    assert(pHandle != NULL);
+    assert(pData != NULL || n == 0);
+#endif
+    // *** Checking Parameters ***
+    if (pHandle == NULL || (pData == NULL && n != 0) || _IS_OVERWRITING(pHandle))
+        return FIFO_WRONG_PARAM;
+
+    if (_lock(pHandle, _READ_LOCK))
+    {
+    _ENTER_CRITICAL();
+        FIFO_INDEX_TYPE read_idx = pHandle->read_idx, write_idx = _writeIdxOfConsumer(pHandle, read_idx, n);
+    _LEAVE_CRITICAL();
+
+        do  // only repeated when the fifo got empty and elements were put in the meantime
+        {
+            // *** Limit to the elements available ***
+            size_t level = _level(pHandle, write_idx, read_idx);
+            size_t chunk = (size_t)(n - read);
+            if (chunk > level)
+            {
+                chunk = level;
+            }
+
+            // *** Copy the data, then release all slots at once ***
+            if (chunk > 0)
+            {
+                _copyFromFifo(pHandle, read_idx, (uint8_t *)pData + read * pHandle->basetype_size, chunk);
+                read_idx = _advance(pHandle, read_idx, chunk);
+                _STORE_IDX(pHandle->read_idx, read_idx);
+                _NOTIFY_SPACE(pHandle);
+                read += chunk;
+            }
+        } while (read < n && _RECHECK_EMPTY(pHandle, read_idx, &write_idx));
+        ret = (read == n) ? FIFO_NO_ERROR : FIFO_EMPTY;
+        _unlock(pHandle, _READ_LOCK);
+    }
+    if (pRead != NULL)
+    {
+        *pRead = read;
+    }
+    return ret;
+}
+
+/**
+ * @brief checks if a fifo still has elements in it
+ * @note pHandle gets checked with assert() when _DEBUG is defined
+ * @retval true = has elements left
+ */
+bool fifo_hasElementsLeft(volatile fifo_handle_t *pHandle)
+{
+#ifdef _DEBUG
+    assert(pHandle != NULL);
+#endif
+    bool ret = false;
+    // *** Check if data available ***
+_ENTER_CRITICAL();
+    if (!(pHandle == NULL || _LOAD_IDX(pHandle->write_idx) == _LOAD_IDX(pHandle->read_idx)))  // no data in fifo
+    {
+        ret = true;
+    }
+_LEAVE_CRITICAL();
+    return ret;
+}
+
+/**
+ * @brief checks if a fifo still free space in it
+ * @note pHandle gets checked with assert() when _DEBUG is defined
+ * @retval true = has free space left
+ */
+bool fifo_hasSpaceLeft(volatile fifo_handle_t *pHandle)
+{
+#ifdef _DEBUG
+    assert(pHandle != NULL);
+#endif
+    bool ret = false;
+    // *** Checking Parameters ***
+    if (pHandle != NULL)
+    {
+    _ENTER_CRITICAL();
+        // *** Check if space available ***
+        if (!_isFull(pHandle, _LOAD_IDX(pHandle->write_idx), _LOAD_IDX(pHandle->read_idx)))
+        {
+            ret = true;
+        }
+    _LEAVE_CRITICAL();
+    }
+    return ret;
+}
+
+/**
+ * @brief flushes a FIFO by setting write- and read-index to the same value
+ * @return FIFO_NO_ERROR    Everything worked
+ * @return FIFO_WRONG_PARAM NULL pointer or an overwriting fifo
+ * @return FIFO_BUISY       FIFO handle is locked
+ */
+fifoerror_t fifo_flush(volatile fifo_handle_t *pHandle)
+{
+#ifdef _DEBUG
+    assert(pHandle != NULL);
+#endif
+    if (pHandle == NULL || _IS_OVERWRITING(pHandle))
+    {
+        return FIFO_WRONG_PARAM;
+    }
+    fifoerror_t ret = FIFO_NO_ERROR;
+
+_ENTER_CRITICAL();
+    if (_IS_LOCKED(pHandle, _READ_LOCK | _WRITE_LOCK))  // fifo is locked
+    {
+        ret = FIFO_BUISY;
+    }
+    FIFO_INDEX_TYPE write_idx = _LOAD_IDX(pHandle->write_idx);
+#if FIFO_SPSC
+    pHandle->write_idx_cache = write_idx;   // read_idx may never get ahead of the copy of the consumer
+#endif
+    _STORE_IDX(pHandle->read_idx, write_idx); // flush
+_LEAVE_CRITICAL();
+    _NOTIFY_SPACE(pHandle);
+    return ret;
+}
+
+/**
+ * @brief returns the pointer to the end of the fifo buffer
+ * @param pHandle pointer to the fifo handle
+ * @retval pointer to the end of the fifo
+ */
+void *fifo_getEndPtr(fifo_handle_t *pHandle)
+{
+    return (uint8_t *)pHandle->pFifo + (pHandle->size - pHandle->basetype_size);
+}
+
+/**
+ * @brief acts as if the fifo had been read
+ * This may be useful to read from the fifo outside of this library, for example if a function gets passed a fifo pointer
+ * and it reads multiple times from the fifo without calling a fifo function
+ * @note Be careful when reading from the fifo without fifo functions!!
+ * @param pHandle pointer to the fifo handle
+ * @param n ammount of read cycles to be skipped
+ * @return fifoerror_t
+ */
+fifoerror_t fifo_skip_read(fifo_handle_t *pHandle)
+{
+    return fifo_skip_read_n(pHandle, 1);
+}
 
-            // *** Copty the data ***
-            memcpy(pData, ((uint8_t *)(pHandle->pFifo)) + (pHandle->read_idx = idx_temp), pHandle->basetype_size);  
+/**
+ * @brief acts as if the fifo had been read n times
+ * This may be useful to read from the fifo outside of this library, for example if a function gets passed a fifo pointer
+ * and it reads multiple times from the fifo without calling a fifo function
+ * @note Be careful when reading from the fifo without fifo functions!!
+ * @param pHandle pointer to the fifo handle
+ * @param n ammount of read cycles to be skipped
+ * @return fifoerror_t
+ */
+fifoerror_t fifo_skip_read_n(fifo_handle_t *pHandle, FIFO_INDEX_TYPE n)
+{
+#ifdef _DEBUG
+    assert(pHandle != NULL);
+#endif
+    // *** Checking Parameters ***
+    if (pHandle == NULL || _IS_OVERWRITING(pHandle))
+        return FIFO_WRONG_PARAM;
+
+_ENTER_CRITICAL();
+    if (_IS_LOCKED(pHandle, _READ_LOCK))   // fifo is read-locked
+    {
+        _LEAVE_CRITICAL();
+        return FIFO_BUISY;
+    }
+
+    // *** Check if data available ***
+    FIFO_INDEX_TYPE read_idx = pHandle->read_idx, write_idx = _writeIdxOfConsumer(pHandle, read_idx, n);
+    size_t level = _level(pHandle, write_idx, read_idx);
+    if (level == 0 && _RECHECK_EMPTY(pHandle, read_idx, &write_idx))
+    {
+        level = _level(pHandle, write_idx, read_idx);
+    }
+    if (level == 0)  // no data in fifo
+    {
+        _LEAVE_CRITICAL();
+        return FIFO_EMPTY;
+    }
+
+    // *** Limit skipped elements to available elements ***
+    if (n > level)
+    {
+        n = level;
+    }
+    _STORE_IDX(pHandle->read_idx, _advance(pHandle, read_idx, n));
+_LEAVE_CRITICAL();
+    _NOTIFY_SPACE(pHandle);
+
+    return FIFO_NO_ERROR;
+}
+
+/**
+ * @brief acts as if something had been written to the fifo without changing its contents
+ * This may be useful to write to the fifo outside of this library, for example if a function gets passed a fifo pointer
+ * and it writes multiple times to the fifo without calling a fifo function
+ * @note Be careful when writing to the fifo without fifo functions!!
+ * @param pHandle pointer to the fifo handle
+ * @return fifoerror_t
+ */
+fifoerror_t fifo_skip_write(fifo_handle_t *pHandle)
+{
+    return fifo_skip_write_n(pHandle, 1);
+}
+
+/**
+ * @brief acts as if the fifo had been written to n times without changing its contents on the physical memory
+ * This may be useful to write to the fifo outside of this library, for example if a function gets passed a fifo pointer
+ * and it writes multiple times to the fifo without calling a fifo function
+ * @note Be careful when writing to the fifo without fifo functions!!
+ * @param pHandle pointer to the fifo handle
+ * @param n ammount of write cycles to be skipped
+ * @return fifoerror_t
+ */
+fifoerror_t fifo_skip_write_n(fifo_handle_t *pHandle, FIFO_INDEX_TYPE n)
+{
+        fifoerror_t ret;
+#ifdef _DEBUG
+    assert(pHandle != NULL);
+#endif
+    // *** Checking Parameters ***
+    if (pHandle == NULL)
+        return FIFO_WRONG_PARAM;
+    if (pHandle == 0)
+        return FIFO_WRONG_PARAM;
+
+_ENTER_CRITICAL();
+    if (_IS_LOCKED(pHandle, _WRITE_LOCK))   // fifo is write-locked
+    {
+        _LEAVE_CRITICAL();
+        return FIFO_BUISY;
+    }
+
+    // *** Check if space available ***
+    FIFO_INDEX_TYPE write_idx = pHandle->write_idx;
+    size_t space = _space(pHandle, write_idx, _readIdxOfProducer(pHandle, write_idx, n));
+    if (space == 0)  // No space
+    {
+        ret = FIFO_FULL;
+    }
+    else
+    {
+        // *** Limit skipped elements to available elements ***
+        if (n > space)
+        {
+            n = space;
         }
-        else
+        ret = FIFO_NO_ERROR;
+        _STORE_IDX(pHandle->write_idx, _advance(pHandle, write_idx, n));
+    }
+_LEAVE_CRITICAL();
+    _NOTIFY_DATA(pHandle);
+    _NOTIFY_READY(pHandle, write_idx);
+    return ret;
+}
+
+/**
+ * @brief returns the fill level of a fifo
+ * @param pHandle pointer to a fifo handle
+ * @retval fill level of the fifo in elements
+ */
+FIFO_INDEX_TYPE fifo_getLevel(fifo_handle_t *pHandle)
+{
+#ifdef _DEBUG
+    assert(pHandle != NULL);
+#endif
+    if (pHandle == NULL)
+    {
+        return 0;
+    }
+_ENTER_CRITICAL();
+    FIFO_INDEX_TYPE read_idx = _LOAD_IDX(pHandle->read_idx), write_idx = _LOAD_IDX(pHandle->write_idx);    // read first, write can only be bigger
+_LEAVE_CRITICAL();
+    return _level(pHandle, write_idx, read_idx);
+}
+
+/**
+ * @brief returns the empty space of a fifo
+ * @param pHandle pointer to a fifo handle
+ * @retval empty space in the fifo in elements
+ */
+FIFO_INDEX_TYPE fifo_getEmptySpace(fifo_handle_t *pHandle)
+{
+#ifdef _DEBUG
+    assert(pHandle != NULL);
+#endif
+    if (pHandle == NULL)
+    {
+        return 0;
+    }
+_ENTER_CRITICAL();
+    FIFO_INDEX_TYPE write_idx = _LOAD_IDX(pHandle->write_idx), read_idx = _LOAD_IDX(pHandle->read_idx);
+_LEAVE_CRITICAL();
+    return _space(pHandle, write_idx, read_idx);
+}
+
+#if FIFO_OVERWRITE
+/**
+ * @brief sets the overflow policy of a fifo, has to be called before the fifo is used
+ * An overwriting fifo never returns FIFO_FULL from fifo_put(), the oldest element gets dropped and counted instead.
+ * @note the consumer of an overwriting fifo has to use fifo_get(), the other read functions (fifo_get_n(),
+ * fifo_read_peek() / fifo_read_release(), fifo_drain(), fifo_skip_read_n(), fifo_flush() and the record functions) return
+ * FIFO_WRONG_PARAM, they would overwrite read_idx after the producer moved it. The other write functions still
+ * return FIFO_FULL.
+ * @param pHandle pointer to the fifo handle
+ * @param overwrite true = drop the oldest element when the fifo is full
+ * @return fifoerror_t
+ */
+fifoerror_t fifo_setOverwrite(volatile fifo_handle_t *pHandle, bool overwrite)
+{
+#ifdef _DEBUG
+    assert(pHandle != NULL);
+#endif
+    if (pHandle == NULL)
+    {
+        return FIFO_WRONG_PARAM;
+    }
+    pHandle->overwrite = overwrite;
+    return FIFO_NO_ERROR;
+}
+
+/**
+ * @brief returns the number of elements dropped by fifo_put() of an overwriting fifo since it was initialized
+ * @param pHandle pointer to the fifo handle
+ * @retval dropped elements
+ */
+uint32_t fifo_getDropped(volatile fifo_handle_t *pHandle)
+{
+#ifdef _DEBUG
+    assert(pHandle != NULL);
+#endif
+    if (pHandle == NULL)
+    {
+        return 0;
+    }
+    return __atomic_load_n(&pHandle->dropped, __ATOMIC_RELAXED);
+}
+#endif  /* FIFO_OVERWRITE */
+
+#if FIFO_NOTIFY
+/**
+ * @brief sets the callback that is called when a put makes the fifo non-empty, has to be called before the fifo is used
+ * @param pHandle pointer to the fifo handle
+ * @param callback function to call, NULL = no notification
+ * @param pCtx context pointer passed to the callback, kept when callback is NULL
+ * @return fifoerror_t
+ */
+fifoerror_t fifo_setNotify(volatile fifo_handle_t *pHandle, fifo_notify_callback_t callback, void *pCtx)
+{
+#ifdef _DEBUG
+    assert(pHandle != NULL);
+#endif
+    if (pHandle == NULL)
+    {
+        return FIFO_WRONG_PARAM;
+    }
+    if (callback != NULL)
+    {
+        pHandle->pNotifyCtx = pCtx;     // published with the callback, a producer that still calls the old one keeps its context
+    }
+    __atomic_store_n(&pHandle->notify, callback, __ATOMIC_RELEASE);
+    return FIFO_NO_ERROR;
+}
+
+/**
+ * @brief notify callback of fifo_openEventfd(), the eventfd is the context pointer
+ */
+static void _signalEventfd(void *pCtx)
+{
+    uint64_t one = 1;
+    ssize_t done = write((int)(intptr_t)pCtx, &one, sizeof(one));   // only fails when the counter is about to overflow, it is readable then
+    (void)done;
+}
+
+/**
+ * @brief creates an eventfd that becomes readable when a put makes the fifo non-empty (Linux only)
+ * @param pHandle pointer to the fifo handle
+ * @retval -1 = failed
+ * @return non blocking eventfd, readable right away if the fifo holds elements
+ */
+int fifo_openEventfd(volatile fifo_handle_t *pHandle)
+{
+#ifdef _DEBUG
+    assert(pHandle != NULL);
+#endif
+    if (pHandle == NULL)
+    {
+        return -1;
+    }
+    int fd = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+    if (fd >= 0)
+    {
+        fifo_setNotify(pHandle, _signalEventfd, (void *)(intptr_t)fd);
+        if (fifo_hasElementsLeft(pHandle))  // elements put before the callback was set
         {
-            ret = FIFO_EMPTY;
+            _signalEventfd((void *)(intptr_t)fd);
         }
-    FIFO_ENTER_CRITICAL();
-        pHandle->_lock &= ~_READ_LOCK;     // unlock the handle
-    FIFO_LEAVE_CRITICAL();
     }
-
-    return ret;
+    return fd;
 }
 
-
 /**
- * @brief checks if a fifo still has elements in it
- * @note pHandle gets checked with assert() when _DEBUG is defined
- * @retval true = has elements left
+ * @brief clears the notify callback of the fifo and closes the eventfd from fifo_openEventfd()
+ * @note the producer has to be stopped first: a put that loaded the callback before it was cleared still writes to
+ * the eventfd, which may be closed and reused for another file by then
+ * @param pHandle pointer to the fifo handle
+ * @param fd eventfd returned by fifo_openEventfd()
+ * @return fifoerror_t
  */
-bool fifo_hasElementsLeft(volatile fifo_handle_t *pHandle)
+fifoerror_t fifo_closeEventfd(volatile fifo_handle_t *pHandle, int fd)
 {
 #ifdef _DEBUG
     assert(pHandle != NULL);
 #endif
-    bool ret = false;
-    // *** Check if data available ***
-FIFO_ENTER_CRITICAL();
-    if (!(pHandle == NULL || pHandle->write_idx == pHandle->read_idx))  // no data in fifo
+    if (pHandle == NULL || fd < 0)
     {
-        ret = true;
+        return FIFO_WRONG_PARAM;
     }
-FIFO_LEAVE_CRITICAL();
-    return ret;
+    fifo_setNotify(pHandle, NULL, NULL);
+    close(fd);
+    return FIFO_NO_ERROR;
 }
+#endif  /* FIFO_NOTIFY */
 
 /**
- * @brief checks if a fifo still free space in it
- * @note pHandle gets checked with assert() when _DEBUG is defined
- * @retval true = has free space left
+ * @brief reserves up to n free slots for writing them in place
+ * *ppData points to the first free slot in the fifo memory, *pContiguous slots can be written from there on.
+ * *pContiguous may be smaller than n because of the end of the fifo memory or the free space.
+ * The slots get published with fifo_write_commit(), which has to be called after every successful reserve.
+ * @note the fifo stays write-locked until fifo_write_commit() is called
+ * @param pHandle pointer to the fifo handle
+ * @param n ammount of slots wanted
+ * @param [out] ppData pointer to the first reserved slot
+ * @param [out] pContiguous number of contiguous slots reserved
+ * @retval FIFO_NO_ERROR    at least one slot was reserved
+ * @retval FIFO_FULL        no slot is free, the fifo is not locked
+ * @return fifoerror_t
  */
-bool fifo_hasSpaceLeft(volatile fifo_handle_t *pHandle)
+fifoerror_t fifo_write_reserve(volatile fifo_handle_t *pHandle, FIFO_INDEX_TYPE n, void **ppData, FIFO_INDEX_TYPE *pContiguous)
 {
 #ifdef _DEBUG
     assert(pHandle != NULL);
+    assert(ppData != NULL);
+    assert(pContiguous != NULL);
 #endif
-    bool ret = false;
     // *** Checking Parameters ***
-    if (pHandle != NULL)
+    if (pHandle == NULL || ppData == NULL || pContiguous == NULL)
+        return FIFO_WRONG_PARAM;
+
+    *pContiguous = 0;
+    if (!_lock(pHandle, _WRITE_LOCK))
     {
-    FIFO_ENTER_CRITICAL();    
-        FIFO_INDEX_TYPE idx_temp = pHandle->write_idx + pHandle->basetype_size;
-        if (idx_temp >= pHandle->size)
-        {
-            idx_temp = 0;
-        }
+        return FIFO_BUISY;
+    }
+_ENTER_CRITICAL();
+    FIFO_INDEX_TYPE write_idx = pHandle->write_idx, read_idx = _readIdxOfProducer(pHandle, write_idx, n);
+_LEAVE_CRITICAL();
 
-        // *** Check if space available ***
-        if (idx_temp != pHandle->read_idx)  // No space
-        {
-            ret = true;
-        }
-    FIFO_LEAVE_CRITICAL();
+    // *** Limit to the free space and to the end of the fifo memory ***
+    size_t first = _slot(pHandle, write_idx);
+    size_t space = _space(pHandle, write_idx, read_idx);
+    size_t contiguous = _contiguous(pHandle, first) / pHandle->basetype_size;
+    if (contiguous > space)
+    {
+        contiguous = space;
     }
-    return ret;
+    if (contiguous > n)
+    {
+        contiguous = n;
+    }
+    if (contiguous == 0)
+    {
+        _unlock(pHandle, _WRITE_LOCK);
+        return FIFO_FULL;
+    }
+    *ppData = (uint8_t *)pHandle->pFifo + first;
+    *pContiguous = contiguous;
+    return FIFO_NO_ERROR;
 }
 
 /**
- * @brief flushes a FIFO by setting write- and read-index to the same value
- * @return FIFO_NO_ERROR    Everything worked
- * @return FIFO_BUISY       FIFO handle is locked
+ * @brief publishes n slots written after fifo_write_reserve() and unlocks the fifo
+ * @param pHandle pointer to the fifo handle
+ * @param n ammount of slots written, at most *pContiguous of the reserve, may be 0
+ * @return fifoerror_t
  */
-fifoerror_t fifo_flush(volatile fifo_handle_t *pHandle)
+fifoerror_t fifo_write_commit(volatile fifo_handle_t *pHandle, FIFO_INDEX_TYPE n)
 {
+    fifoerror_t ret = FIFO_NO_ERROR;
 #ifdef _DEBUG
     assert(pHandle != NULL);
 #endif
+    // *** Checking Parameters ***
     if (pHandle == NULL)
-    {
         return FIFO_WRONG_PARAM;
-    }
-    fifoerror_t ret = FIFO_NO_ERROR;
 
-FIFO_ENTER_CRITICAL();
-    if (pHandle->_lock & (_READ_LOCK | _WRITE_LOCK))  // fifo is locked
+_ENTER_CRITICAL();
+    FIFO_INDEX_TYPE write_idx = pHandle->write_idx, read_idx = _readIdxOfProducer(pHandle, write_idx, n);
+_LEAVE_CRITICAL();
+    size_t space = _space(pHandle, write_idx, read_idx);
+    if (n > space)      // more than reserved
     {
-        ret = FIFO_BUISY;
+        ret = FIFO_WRONG_PARAM;
+    }
+    else if (n > 0)
+    {
+        _STORE_IDX(pHandle->write_idx, _advance(pHandle, write_idx, n));     // publish the written slots
+        _NOTIFY_DATA(pHandle);
+        _NOTIFY_READY(pHandle, write_idx);
     }
-    pHandle->read_idx = pHandle->write_idx; // flush
-FIFO_LEAVE_CRITICAL();
+    _unlock(pHandle, _WRITE_LOCK);
     return ret;
 }
 
 /**
- * @brief returns the pointer to the end of the fifo buffer
+ * @brief gives access to up to n elements in place, without copying them
+ * *ppData points to the oldest element in the fifo memory, *pContiguous elements can be read from there on.
+ * *pContiguous may be smaller than n because of the end of the fifo memory or the fill level.
+ * The elements get removed with fifo_read_release(), which has to be called after every successful peek.
+ * @note the fifo stays read-locked until fifo_read_release() is called
  * @param pHandle pointer to the fifo handle
- * @retval pointer to the end of the fifo
+ * @param n ammount of elements wanted
+ * @param [out] ppData pointer to the oldest element
+ * @param [out] pContiguous number of contiguous elements available
+ * @retval FIFO_NO_ERROR    at least one element is available
+ * @retval FIFO_EMPTY       the fifo is empty, the fifo is not locked
+ * @return fifoerror_t
  */
-void *fifo_getEndPtr(fifo_handle_t *pHandle)
+fifoerror_t fifo_read_peek(volatile fifo_handle_t *pHandle, FIFO_INDEX_TYPE n, void **ppData, FIFO_INDEX_TYPE *pContiguous)
 {
-    return (uint8_t *)pHandle->pFifo + (pHandle->size - pHandle->basetype_size);
+#ifdef _DEBUG
+    assert(pHandle != NULL);
+    assert(ppData != NULL);
+    assert(pContiguous != NULL);
+#endif
+    // *** Checking Parameters ***
+    if (pHandle == NULL || ppData == NULL || pContiguous == NULL || _IS_OVERWRITING(pHandle))
+        return FIFO_WRONG_PARAM;
+
+    *pContiguous = 0;
+    if (!_lock(pHandle, _READ_LOCK))
+    {
+        return FIFO_BUISY;
+    }
+_ENTER_CRITICAL();
+    FIFO_INDEX_TYPE read_idx = pHandle->read_idx, write_idx = _writeIdxOfConsumer(pHandle, read_idx, n);
+_LEAVE_CRITICAL();
+
+    // *** Limit to the fill level and to the end of the fifo memory ***
+    size_t first = _slot(pHandle, read_idx);
+    size_t level = _level(pHandle, write_idx, read_idx);
+    if (level == 0 && _RECHECK_EMPTY(pHandle, read_idx, &write_idx))
+    {
+        level = _level(pHandle, write_idx, read_idx);
+    }
+    size_t contiguous = _contiguous(pHandle, first) / pHandle->basetype_size;
+    if (contiguous > level)
+    {
+        contiguous = level;
+    }
+    if (contiguous > n)
+    {
+        contiguous = n;
+    }
+    if (contiguous == 0)
+    {
+        _unlock(pHandle, _READ_LOCK);
+        return FIFO_EMPTY;
+    }
+    *ppData = (uint8_t *)pHandle->pFifo + first;
+    *pContiguous = contiguous;
+    return FIFO_NO_ERROR;
 }
 
 /**
- * @brief acts as if the fifo had been read
- * This may be useful to read from the fifo outside of this library, for example if a function gets passed a fifo pointer
- * and it reads multiple times from the fifo without calling a fifo function
- * @note Be careful when reading from the fifo without fifo functions!!
+ * @brief removes n elements read after fifo_read_peek() and unlocks the fifo
  * @param pHandle pointer to the fifo handle
- * @param n ammount of read cycles to be skipped
+ * @param n ammount of elements consumed, at most *pContiguous of the peek, may be 0
  * @return fifoerror_t
  */
-fifoerror_t fifo_skip_read(fifo_handle_t *pHandle)
+fifoerror_t fifo_read_release(volatile fifo_handle_t *pHandle, FIFO_INDEX_TYPE n)
 {
-    return fifo_skip_read_n(pHandle, 1);
+    fifoerror_t ret = FIFO_NO_ERROR;
+#ifdef _DEBUG
+    assert(pHandle != NULL);
+#endif
+    // *** Checking Parameters ***
+    if (pHandle == NULL || _IS_OVERWRITING(pHandle))
+        return FIFO_WRONG_PARAM;
+
+_ENTER_CRITICAL();
+    FIFO_INDEX_TYPE read_idx = pHandle->read_idx, write_idx = _writeIdxOfConsumer(pHandle, read_idx, n);
+_LEAVE_CRITICAL();
+    if (n > _level(pHandle, write_idx, read_idx))     // more than available
+    {
+        ret = FIFO_WRONG_PARAM;
+    }
+    else if (n > 0)
+    {
+        _STORE_IDX(pHandle->read_idx, _advance(pHandle, read_idx, n));       // release the slots
+        _NOTIFY_SPACE(pHandle);
+    }
+    _unlock(pHandle, _READ_LOCK);
+    return ret;
 }
 
 /**
- * @brief acts as if the fifo had been read n times
- * This may be useful to read from the fifo outside of this library, for example if a function gets passed a fifo pointer
- * and it reads multiple times from the fifo without calling a fifo function
- * @note Be careful when reading from the fifo without fifo functions!!
+ * @brief passes up to max_elems elements in place to callback and removes them
+ * write_idx is read once and read_idx is published once for all of them. The callback gets called once per
+ * contiguous chunk, twice if the elements wrap around the end of the fifo memory.
+ * @note the fifo is read-locked while the callback runs, it must not read from the same fifo
  * @param pHandle pointer to the fifo handle
- * @param n ammount of read cycles to be skipped
+ * @param callback function that gets the elements
+ * @param pCtx context pointer passed to the callback
+ * @param max_elems maximum ammount of elements to drain
+ * @param [out] pDrained ammount of elements drained, may be NULL
+ * @retval FIFO_NO_ERROR    at least one element was drained
+ * @retval FIFO_EMPTY       the fifo is empty, the callback was not called
  * @return fifoerror_t
  */
-fifoerror_t fifo_skip_read_n(fifo_handle_t *pHandle, FIFO_INDEX_TYPE n)
+fifoerror_t fifo_drain(volatile fifo_handle_t *pHandle, fifo_drain_callback_t callback, void *pCtx, FIFO_INDEX_TYPE max_elems, FIFO_INDEX_TYPE *pDrained)
 {
 #ifdef _DEBUG
     assert(pHandle != NULL);
+    assert(callback != NULL);
 #endif
     // *** Checking Parameters ***
-    if (pHandle == NULL)
+    if (pHandle == NULL || callback == NULL || _IS_OVERWRITING(pHandle))
         return FIFO_WRONG_PARAM;
 
-    FIFO_INDEX_TYPE idx_temp;
-
-FIFO_ENTER_CRITICAL();
-    if (pHandle->_lock & _READ_LOCK)   // fifo is read-locked
+    if (pDrained != NULL)
+    {
+        *pDrained = 0;
+    }
+    if (!_lock(pHandle, _READ_LOCK))
     {
-        FIFO_LEAVE_CRITICAL();
         return FIFO_BUISY;
     }
+_ENTER_CRITICAL();
+    FIFO_INDEX_TYPE read_idx = pHandle->read_idx, write_idx = _writeIdxOfConsumer(pHandle, read_idx, max_elems);
+_LEAVE_CRITICAL();
 
-    // *** Check if data available ***
-    if (pHandle->write_idx == pHandle->read_idx)  // no data in fifo
+    // *** Snapshot of the available elements ***
+    size_t n = _level(pHandle, write_idx, read_idx);
+    if (n == 0 && _RECHECK_EMPTY(pHandle, read_idx, &write_idx))
+    {
+        n = _level(pHandle, write_idx, read_idx);
+    }
+    if (n > max_elems)
+    {
+        n = max_elems;
+    }
+    if (n == 0)
     {
-        FIFO_LEAVE_CRITICAL();
+        _unlock(pHandle, _READ_LOCK);
         return FIFO_EMPTY;
     }
 
-    // *** Limit skipped elements to available elements ***
-    FIFO_INDEX_TYPE level = fifo_getLevel(pHandle);
-    if (n > level)
+    // *** Up to the end of the fifo memory, then the rest from its start ***
+    size_t first = _slot(pHandle, read_idx);
+    size_t contiguous = _contiguous(pHandle, first) / pHandle->basetype_size;
+    if (contiguous >= n)
     {
-        n = level;
+        callback(pCtx, (uint8_t *)pHandle->pFifo + first, n);
+    }
+    else
+    {
+        callback(pCtx, (uint8_t *)pHandle->pFifo + first, contiguous);
+        callback(pCtx, pHandle->pFifo, n - contiguous);
+    }
+
+    // *** Release all of them at once ***
+    _STORE_IDX(pHandle->read_idx, _advance(pHandle, read_idx, n));
+    _NOTIFY_SPACE(pHandle);
+    _unlock(pHandle, _READ_LOCK);
+    if (pDrained != NULL)
+    {
+        *pDrained = n;
     }
+    return FIFO_NO_ERROR;
+}
+
+/**
+ * @brief puts a record of len bytes into a byte fifo
+ * The record is stored with a length prefix of FIFO_RECORD_HEADER_SIZE bytes and never wraps around the end of the
+ * fifo memory. Where it does not fit in one piece, the rest of the memory is skipped with a marker.
+ * A record and its prefix may use at most half of the fifo, so that it always fits into the empty fifo.
+ * @note records can not be mixed with fifo_put() / fifo_get() on the same fifo, basetype_size has to be 1
+ * @param pHandle pointer to the fifo handle
+ * @param [in] pData pointer to the record
+ * @param len length of the record in bytes, may be 0
+ * @retval FIFO_WRONG_PARAM the record is bigger than half of the fifo
+ * @retval FIFO_FULL        not enough space left
+ * @return fifoerror_t
+ */
+fifoerror_t fifo_put_record(volatile fifo_handle_t *pHandle, const void *pData, FIFO_INDEX_TYPE len)
+{
+#ifdef _DEBUG
+    assert(pHandle != NULL);
+    assert(pData != NULL || len == 0);
+#endif
+    // *** Checking Parameters ***
+    if (pHandle == NULL || (pData == NULL && len > 0) || pHandle->basetype_size != 1)
+        return FIFO_WRONG_PARAM;
+    size_t need = FIFO_RECORD_HEADER_SIZE + (size_t)len;
+    if (need > (size_t)(pHandle->size -1) / 2)     // the skipped bytes are less than need
+        return FIFO_WRONG_PARAM;
+#ifdef _FIFO_WIDE
+    if ((size_t)len >= _RECORD_PAD)     // the length prefix has 32 bits, the narrow index can not reach it
+        return FIFO_WRONG_PARAM;
+#endif
 
-    // *** Ring ***
-    idx_temp = pHandle->read_idx + pHandle->basetype_size * n;
+    if (!_lock(pHandle, _WRITE_LOCK))
+    {
+        return FIFO_BUISY;
+    }
+    FIFO_INDEX_TYPE write_idx = pHandle->write_idx;     // only changed by the producer
+    size_t first = _slot(pHandle, write_idx);
+    size_t skip = _contiguous(pHandle, first);
+    if (skip >= need)   // fits in one piece
+    {
+        skip = 0;
+    }
+_ENTER_CRITICAL();
+    FIFO_INDEX_TYPE read_idx = _readIdxOfProducer(pHandle, write_idx, skip + need);
+_LEAVE_CRITICAL();
 
-    if (idx_temp >= pHandle->size) 
+    // *** Check if there is space for the skipped bytes and the record ***
+    if (skip + need > _space(pHandle, write_idx, read_idx))
     {
-        idx_temp -= pHandle->size;
+        _unlock(pHandle, _WRITE_LOCK);
+        return FIFO_FULL;
     }
-    pHandle->read_idx = idx_temp;
-FIFO_LEAVE_CRITICAL();
 
+    // *** Skip marker, then the record with its length prefix ***
+    uint8_t *pRecord = (uint8_t *)pHandle->pFifo + first;
+    uint32_t header = _RECORD_PAD;
+    if (skip >= FIFO_RECORD_HEADER_SIZE)
+    {
+        memcpy(pRecord, &header, FIFO_RECORD_HEADER_SIZE);
+    }
+    if (skip > 0)
+    {
+        pRecord = (uint8_t *)pHandle->pFifo;
+    }
+    header = (uint32_t)len;
+    memcpy(pRecord, &header, FIFO_RECORD_HEADER_SIZE);
+    memcpy(pRecord + FIFO_RECORD_HEADER_SIZE, pData, len);
+    _STORE_IDX(pHandle->write_idx, _advance(pHandle, write_idx, skip + need));     // publish the record
+    _NOTIFY_DATA(pHandle);
+    _NOTIFY_READY(pHandle, write_idx);
+    _unlock(pHandle, _WRITE_LOCK);
     return FIFO_NO_ERROR;
 }
 
 /**
- * @brief acts as if something had been written to the fifo without changing its contents
- * This may be useful to write to the fifo outside of this library, for example if a function gets passed a fifo pointer
- * and it writes multiple times to the fifo without calling a fifo function
- * @note Be careful when writing to the fifo without fifo functions!!
+ * @brief gets the next record from a byte fifo
  * @param pHandle pointer to the fifo handle
+ * @param [out] pData pointer to the storage for the record
+ * @param max_len size of the storage in bytes
+ * @param [out] pLen length of the record, also set if it is bigger than max_len
+ * @retval FIFO_WRONG_PARAM the record is bigger than max_len, it stays in the fifo
+ * @retval FIFO_EMPTY       no record in the fifo
  * @return fifoerror_t
  */
-fifoerror_t fifo_skip_write(fifo_handle_t *pHandle)
+fifoerror_t fifo_get_record(volatile fifo_handle_t *pHandle, void *pData, FIFO_INDEX_TYPE max_len, FIFO_INDEX_TYPE *pLen)
 {
-    return fifo_skip_write_n(pHandle, 1);
+    void *pRecord;
+    fifoerror_t ret;
+#ifdef _DEBUG
+    assert(pData != NULL || max_len == 0);
+    assert(pLen != NULL);
+#endif
+    // *** Checking Parameters ***
+    if ((pData == NULL && max_len > 0) || pLen == NULL)
+        return FIFO_WRONG_PARAM;
+
+    if ((ret = fifo_peek_record(pHandle, &pRecord, pLen)) != FIFO_NO_ERROR)
+        return ret;
+    if (*pLen > max_len)
+    {
+        _unlock(pHandle, _READ_LOCK);
+        return FIFO_WRONG_PARAM;
+    }
+    memcpy(pData, pRecord, *pLen);
+    return fifo_release_record(pHandle);
 }
 
 /**
- * @brief acts as if the fifo had been written to n times without changing its contents on the physical memory
- * This may be useful to write to the fifo outside of this library, for example if a function gets passed a fifo pointer
- * and it writes multiple times to the fifo without calling a fifo function
- * @note Be careful when writing to the fifo without fifo functions!!
+ * @brief gives access to the next record of a byte fifo in place, without copying it
+ * The record gets removed with fifo_release_record(), which has to be called after every successful peek.
+ * @note the fifo stays read-locked until fifo_release_record() is called
  * @param pHandle pointer to the fifo handle
- * @param n ammount of write cycles to be skipped
+ * @param [out] ppData pointer to the record in the fifo memory
+ * @param [out] pLen length of the record
+ * @retval FIFO_EMPTY       no record in the fifo, the fifo is not locked
  * @return fifoerror_t
  */
-fifoerror_t fifo_skip_write_n(fifo_handle_t *pHandle, FIFO_INDEX_TYPE n)
+fifoerror_t fifo_peek_record(volatile fifo_handle_t *pHandle, void **ppData, FIFO_INDEX_TYPE *pLen)
 {
-        fifoerror_t ret;
 #ifdef _DEBUG
     assert(pHandle != NULL);
+    assert(ppData != NULL);
+    assert(pLen != NULL);
 #endif
     // *** Checking Parameters ***
-    if (pHandle == NULL)
-        return FIFO_WRONG_PARAM;
-    if (pHandle == 0)
+    if (pHandle == NULL || ppData == NULL || pLen == NULL || pHandle->basetype_size != 1 || _IS_OVERWRITING(pHandle))
         return FIFO_WRONG_PARAM;
 
-FIFO_ENTER_CRITICAL();
-    if (pHandle->_lock & _WRITE_LOCK)   // fifo is write-locked
+    *pLen = 0;
+    if (!_lock(pHandle, _READ_LOCK))
     {
-        FIFO_LEAVE_CRITICAL();
         return FIFO_BUISY;
     }
+_ENTER_CRITICAL();
+    FIFO_INDEX_TYPE read_idx = pHandle->read_idx, write_idx = _writeIdxOfConsumer(pHandle, read_idx, 1);
+_LEAVE_CRITICAL();
 
-    // *** Limit skipped elements to available elements ***
-    FIFO_INDEX_TYPE space = fifo_getEmptySpace(pHandle);
-    if (n > space && space > 0)
+    // *** Records are published as a whole ***
+    if (_level(pHandle, write_idx, read_idx) == 0 && !_RECHECK_EMPTY(pHandle, read_idx, &write_idx))
     {
-        n = space;
+        _unlock(pHandle, _READ_LOCK);
+        return FIFO_EMPTY;
     }
+    uint8_t *pRecord;
+    uint32_t len;
+    _findRecord(pHandle, read_idx, &pRecord, &len);
+    *ppData = pRecord + FIFO_RECORD_HEADER_SIZE;
+    *pLen = len;
+    return FIFO_NO_ERROR;
+}
 
-    // *** Ring ***
-    FIFO_INDEX_TYPE idx_temp = pHandle->write_idx + pHandle->basetype_size * n;
-
-    if (idx_temp >= pHandle->size)
-    {
-        idx_temp -= pHandle->size;
-    }
+/**
+ * @brief removes the record read after fifo_peek_record() and unlocks the fifo
+ * @param pHandle pointer to the fifo handle
+ * @retval FIFO_WRONG_PARAM no record in the fifo
+ * @return fifoerror_t
+ */
+fifoerror_t fifo_release_record(volatile fifo_handle_t *pHandle)
+{
+    fifoerror_t ret = FIFO_NO_ERROR;
+#ifdef _DEBUG
+    assert(pHandle != NULL);
+#endif
+    // *** Checking Parameters ***
+    if (pHandle == NULL || _IS_OVERWRITING(pHandle))
+        return FIFO_WRONG_PARAM;
 
-    // *** Check if space available ***
-    if (idx_temp == pHandle->read_idx)  // No space
+_ENTER_CRITICAL();
+    FIFO_INDEX_TYPE read_idx = pHandle->read_idx, write_idx = _writeIdxOfConsumer(pHandle, read_idx, 1);
+_LEAVE_CRITICAL();
+    if (_level(pHandle, write_idx, read_idx) == 0)
     {
-        ret = FIFO_FULL;
+        ret = FIFO_WRONG_PARAM;
     }
     else
     {
-        ret = FIFO_NO_ERROR;
-        pHandle->write_idx = idx_temp;
+        uint8_t *pRecord;
+        uint32_t len;
+        size_t bytes = _findRecord(pHandle, read_idx, &pRecord, &len);
+        _STORE_IDX(pHandle->read_idx, _advance(pHandle, read_idx, bytes));     // release the record and the skipped bytes
+        _NOTIFY_SPACE(pHandle);
     }
-FIFO_LEAVE_CRITICAL();
+    _unlock(pHandle, _READ_LOCK);
     return ret;
 }
 
+#if FIFO_WAIT
 /**
- * @brief returns the fill level of a fifo
- * @param pHandle pointer to a fifo handle
- * @retval fill level of the fifo in elements
+ * @brief puts an element into the fifo, waits up to timeout_ms for free space
+ * @param pHandle pointer to the fifo handle
+ * @param [in] pData pointer to the data to be put onto the fifo
+ * @param timeout_ms maximum time to wait in ms, 0 = do not wait, negative = wait forever
+ * @return fifoerror_t
  */
-FIFO_INDEX_TYPE fifo_getLevel(fifo_handle_t *pHandle)
+fifoerror_t fifo_put_wait(volatile fifo_handle_t *pHandle, const void *pData, int32_t timeout_ms)
+{
+    struct timespec deadline;
+    return fifo_put_wait_until(pHandle, pData, _deadline(&deadline, timeout_ms));
+}
+
+/**
+ * @brief gets an element from the fifo, waits up to timeout_ms for an element
+ * @param pHandle pointer to the fifo handle
+ * @param [out] pData pointer to the storage for the data from the fifo
+ * @param timeout_ms maximum time to wait in ms, 0 = do not wait, negative = wait forever
+ * @return fifoerror_t
+ */
+fifoerror_t fifo_get_wait(volatile fifo_handle_t *pHandle, void *pData, int32_t timeout_ms)
+{
+    struct timespec deadline;
+    return fifo_get_wait_until(pHandle, pData, _deadline(&deadline, timeout_ms));
+}
+
+/**
+ * @brief puts an element into the fifo, waits until pDeadline for free space
+ * @param pHandle pointer to the fifo handle
+ * @param [in] pData pointer to the data to be put onto the fifo
+ * @param pDeadline absolute CLOCK_MONOTONIC time, NULL = wait forever, a passed deadline only tries once
+ * @return fifoerror_t
+ */
+fifoerror_t fifo_put_wait_until(volatile fifo_handle_t *pHandle, const void *pData, const struct timespec *pDeadline)
 {
 #ifdef _DEBUG
     assert(pHandle != NULL);
+    assert(pData != NULL);
 #endif
-    if (pHandle == NULL)
-    {
-        return 0;
-    }
-FIFO_ENTER_CRITICAL();
-    FIFO_INDEX_TYPE ret = pHandle->write_idx, read_idx = pHandle->read_idx;
-FIFO_LEAVE_CRITICAL();
-    if (read_idx > ret) // ret alias write_idx
-    {
-        ret += (pHandle->size - read_idx);
-    }
-    else    // because ret may overflow if this is not done in if / else
+    // *** Checking Parameters ***
+    if (pHandle == NULL || pData == NULL)
+        return FIFO_WRONG_PARAM;
+
+    fifoerror_t ret;
+    bool timeout = false;
+    while ((ret = fifo_put(pHandle, pData)) == FIFO_FULL && !timeout && !_expired(pDeadline))    // polling with a passed deadline makes no system call
     {
-        ret -= read_idx;
+        // *** Register as waiter, then check a last time before parking, see _wake() ***
+        uint32_t seq = __atomic_load_n(&pHandle->_space_seq, __ATOMIC_ACQUIRE);
+        __atomic_fetch_add(&pHandle->_space_waiters, 1, __ATOMIC_SEQ_CST);
+        __atomic_thread_fence(__ATOMIC_SEQ_CST);
+        if ((ret = fifo_put(pHandle, pData)) == FIFO_FULL)
+        {
+            timeout = !_park(&pHandle->_space_seq, seq, pDeadline);
+        }
+        __atomic_fetch_sub(&pHandle->_space_waiters, 1, __ATOMIC_RELAXED);
+        if (ret != FIFO_FULL)
+        {
+            break;
+        }
     }
-    return ret / pHandle->basetype_size;
+    return ret;
 }
 
 /**
- * @brief returns the empty space of a fifo
- * @param pHandle pointer to a fifo handle
- * @retval empty space in the fifo in elements
+ * @brief gets an element from the fifo, waits until pDeadline for an element
+ * @param pHandle pointer to the fifo handle
+ * @param [out] pData pointer to the storage for the data from the fifo
+ * @param pDeadline absolute CLOCK_MONOTONIC time, NULL = wait forever, a passed deadline only tries once
+ * @return fifoerror_t
  */
-FIFO_INDEX_TYPE fifo_getEmptySpace(fifo_handle_t *pHandle)
+fifoerror_t fifo_get_wait_until(volatile fifo_handle_t *pHandle, void *pData, const struct timespec *pDeadline)
 {
 #ifdef _DEBUG
     assert(pHandle != NULL);
+    assert(pData != NULL);
 #endif
-    if (pHandle == NULL)
+    // *** Checking Parameters ***
+    if (pHandle == NULL || pData == NULL)
+        return FIFO_WRONG_PARAM;
+
+    fifoerror_t ret;
+    bool timeout = false;
+    while ((ret = fifo_get(pHandle, pData)) == FIFO_EMPTY && !timeout && !_expired(pDeadline))    // polling with a passed deadline makes no system call
     {
-        return 0;
+        // *** Register as waiter, then check a last time before parking, see _wake() ***
+        uint32_t seq = __atomic_load_n(&pHandle->_data_seq, __ATOMIC_ACQUIRE);
+        __atomic_fetch_add(&pHandle->_data_waiters, 1, __ATOMIC_SEQ_CST);
+        __atomic_thread_fence(__ATOMIC_SEQ_CST);
+        if ((ret = fifo_get(pHandle, pData)) == FIFO_EMPTY)
+        {
+            timeout = !_park(&pHandle->_data_seq, seq, pDeadline);
+        }
+        __atomic_fetch_sub(&pHandle->_data_waiters, 1, __ATOMIC_RELAXED);
+        if (ret != FIFO_EMPTY)
+        {
+            break;
+        }
     }
-    return ((pHandle->size / pHandle->basetype_size) - fifo_getLevel(pHandle)) -1; // maximum fifo fill is size / basetype -1
-}
\ No newline at end of file
+    return ret;
+}
+#endif  /* FIFO_WAIT */
@@ -4,7 +4,7 @@
  * The Library consists of the fuctions fifo_init(), fifo_put() and fifo_get()
  * and the types fifoerror_t and fifo_handle_t
  * This library can handle multiple fifos of multiple data types.
- * @note each fifo can only store (size / basetype_size) -1 elements
+ * @note each fifo can only store (size / basetype_size) -1 elements, with FIFO_POW2 all size / basetype_size elements
  * @author Josef Aschwanden
  * @date Jul - 2020
  * @version 1.2
@@ -23,6 +23,7 @@ extern "C" {
 #endif
  
 // *** INCLUDES ***
+#include <stddef.h>
 #include <stdint.h>
 #include <stdbool.h>
 
@@ -34,6 +35,7 @@ extern "C" {
 /**
  * @brief maximum size of a fifo.
  * This Macro is internally needed for the fifo and should be set as small as possible
+ * @note fifos bigger than this can be created with fifo_wide.h
  */
 #define MAX_FIFO_SIZE   128
 
@@ -42,6 +44,78 @@ extern "C" {
  */
 #define FIFO_ALLOW_MALLOC   true
 
+/**
+ * @brief Enable the lock free single producer / single consumer mode
+ * In this mode one thread may write to a fifo (fifo_put(), fifo_skip_write()) while one other thread reads from it
+ * (fifo_get(), fifo_skip_read(), fifo_flush()). read_idx and write_idx are published with acquire / release atomics,
+ * there are no lock flags, FIFO_ENTER_CRITICAL() is never called and FIFO_BUISY is never returned.
+ * The handle gets cache line separated producer and consumer indices, see fifo_handle.h
+ * @note can be set from the build, eg: -DFIFO_SPSC=true
+ */
+#ifndef FIFO_SPSC
+#define FIFO_SPSC   false
+#endif
+
+/**
+ * @brief Enable the power of two mode
+ * The capacity of every fifo (size / basetype_size) has to be a power of two. read_idx and write_idx are free running
+ * element counters, slots are found with a mask and full / empty is told apart by the counter difference,
+ * so every slot can be used and the fill level is a subtraction
+ * @note can be set from the build, eg: -DFIFO_POW2=true
+ */
+#ifndef FIFO_POW2
+#define FIFO_POW2   false
+#endif
+
+/**
+ * @brief Enable the blocking functions fifo_put_wait() and fifo_get_wait() (Linux only)
+ * Waiting threads are parked on a futex, put / get only make a system call when a thread waits on the fifo
+ * @note can be set from the build, eg: -DFIFO_WAIT=true
+ */
+#ifndef FIFO_WAIT
+#define FIFO_WAIT   false
+#endif
+#if FIFO_WAIT
+#include <time.h>   // struct timespec
+#endif
+
+/**
+ * @brief Enable fifo_wide_init_mirror() (Linux only)
+ * The fifo memory is mapped twice back to back, so the elements after read_idx and the free slots after write_idx
+ * are always contiguous. fifo_read_peek() and fifo_write_reserve() of a mirrored fifo never stop at the end of the memory.
+ * @note can be set from the build, eg: -DFIFO_MIRROR=true
+ */
+#ifndef FIFO_MIRROR
+#define FIFO_MIRROR false
+#endif
+
+/**
+ * @brief Enable fifo_setOverwrite(), fifo_put() of an overwriting fifo drops the oldest element instead of returning FIFO_FULL
+ * The producer moves read_idx with a compare and swap (FIFO_SPSC) or in the critical section. fifo_get() copies the
+ * element first and only keeps it if read_idx was not moved in the meantime, so a lapped reader never returns torn data.
+ * @note can be set from the build, eg: -DFIFO_OVERWRITE=true
+ */
+#ifndef FIFO_OVERWRITE
+#define FIFO_OVERWRITE  false
+#endif
+
+/**
+ * @brief Enable fifo_setNotify(), a callback that is called by the producer when a put made the fifo non-empty
+ * The producer looks at read_idx after it published the new elements, the callback is only called when the fifo
+ * was empty before, so a steady stream of puts into a fifo that is not drained costs one load per put.
+ * @note can be set from the build, eg: -DFIFO_NOTIFY=true
+ */
+#ifndef FIFO_NOTIFY
+#define FIFO_NOTIFY     false
+#endif
+
+/**
+ * @brief size of a cache line in bytes, used to keep data written by different threads apart
+ */
+#ifndef FIFO_CACHE_LINE_SIZE
+#define FIFO_CACHE_LINE_SIZE    64
+#endif
+
 #if MAX_FIFO_SIZE <= UINT8_MAX
     #define FIFO_INDEX_TYPE uint8_t
 #elif MAX_FIFO_SIZE <= UINT16_MAX
@@ -74,6 +148,7 @@ extern "C" {
  * These Macros are only needed if multiple asynchrounous threads can access the fifo. 
  * They prevent variables from being changed in non atomic Opeartations
  * @note The enter and leave macro are always in the same scope so variables can be created in them
+ * @note The macros are not used when FIFO_SPSC is enabled
  */
 /**
  * @addtogroup async_macros
@@ -115,16 +190,33 @@ typedef enum{
 }fifoerror_t;
 
 /**
- * @brief this structure is used as handle for the fifo library
+ * @brief callback of fifo_drain(), gets n elements in a row from the fifo memory
+ * @param pCtx context pointer passed to fifo_drain()
+ * @param pData pointer to the oldest of the n elements
+ * @param n number of elements at pData
+ */
+typedef void (*fifo_drain_callback_t)(void *pCtx, const void *pData, size_t n);
+
+/**
+ * @brief callback of fifo_setNotify(), called by the producer after a put made the fifo non-empty
+ * @param pCtx context pointer passed to fifo_setNotify()
+ */
+typedef void (*fifo_notify_callback_t)(void *pCtx);
+
+/**
+ * @brief size of the length prefix of a record in bytes, see fifo_put_record()
  */
-typedef struct{
-    SIZE_FIFO_BASE_TYPE basetype_size;      /*!< sizeof the fifo basetype (bytes) */
-    FIFO_INDEX_TYPE size;                   /*!< size of the fifo memory (bytes) */
-    FIFO_INDEX_TYPE read_idx;               /*!< read index for fifo read access, offset from pFifo in bytes */
-    FIFO_INDEX_TYPE write_idx;              /*!< write index for fifo write access, offset from pFifo in bytes */
-    void *pFifo;                            /*!< pointer to the first adress of the fifo memory */
-	uint8_t _lock;                          /*!< flag to lock the fifo */
-}fifo_handle_t;
+#define FIFO_RECORD_HEADER_SIZE sizeof(uint32_t)
+
+/**
+ * @brief alignment of read_idx in the handle of an overwriting FIFO_SPSC fifo, read_idx and dropped after it
+ * are moved together with one compare and swap of this size
+ */
+#define FIFO_READ_POS_ALIGN(index_type) (2 * sizeof(index_type) > sizeof(uint64_t) ? 2 * sizeof(index_type) : sizeof(uint64_t))
+
+#define FIFO_HANDLE_NAME        fifo_handle_t
+#define FIFO_HANDLE_INDEX_TYPE  FIFO_INDEX_TYPE
+#include "fifo_handle.h"
 
 /** @defgroup fifo_core Core Fifo Functions
  * @brief Functions essential for the use of the fifo
@@ -146,12 +238,14 @@ typedef struct{
  * @retval -2 = invalid fifo size
  * @retval -3 = invalid basetype_size
  * @retval -4 = size_fifo is not a multiple of basetype_size
+ * @retval -5 = size_fifo / basetype_size is not a power of two (FIFO_POW2)
  */
 int8_t fifo_init(volatile fifo_handle_t *pHandle, void *pFifo, FIFO_INDEX_TYPE size_fifo, SIZE_FIFO_BASE_TYPE basetype_size);
 
 #if FIFO_ALLOW_MALLOC
 /**
  * @brief allocates a fifo handle and the fifo memory, and initializes it
+ * The handle and the fifo memory are one block, the fifo memory is aligned to FIFO_CACHE_LINE_SIZE
  * @note If _DEBUG is defined every Parameter will be checked with assert()
  * @note memory has to be freed with fifo_deinit_free()
  * @param size_fifo size of the fifo in elements
@@ -161,11 +255,25 @@ int8_t fifo_init(volatile fifo_handle_t *pHandle, void *pFifo, FIFO_INDEX_TYPE s
  */
 fifo_handle_t* fifo_init_malloc(FIFO_INDEX_TYPE size_fifo, SIZE_FIFO_BASE_TYPE basetype_size);
 
+/**
+ * @brief allocates a fifo handle and the fifo memory in one aligned block, and initializes it
+ * The block starts with the handle, the fifo memory follows on the next multiple of alignment
+ * @note memory has to be freed with fifo_deinit_free()
+ * @param size_fifo size of the fifo in elements
+ * @param basetype_size size of the fifo basetype eg: sizeof(uint8_t)
+ * @param alignment alignment of the handle and the fifo memory in bytes, a power of two and at least sizeof(void *),
+ * raised to the alignment of the handle if it is smaller
+ * @retval NULL = failed, invalid parameter or alignment
+ * @return pointer to the fifo handle
+ */
+fifo_handle_t* fifo_init_malloc_aligned(FIFO_INDEX_TYPE size_fifo, SIZE_FIFO_BASE_TYPE basetype_size, size_t alignment);
+
 /**
  * @brief deallocates a fifo handle and its buffer
  * @param pHandle pointer to the Fifo handle
  */
 void fifo_deinit_free(volatile fifo_handle_t *pHandle);
+
 #endif   /* FIFO_ALLOW_MALLOC */
 
 /**
@@ -185,6 +293,34 @@ fifoerror_t fifo_put(volatile fifo_handle_t *pHandle, const void *pData);
  * @return fifoerror_t
  */
 fifoerror_t fifo_get(volatile fifo_handle_t* pHandle, void *pData);
+
+/**
+ * @brief puts up to n elements into the fifo with one lock and one update of write_idx
+ * The elements are copied with at most two memcpy calls (before and after the wrap point)
+ * @note If _DEBUG is defined every Parameter will be checked with assert()
+ * @param pHandle pointer to the fifo handle
+ * @param [in] pData pointer to the n elements to be put onto the fifo
+ * @param n ammount of elements
+ * @param [out] pWritten number of elements put onto the fifo, may be NULL
+ * @retval FIFO_NO_ERROR    all n elements were put onto the fifo
+ * @retval FIFO_FULL        only *pWritten elements fitted into the fifo
+ * @return fifoerror_t
+ */
+fifoerror_t fifo_put_n(volatile fifo_handle_t *pHandle, const void *pData, FIFO_INDEX_TYPE n, FIFO_INDEX_TYPE *pWritten);
+
+/**
+ * @brief gets up to n elements from the fifo with one lock and one update of read_idx
+ * The elements are copied with at most two memcpy calls (before and after the wrap point)
+ * @note If _DEBUG is defined every Parameter will be checked with assert()
+ * @param pHandle pointer to the fifo handle
+ * @param [out] pData pointer to the storage for n elements
+ * @param n ammount of elements
+ * @param [out] pRead number of elements read from the fifo, may be NULL
+ * @retval FIFO_NO_ERROR    all n elements were read
+ * @retval FIFO_EMPTY       only *pRead elements were in the fifo
+ * @return fifoerror_t
+ */
+fifoerror_t fifo_get_n(volatile fifo_handle_t *pHandle, void *pData, FIFO_INDEX_TYPE n, FIFO_INDEX_TYPE *pRead);
 /**
  * @}
  */
@@ -215,6 +351,7 @@ bool fifo_hasSpaceLeft(volatile fifo_handle_t *pHandle);
 /**
  * @brief flushes a FIFO
  * @return FIFO_NO_ERROR    Everything worked
+ * @return FIFO_WRONG_PARAM NULL pointer or an overwriting fifo
  * @return FIFO_BUISY       FIFO handle is locked
  */
 fifoerror_t fifo_flush(volatile fifo_handle_t *pHandle);
@@ -283,9 +420,230 @@ FIFO_INDEX_TYPE fifo_getLevel(fifo_handle_t *pHandle);
  */
 FIFO_INDEX_TYPE fifo_getEmptySpace(fifo_handle_t *pHandle);
 
+#if FIFO_OVERWRITE
+/**
+ * @brief sets the overflow policy of a fifo, has to be called before the fifo is used
+ * An overwriting fifo never returns FIFO_FULL from fifo_put(), the oldest element gets dropped and counted instead.
+ * @note the consumer of an overwriting fifo has to use fifo_get(), the other read functions (fifo_get_n(),
+ * fifo_read_peek() / fifo_read_release(), fifo_drain(), fifo_skip_read_n(), fifo_flush() and the record functions) return
+ * FIFO_WRONG_PARAM, they would overwrite read_idx after the producer moved it. The other write functions still
+ * return FIFO_FULL.
+ * @param pHandle pointer to the fifo handle
+ * @param overwrite true = drop the oldest element when the fifo is full
+ * @return fifoerror_t
+ */
+fifoerror_t fifo_setOverwrite(volatile fifo_handle_t *pHandle, bool overwrite);
+
+/**
+ * @brief returns the number of elements dropped by fifo_put() of an overwriting fifo since it was initialized
+ * @param pHandle pointer to the fifo handle
+ * @retval dropped elements
+ */
+uint32_t fifo_getDropped(volatile fifo_handle_t *pHandle);
+#endif  /* FIFO_OVERWRITE */
+
+#if FIFO_NOTIFY
+/**
+ * @brief sets the callback that is called when a put makes the fifo non-empty, has to be called before the fifo is used
+ * The callback runs in the thread of the producer, right after the elements were published. It is called by
+ * fifo_put(), fifo_put_n(), fifo_skip_write_n(), fifo_write_commit() and fifo_put_record().
+ * @note the consumer has to look at the fifo until it is empty after a notification, the next one only comes
+ * after the fifo was empty again
+ * @param pHandle pointer to the fifo handle
+ * @param callback function to call, NULL = no notification
+ * @param pCtx context pointer passed to the callback, kept when callback is NULL
+ * @return fifoerror_t
+ */
+fifoerror_t fifo_setNotify(volatile fifo_handle_t *pHandle, fifo_notify_callback_t callback, void *pCtx);
+
+/**
+ * @brief creates an eventfd that becomes readable when a put makes the fifo non-empty (Linux only)
+ * The eventfd is the notify callback of the fifo, so it can be waited for with poll() / epoll_wait() like any other
+ * file descriptor. The producer only writes to it on the empty -> non-empty transition.
+ * @note the consumer has to read the eventfd first and then get elements until FIFO_EMPTY, a put after the read
+ * makes the eventfd readable again
+ * @param pHandle pointer to the fifo handle
+ * @retval -1 = failed
+ * @return non blocking eventfd, readable right away if the fifo holds elements
+ */
+int fifo_openEventfd(volatile fifo_handle_t *pHandle);
+
+/**
+ * @brief clears the notify callback of the fifo and closes the eventfd from fifo_openEventfd()
+ * @note the producer has to be stopped first: a put that loaded the callback before it was cleared still writes to
+ * the eventfd, which may be closed and reused for another file by then
+ * @param pHandle pointer to the fifo handle
+ * @param fd eventfd returned by fifo_openEventfd()
+ * @return fifoerror_t
+ */
+fifoerror_t fifo_closeEventfd(volatile fifo_handle_t *pHandle, int fd);
+#endif  /* FIFO_NOTIFY */
+
+/**
+ * @brief reserves up to n free slots for writing them in place
+ * *ppData points to the first free slot in the fifo memory, *pContiguous slots can be written from there on.
+ * *pContiguous may be smaller than n because of the end of the fifo memory or the free space.
+ * The slots get published with fifo_write_commit(), which has to be called after every successful reserve.
+ * @note the fifo stays write-locked until fifo_write_commit() is called
+ * @param pHandle pointer to the fifo handle
+ * @param n ammount of slots wanted
+ * @param [out] ppData pointer to the first reserved slot
+ * @param [out] pContiguous number of contiguous slots reserved
+ * @retval FIFO_NO_ERROR    at least one slot was reserved
+ * @retval FIFO_FULL        no slot is free, the fifo is not locked
+ * @return fifoerror_t
+ */
+fifoerror_t fifo_write_reserve(volatile fifo_handle_t *pHandle, FIFO_INDEX_TYPE n, void **ppData, FIFO_INDEX_TYPE *pContiguous);
+
+/**
+ * @brief publishes n slots written after fifo_write_reserve() and unlocks the fifo
+ * @param pHandle pointer to the fifo handle
+ * @param n ammount of slots written, at most *pContiguous of the reserve, may be 0
+ * @return fifoerror_t
+ */
+fifoerror_t fifo_write_commit(volatile fifo_handle_t *pHandle, FIFO_INDEX_TYPE n);
+
+/**
+ * @brief gives access to up to n elements in place, without copying them
+ * *ppData points to the oldest element in the fifo memory, *pContiguous elements can be read from there on.
+ * *pContiguous may be smaller than n because of the end of the fifo memory or the fill level.
+ * The elements get removed with fifo_read_release(), which has to be called after every successful peek.
+ * @note the fifo stays read-locked until fifo_read_release() is called
+ * @param pHandle pointer to the fifo handle
+ * @param n ammount of elements wanted
+ * @param [out] ppData pointer to the oldest element
+ * @param [out] pContiguous number of contiguous elements available
+ * @retval FIFO_NO_ERROR    at least one element is available
+ * @retval FIFO_EMPTY       the fifo is empty, the fifo is not locked
+ * @return fifoerror_t
+ */
+fifoerror_t fifo_read_peek(volatile fifo_handle_t *pHandle, FIFO_INDEX_TYPE n, void **ppData, FIFO_INDEX_TYPE *pContiguous);
+
+/**
+ * @brief removes n elements read after fifo_read_peek() and unlocks the fifo
+ * @param pHandle pointer to the fifo handle
+ * @param n ammount of elements consumed, at most *pContiguous of the peek, may be 0
+ * @return fifoerror_t
+ */
+fifoerror_t fifo_read_release(volatile fifo_handle_t *pHandle, FIFO_INDEX_TYPE n);
+
+/**
+ * @brief passes up to max_elems elements in place to callback and removes them
+ * write_idx is read once and read_idx is published once for all of them. The callback gets called once per
+ * contiguous chunk, twice if the elements wrap around the end of the fifo memory.
+ * @note the fifo is read-locked while the callback runs, it must not read from the same fifo
+ * @param pHandle pointer to the fifo handle
+ * @param callback function that gets the elements
+ * @param pCtx context pointer passed to the callback
+ * @param max_elems maximum ammount of elements to drain
+ * @param [out] pDrained ammount of elements drained, may be NULL
+ * @retval FIFO_NO_ERROR    at least one element was drained
+ * @retval FIFO_EMPTY       the fifo is empty, the callback was not called
+ * @return fifoerror_t
+ */
+fifoerror_t fifo_drain(volatile fifo_handle_t *pHandle, fifo_drain_callback_t callback, void *pCtx, FIFO_INDEX_TYPE max_elems, FIFO_INDEX_TYPE *pDrained);
+
+/**
+ * @brief puts a record of len bytes into a byte fifo
+ * The record is stored with a length prefix of FIFO_RECORD_HEADER_SIZE bytes and never wraps around the end of the
+ * fifo memory. Where it does not fit in one piece, the rest of the memory is skipped with a marker.
+ * A record and its prefix may use at most half of the fifo, so that it always fits into the empty fifo.
+ * @note records can not be mixed with fifo_put() / fifo_get() on the same fifo, basetype_size has to be 1
+ * @param pHandle pointer to the fifo handle
+ * @param [in] pData pointer to the record
+ * @param len length of the record in bytes, may be 0
+ * @retval FIFO_WRONG_PARAM the record is bigger than half of the fifo
+ * @retval FIFO_FULL        not enough space left
+ * @return fifoerror_t
+ */
+fifoerror_t fifo_put_record(volatile fifo_handle_t *pHandle, const void *pData, FIFO_INDEX_TYPE len);
+
+/**
+ * @brief gets the next record from a byte fifo
+ * @param pHandle pointer to the fifo handle
+ * @param [out] pData pointer to the storage for the record
+ * @param max_len size of the storage in bytes
+ * @param [out] pLen length of the record, also set if it is bigger than max_len
+ * @retval FIFO_WRONG_PARAM the record is bigger than max_len, it stays in the fifo
+ * @retval FIFO_EMPTY       no record in the fifo
+ * @return fifoerror_t
+ */
+fifoerror_t fifo_get_record(volatile fifo_handle_t *pHandle, void *pData, FIFO_INDEX_TYPE max_len, FIFO_INDEX_TYPE *pLen);
+
+/**
+ * @brief gives access to the next record of a byte fifo in place, without copying it
+ * The record gets removed with fifo_release_record(), which has to be called after every successful peek.
+ * @note the fifo stays read-locked until fifo_release_record() is called
+ * @param pHandle pointer to the fifo handle
+ * @param [out] ppData pointer to the record in the fifo memory
+ * @param [out] pLen length of the record
+ * @retval FIFO_EMPTY       no record in the fifo, the fifo is not locked
+ * @return fifoerror_t
+ */
+fifoerror_t fifo_peek_record(volatile fifo_handle_t *pHandle, void **ppData, FIFO_INDEX_TYPE *pLen);
+
+/**
+ * @brief removes the record read after fifo_peek_record() and unlocks the fifo
+ * @param pHandle pointer to the fifo handle
+ * @retval FIFO_WRONG_PARAM no record in the fifo
+ * @return fifoerror_t
+ */
+fifoerror_t fifo_release_record(volatile fifo_handle_t *pHandle);
+
+/**
+ * @}
+ */
+
+#if FIFO_WAIT
+/** @defgroup fifo_wait Blocking Fifo Functions
+ * @brief Functions that park the calling thread while the fifo is full / empty, enabled with FIFO_WAIT
+ * @note a timeout returns FIFO_FULL / FIFO_EMPTY like the non blocking functions
+ */
+
+/**
+ * @addtogroup fifo_wait
+ * @{
+ */
+
+/**
+ * @brief puts an element into the fifo, waits up to timeout_ms for free space
+ * @param pHandle pointer to the fifo handle
+ * @param [in] pData pointer to the data to be put onto the fifo
+ * @param timeout_ms maximum time to wait in ms, 0 = do not wait, negative = wait forever
+ * @return fifoerror_t
+ */
+fifoerror_t fifo_put_wait(volatile fifo_handle_t *pHandle, const void *pData, int32_t timeout_ms);
+
+/**
+ * @brief gets an element from the fifo, waits up to timeout_ms for an element
+ * @param pHandle pointer to the fifo handle
+ * @param [out] pData pointer to the storage for the data from the fifo
+ * @param timeout_ms maximum time to wait in ms, 0 = do not wait, negative = wait forever
+ * @return fifoerror_t
+ */
+fifoerror_t fifo_get_wait(volatile fifo_handle_t *pHandle, void *pData, int32_t timeout_ms);
+
+/**
+ * @brief puts an element into the fifo, waits until pDeadline for free space
+ * @param pHandle pointer to the fifo handle
+ * @param [in] pData pointer to the data to be put onto the fifo
+ * @param pDeadline absolute CLOCK_MONOTONIC time, NULL = wait forever, a passed deadline only tries once
+ * @return fifoerror_t
+ */
+fifoerror_t fifo_put_wait_until(volatile fifo_handle_t *pHandle, const void *pData, const struct timespec *pDeadline);
+
+/**
+ * @brief gets an element from the fifo, waits until pDeadline for an element
+ * @param pHandle pointer to the fifo handle
+ * @param [out] pData pointer to the storage for the data from the fifo
+ * @param pDeadline absolute CLOCK_MONOTONIC time, NULL = wait forever, a passed deadline only tries once
+ * @return fifoerror_t
+ */
+fifoerror_t fifo_get_wait_until(volatile fifo_handle_t *pHandle, void *pData, const struct timespec *pDeadline);
 /**
  * @}
  */
+#endif  /* FIFO_WAIT */
 
 #ifdef __cplusplus
 }
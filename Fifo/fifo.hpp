@@ -1,18 +1,465 @@
 /**
  * @brief this file contains a c++ template wrapper class for the c fifo library
+ * Fifo<T> uses the wide fifos (fifo_wide.h), so its size is not limited by MAX_FIFO_SIZE
+ * Fifo<T, N> keeps N elements inside the object and needs no heap memory
+ * Fifo<T> also takes types that are not trivially copyable, they are constructed in place and moved out,
+ * the copy functions of the c library are only compiled for trivially copyable types (if constexpr, C++17)
+ * getSegments() and consume() let the consumer read the elements in place, without copying them out
+ * drain() passes the elements in place to a function and removes them all at once
  * @author Josef Aschwanden
  * @date 29.07.2020
  * @version 1.0
  */
 // *** INCLUDES ***
-#include "fifo.h"
+#include "fifo_wide.h"
+#include <cstddef>
+#include <cstdint>
+#include <iterator>
+#include <new>
 #include <string>
+#include <type_traits>
+#include <utility>
+#if __cplusplus >= 202002L && defined(__has_include)
+#if __has_include(<span>)
+#include <span>
+#endif
+#endif
 
 #pragma once
 
 namespace utils{
+    /**
+     * @brief returns the error string of a fifoerror_t
+     */
+    inline std::string fifoErrorStr(fifoerror_t error)
+    {
+        std::string ret;
+        switch (error)
+        {
+            case FIFO_NO_ERROR: ret = "No Error"; break;
+            case FIFO_WRONG_PARAM: ret = "Wrong Parameter"; break;
+            case FIFO_BUISY: ret = "Fifo is Buisy"; break;
+            case FIFO_EMPTY: ret = "Fifo is empty"; break;
+            case FIFO_FULL: ret = "Fifo is full"; break;
+        }
+        return ret;
+    }
+
+    /**
+     * @brief contiguous read only view of elements in the fifo memory, std::span<const T> when available
+     */
+#ifdef __cpp_lib_span
+    template<typename T>
+    using FifoSpan = std::span<const T>;
+#else
+    template<typename T>
+    class FifoSpan{
+    public:
+        FifoSpan() : m_pData(nullptr), m_size(0) {}
+        FifoSpan(const T* pData, size_t size) : m_pData(pData), m_size(size) {}
+        const T* data() const { return m_pData; }
+        size_t size() const { return m_size; }
+        bool empty() const { return m_size == 0; }
+        const T* begin() const { return m_pData; }
+        const T* end() const { return m_pData + m_size; }
+        const T& operator[](size_t i) const { return m_pData[i]; }
+    private:
+        const T* m_pData;
+        size_t m_size;
+    };
+#endif
+
+    /**
+     * @brief the readable elements of a fifo at the time of getSegments(), oldest first
+     * The elements are in first and, if they wrap around the end of the fifo memory, in second.
+     * It is also a forward range over all of them, eg: std::accumulate(seg.begin(), seg.end(), 0)
+     * @note the elements stay valid until the consumer calls consume(), get() or flush()
+     */
     template<typename T>
+    struct FifoSegments{
+        FifoSpan<T> first;
+        FifoSpan<T> second;
+
+        /**
+         * @brief forward iterator over first and then second
+         * It compares the position and the elements left, when the fifo is full the end of second is the begin of first.
+         */
+        class const_iterator{
+        public:
+            using iterator_category = std::forward_iterator_tag;
+            using value_type = T;
+            using difference_type = std::ptrdiff_t;
+            using pointer = const T*;
+            using reference = const T&;
+
+            const_iterator() : m_p(nullptr), m_pEndFirst(nullptr), m_pSecond(nullptr), m_left(0) {}
+            const_iterator(const T* p, const T* pEndFirst, const T* pSecond, size_t left)
+                : m_p(p), m_pEndFirst(pEndFirst), m_pSecond(pSecond), m_left(left) {}
+            reference operator*() const { return *m_p; }
+            pointer operator->() const { return m_p; }
+            const_iterator& operator++()
+            {
+                if (++m_p == m_pEndFirst)
+                    m_p = m_pSecond;
+                m_left--;
+                return *this;
+            }
+            const_iterator operator++(int)
+            {
+                const_iterator old = *this;
+                ++*this;
+                return old;
+            }
+            bool operator==(const const_iterator& other) const { return m_p == other.m_p && m_left == other.m_left; }
+            bool operator!=(const const_iterator& other) const { return !(*this == other); }
+        private:
+            const T* m_p;
+            const T* m_pEndFirst;
+            const T* m_pSecond;
+            size_t m_left;
+        };
+
+        /**
+         * @brief returns the number of readable elements
+         */
+        size_t size() const
+        {
+            return first.size() + second.size();
+        }
+
+        bool empty() const
+        {
+            return size() == 0;
+        }
+
+        const_iterator begin() const
+        {
+            return const_iterator(first.data(), endOfFirst(), second.empty() ? endOfFirst() : second.data(), size());
+        }
+
+        const_iterator end() const
+        {
+            const T* pEnd = second.empty() ? endOfFirst() : second.data() + second.size();
+            return const_iterator(pEnd, pEnd, pEnd, 0);
+        }
+
+    private:
+        const T* endOfFirst() const
+        {
+            return first.data() + first.size();
+        }
+    };
+
+    /**
+     * @brief fifo with space for N elements stored inside the object
+     * The capacity and the mask are compile time constants and put / get are typed and inline,
+     * so the fifo can be placed on the stack or in static memory without any heap allocation.
+     * One producer and one consumer thread may use the fifo at the same time, the read and the write index are on
+     * separate cache lines so they do not share one.
+     * @note N has to be a power of two, all N elements can be used
+     */
+    template<typename T, size_t N = 0>
     class Fifo{
+        static_assert(N > 0 && (N & (N -1)) == 0, "Fifo<T, N>: N has to be a power of two");
+        static_assert(std::is_trivially_copyable<T>::value, "Fifo<T, N>: T has to be trivially copyable");
+    public:
+        static constexpr size_t capacity = N;
+        static constexpr size_t mask = N -1;
+
+        Fifo() : m_readIdx(0), m_consumerError(FIFO_NO_ERROR), m_writeIdx(0), m_producerError(FIFO_NO_ERROR) {}
+
+        /**
+         * @brief puts one element into the fifo
+         * @retval 0 = success
+         * @retval -1 = fail
+         */
+        int put(const T& data)
+        {
+            size_t write = m_writeIdx;
+            if (write - __atomic_load_n(&m_readIdx, __ATOMIC_ACQUIRE) == N)
+            {
+                m_producerError = FIFO_FULL;
+                return -1;
+            }
+            m_data[write & mask] = data;
+            __atomic_store_n(&m_writeIdx, write +1, __ATOMIC_RELEASE);
+            m_producerError = FIFO_NO_ERROR;
+            return 0;
+        }
+
+        /**
+         * @brief gets one element from the fifo
+         * @note element adress gets passed by reference
+         * @retval 0 = success
+         * @retval -1 = fail
+         */
+        int get(T& data)
+        {
+            size_t read = m_readIdx;
+            if (__atomic_load_n(&m_writeIdx, __ATOMIC_ACQUIRE) == read)
+            {
+                m_consumerError = FIFO_EMPTY;
+                return -1;
+            }
+            data = m_data[read & mask];
+            __atomic_store_n(&m_readIdx, read +1, __ATOMIC_RELEASE);
+            m_consumerError = FIFO_NO_ERROR;
+            return 0;
+        }
+
+        /**
+         * @brief puts up to n elements into the fifo in one operation
+         * @return number of elements put into the fifo
+         */
+        size_t put(const T* data, size_t n)
+        {
+            size_t write = m_writeIdx;
+            size_t space = N - (write - __atomic_load_n(&m_readIdx, __ATOMIC_ACQUIRE));
+            m_producerError = FIFO_NO_ERROR;
+            if (n > space)
+            {
+                n = space;
+                m_producerError = FIFO_FULL;
+            }
+            for (size_t i = 0; i < n; i++)
+            {
+                m_data[(write + i) & mask] = data[i];
+            }
+            __atomic_store_n(&m_writeIdx, write + n, __ATOMIC_RELEASE);
+            return n;
+        }
+
+        /**
+         * @brief gets up to n elements from the fifo in one operation
+         * @return number of elements read from the fifo
+         */
+        size_t get(T* data, size_t n)
+        {
+            size_t read = m_readIdx;
+            size_t level = __atomic_load_n(&m_writeIdx, __ATOMIC_ACQUIRE) - read;
+            m_consumerError = FIFO_NO_ERROR;
+            if (n > level)
+            {
+                n = level;
+                m_consumerError = FIFO_EMPTY;
+            }
+            for (size_t i = 0; i < n; i++)
+            {
+                data[i] = m_data[(read + i) & mask];
+            }
+            __atomic_store_n(&m_readIdx, read + n, __ATOMIC_RELEASE);
+            return n;
+        }
+
+        /**
+         * @brief returns error enum value of the last put of the producer
+         */
+        fifoerror_t getProducerError() const
+        {
+            return m_producerError;
+        }
+
+        /**
+         * @brief returns error enum value of the last get, flush, skipRead, consume or drain of the consumer
+         */
+        fifoerror_t getConsumerError() const
+        {
+            return m_consumerError;
+        }
+
+        /**
+         * @brief gets the error string of the last put of the producer
+         */
+        std::string getProducerErrorStr() const
+        {
+            return fifoErrorStr(m_producerError);
+        }
+
+        /**
+         * @brief gets the error string of the last get, flush, skipRead, consume or drain of the consumer
+         */
+        std::string getConsumerErrorStr() const
+        {
+            return fifoErrorStr(m_consumerError);
+        }
+
+        /**
+         * @brief returns the error of the producer if its last operation failed, otherwise the one of the consumer
+         * @note alias for a fifo used by one thread, the producer and the consumer thread use getProducerError() / getConsumerError()
+         */
+        fifoerror_t getError() const
+        {
+            return (m_producerError != FIFO_NO_ERROR) ? m_producerError : m_consumerError;
+        }
+
+        /**
+         * @brief gets the error string of getError()
+         */
+        std::string getErrorStr() const
+        {
+            return fifoErrorStr(getError());
+        }
+
+        /**
+         * @brief checks if elements are in the fifo
+         */
+        bool hasElementsLeft() const
+        {
+            return getLevel() != 0;
+        }
+
+        /**
+         * @brief checks if space is left in the fifo
+         */
+        bool hasSpaceLeft() const
+        {
+            return getLevel() != N;
+        }
+
+        /**
+         * @brief flushes a fifo
+         * @note only the consumer may flush while the fifo is in use
+         * @retval 0 = success
+         */
+        int flush()
+        {
+            __atomic_store_n(&m_readIdx, __atomic_load_n(&m_writeIdx, __ATOMIC_ACQUIRE), __ATOMIC_RELEASE);
+            m_consumerError = FIFO_NO_ERROR;
+            return 0;
+        }
+
+        /**
+         * @brief returns fill level in elements
+         */
+        size_t getLevel() const
+        {
+            size_t read = __atomic_load_n(&m_readIdx, __ATOMIC_ACQUIRE);     // read first, write can only be bigger
+            return __atomic_load_n(&m_writeIdx, __ATOMIC_ACQUIRE) - read;
+        }
+
+        /**
+         * @brief returns empty space in elements
+         */
+        size_t getEmptySpace() const
+        {
+            return N - getLevel();
+        }
+
+        /**
+         * @brief skips one read cycle
+         * @retval 0 = success
+         * @retval -1 = fail
+         */
+        int skipRead()
+        {
+            return skipRead(1);
+        }
+
+        /**
+         * @brief skips n read cycles, limited to the elements in the fifo like fifo_skip_read_n()
+         * @retval 0 = success
+         * @retval -1 = fail, the fifo is empty
+         */
+        int skipRead(size_t n)
+        {
+            size_t read = m_readIdx;
+            size_t level = __atomic_load_n(&m_writeIdx, __ATOMIC_ACQUIRE) - read;
+            if (level == 0)
+            {
+                m_consumerError = FIFO_EMPTY;
+                return -1;
+            }
+            if (n > level)
+                n = level;
+            __atomic_store_n(&m_readIdx, read + n, __ATOMIC_RELEASE);
+            m_consumerError = FIFO_NO_ERROR;
+            return 0;
+        }
+
+        /**
+         * @brief returns the readable elements in place, they get removed with consume()
+         */
+        FifoSegments<T> getSegments() const
+        {
+            size_t read = m_readIdx;
+            size_t level = __atomic_load_n(&m_writeIdx, __ATOMIC_ACQUIRE) - read;
+            size_t first = N - (read & mask);
+            FifoSegments<T> seg;
+            if (level <= first)
+            {
+                seg.first = FifoSpan<T>(&m_data[read & mask], level);
+            }
+            else
+            {
+                seg.first = FifoSpan<T>(&m_data[read & mask], first);
+                seg.second = FifoSpan<T>(&m_data[0], level - first);
+            }
+            return seg;
+        }
+
+        /**
+         * @brief removes the n oldest elements after they were read in place with getSegments()
+         * @retval 0 = success
+         * @retval -1 = fail, less than n elements in the fifo
+         */
+        int consume(size_t n)
+        {
+            if (getLevel() < n)     // skipRead(n) would remove the elements there are
+            {
+                m_consumerError = FIFO_EMPTY;
+                return -1;
+            }
+            return skipRead(n);
+        }
+
+        /**
+         * @brief calls f(T&) for up to max_elems elements in place and removes them
+         * The write index is read once and the read index is written once for all of them.
+         * @return number of elements drained
+         */
+        template<typename F>
+        size_t drain(F&& f, size_t max_elems = SIZE_MAX)
+        {
+            size_t read = m_readIdx;
+            size_t n = __atomic_load_n(&m_writeIdx, __ATOMIC_ACQUIRE) - read;
+            if (n > max_elems)
+                n = max_elems;
+            for (size_t i = 0; i < n; i++)
+            {
+                f(m_data[(read + i) & mask]);
+            }
+            __atomic_store_n(&m_readIdx, read + n, __ATOMIC_RELEASE);
+            m_consumerError = (n == 0) ? FIFO_EMPTY : FIFO_NO_ERROR;
+            return n;
+        }
+
+        /**
+         * @brief returns size in elements
+         */
+        static constexpr size_t size()
+        {
+            return N;
+        }
+
+    private:
+        T m_data[N];
+        alignas(FIFO_CACHE_LINE_SIZE) size_t m_readIdx;     // free running, written by the consumer, own cache line
+        fifoerror_t m_consumerError;                        // on the cache line of m_readIdx
+        alignas(FIFO_CACHE_LINE_SIZE) size_t m_writeIdx;    // free running, written by the producer, own cache line
+        fifoerror_t m_producerError;                        // on the cache line of m_writeIdx
+    };
+
+    /**
+     * @brief fifo with heap memory for a number of elements chosen at runtime
+     * Trivially copyable elements are copied by the c library. Other types are constructed in place in the
+     * fifo memory (fifo_wide_write_reserve()) and moved out of it (fifo_wide_read_peek()), elements left in
+     * the fifo are destroyed with it.
+     * @note the fifo can be moved but not copied
+     */
+    template<typename T>
+    class Fifo<T, 0>{
+        static_assert(sizeof(T) <= FIFO_MAX_BASETYPE_SIZE, "Fifo<T>: sizeof(T) has to be at most FIFO_MAX_BASETYPE_SIZE");
+        static constexpr bool trivial = std::is_trivially_copyable<T>::value;
     public:
 
         /**
@@ -20,16 +467,81 @@ namespace utils{
          */
         Fifo(size_t size)
         {
-            m_pHandle = fifo_init_malloc(size, sizeof(T));
-            m_error = FIFO_NO_ERROR;
+            m_pHandle = fifo_wide_init_malloc_aligned(size, sizeof(T),
+                                                      alignof(T) > FIFO_CACHE_LINE_SIZE ? alignof(T) : FIFO_CACHE_LINE_SIZE);
+            m_producerError = FIFO_NO_ERROR;
+            m_consumerError = FIFO_NO_ERROR;
+        }
+
+        Fifo(const Fifo&) = delete;
+        Fifo& operator=(const Fifo&) = delete;
+
+        /**
+         * @brief move constructor: takes over the memory and the elements of other, other is left without memory
+         */
+        Fifo(Fifo&& other) noexcept : m_pHandle(other.m_pHandle), m_producerError(other.m_producerError), m_consumerError(other.m_consumerError)
+        {
+            other.m_pHandle = nullptr;
+        }
+
+        /**
+         * @brief move assignment: destroys the own elements and takes over the memory and the elements of other
+         */
+        Fifo& operator=(Fifo&& other) noexcept
+        {
+            if (this != &other)
+            {
+                release();
+                m_pHandle = other.m_pHandle;
+                m_producerError = other.m_producerError;
+                m_consumerError = other.m_consumerError;
+                other.m_pHandle = nullptr;
+            }
+            return *this;
         }
 
         /**
-         * @brief destructor
+         * @brief destructor: destroys the elements left in the fifo
          */
         ~Fifo()
         {
-            fifo_deinit_free(m_pHandle);
+            release();
+        }
+
+        /**
+         * @brief constructs one element in place in the fifo
+         * @retval 0 = success
+         * @retval -1 = fail
+         */
+        template<typename... Args>
+        int emplace(Args&&... args)
+        {
+            void *pSlot;
+            FIFO_WIDE_INDEX_TYPE contiguous;
+            if ((m_producerError = fifo_wide_write_reserve(m_pHandle, 1, &pSlot, &contiguous)) != FIFO_NO_ERROR)
+                return -1;
+            Commit commit{m_pHandle, 0};    // commits nothing if the constructor throws
+            ::new (pSlot) T(std::forward<Args>(args)...);
+            commit.n = 1;
+            return 0;
+        }
+
+        /**
+         * @brief moves the oldest element out of the fifo into data and destroys it in the fifo
+         * @retval 0 = success
+         * @retval -1 = fail
+         */
+        int pop(T& data)
+        {
+            void *pSlot;
+            FIFO_WIDE_INDEX_TYPE contiguous;
+            if ((m_consumerError = fifo_wide_read_peek(m_pHandle, 1, &pSlot, &contiguous)) != FIFO_NO_ERROR)
+                return -1;
+            Release release{m_pHandle, 0};  // keeps the element if the assignment throws
+            data = std::move(*static_cast<T *>(pSlot));
+            static_cast<T *>(pSlot)->~T();
+            release.n = 1;
+            return 0;
         }
 
         /**
@@ -39,10 +551,27 @@ namespace utils{
          */
         int put(const T& data)
         {
-            if ((m_error = fifo_put(m_pHandle, std::addressof(data))) == FIFO_NO_ERROR)
-                return 0;
+            if constexpr (!trivial)
+            {
+                return emplace(data);
+            }
             else
-                return -1;
+            {
+                if ((m_producerError = fifo_wide_put(m_pHandle, std::addressof(data))) == FIFO_NO_ERROR)
+                    return 0;
+                else
+                    return -1;
+            }
+        }
+
+        /**
+         * @brief moves one element into the fifo
+         * @retval 0 = success
+         * @retval -1 = fail
+         */
+        int put(T&& data)
+        {
+            return emplace(std::move(data));
         }
 
         /**
@@ -53,35 +582,106 @@ namespace utils{
          */
         int get(T& data)
         {
-            if ((m_error = fifo_get(m_pHandle, std::addressof(data))) == FIFO_NO_ERROR)
-                return 0;
+            if constexpr (!trivial)
+            {
+                return pop(data);
+            }
             else
-                return -1;
+            {
+                if ((m_consumerError = fifo_wide_get(m_pHandle, std::addressof(data))) == FIFO_NO_ERROR)
+                    return 0;
+                else
+                    return -1;
+            }
         }
 
         /**
-         * @brief returns error enum value of the last operation
+         * @brief puts up to n elements into the fifo in one operation
+         * @note getProducerError() is FIFO_FULL when less than n elements were put
+         * @return number of elements put into the fifo
          */
-        fifoerror_t getError() const
+        size_t put(const T* data, size_t n)
         {
-            return m_error;
+            FIFO_WIDE_INDEX_TYPE written = 0;
+            if constexpr (!trivial)
+            {
+                while (written < n && emplace(data[written]) == 0)
+                    written++;
+            }
+            else
+            {
+                m_producerError = fifo_wide_put_n(m_pHandle, data, n, &written);
+            }
+            return written;
         }
 
         /**
-         * @brief gets the error string of the last operation
+         * @brief gets up to n elements from the fifo in one operation
+         * @note getConsumerError() is FIFO_EMPTY when less than n elements were read
+         * @return number of elements read from the fifo
          */
-        std::string getErrorStr() const
+        size_t get(T* data, size_t n)
         {
-            std::string ret;
-            switch (m_error)
+            FIFO_WIDE_INDEX_TYPE read = 0;
+            if constexpr (!trivial)
+            {
+                while (read < n && pop(data[read]) == 0)
+                    read++;
+            }
+            else
             {
-                case FIFO_NO_ERROR: ret = "No Error"; break;
-                case FIFO_WRONG_PARAM: ret = "Wrong Parameter"; break;
-                case FIFO_BUISY: ret = "Fifo is Buisy"; break;
-                case FIFO_EMPTY: ret = "Fifo is empty"; break;
-                case FIFO_FULL: ret = "Fifo is full"; break;
+                m_consumerError = fifo_wide_get_n(m_pHandle, data, n, &read);
             }
-            return ret;
+            return read;
+        }
+
+        /**
+         * @brief returns error enum value of the last put or emplace of the producer
+         */
+        fifoerror_t getProducerError() const
+        {
+            return m_producerError;
+        }
+
+        /**
+         * @brief returns error enum value of the last get, pop, flush, skipRead, getSegments, consume or drain of the consumer
+         */
+        fifoerror_t getConsumerError() const
+        {
+            return m_consumerError;
+        }
+
+        /**
+         * @brief gets the error string of the last put or emplace of the producer
+         */
+        std::string getProducerErrorStr() const
+        {
+            return fifoErrorStr(m_producerError);
+        }
+
+        /**
+         * @brief gets the error string of the last get, pop, flush, skipRead, getSegments, consume or drain of the consumer
+         */
+        std::string getConsumerErrorStr() const
+        {
+            return fifoErrorStr(m_consumerError);
+        }
+
+        /**
+         * @brief returns the error of the producer if its last operation failed, otherwise the one of the consumer
+         * @note alias for a fifo used by one thread, the producer and the consumer thread use getProducerError() / getConsumerError()
+         */
+        fifoerror_t getError() const
+        {
+            return (m_producerError != FIFO_NO_ERROR) ? m_producerError : m_consumerError;
+        }
+
+        /**
+         * @brief gets the error string of getError()
+         */
+        std::string getErrorStr() const
+        {
+            return fifoErrorStr(getError());
         }
         
         /**
@@ -89,7 +689,7 @@ namespace utils{
          */
         bool hasElementsLeft()
         {
-            return fifo_hasElementsLeft(m_pHandle);
+            return fifo_wide_hasElementsLeft(m_pHandle);
         }
 
         /**
@@ -97,7 +697,7 @@ namespace utils{
          */
         bool hasSpaceLeft()
         {
-            return fifo_hasSpaceLeft(m_pHandle);
+            return fifo_wide_hasSpaceLeft(m_pHandle);
         }
 
         /**
@@ -107,10 +707,17 @@ namespace utils{
          */
         int flush()
         {
-            if ((m_error = fifo_flush(m_pHandle)) == FIFO_NO_ERROR)
-                return 0;
-            else 
-                return -1;
+            if constexpr (!trivial)
+            {
+                return destroy(getLevel());
+            }
+            else
+            {
+                if ((m_consumerError = fifo_wide_flush(m_pHandle)) == FIFO_NO_ERROR)
+                    return 0;
+                else
+                    return -1;
+            }
         }
 
         /**
@@ -118,7 +725,7 @@ namespace utils{
          */
         size_t getLevel()
         {
-            return fifo_getLevel(m_pHandle);
+            return fifo_wide_getLevel(m_pHandle);
         }
 
         /**
@@ -126,7 +733,7 @@ namespace utils{
          */
         size_t getEmptySpace()
         {
-            return fifo_getEmptySpace(m_pHandle);
+            return fifo_wide_getEmptySpace(m_pHandle);
         }
 
         /**
@@ -136,23 +743,108 @@ namespace utils{
          */
         int skipRead()
         {
-            if ((m_error = fifo_skip_read(m_pHandle)) == FIFO_NO_ERROR)
-                return 0;
+            if constexpr (!trivial)
+            {
+                return skipRead(1);
+            }
             else
-                return -1;
+            {
+                if ((m_consumerError = fifo_wide_skip_read(m_pHandle)) == FIFO_NO_ERROR)
+                    return 0;
+                else
+                    return -1;
+            }
         }
 
         /**
-         * @brief skips n read cycles
+         * @brief skips n read cycles, limited to the elements in the fifo like fifo_skip_read_n()
          * @retval 0 = success
          * @retval -1 = fail
          */
         int skipRead(size_t n)
         {
-            if ((m_error = fifo_skip_read_n(m_pHandle, n)) == FIFO_NO_ERROR)
-                return 0;
+            if constexpr (!trivial)
+            {
+                size_t level = getLevel();
+                if (level == 0)
+                {
+                    m_consumerError = (m_pHandle == nullptr) ? FIFO_WRONG_PARAM : FIFO_EMPTY;
+                    return -1;
+                }
+                return destroy((n > level) ? level : n);
+            }
             else
+            {
+                if ((m_consumerError = fifo_wide_skip_read_n(m_pHandle, n)) == FIFO_NO_ERROR)
+                    return 0;
+                else
+                    return -1;
+            }
+        }
+
+        /**
+         * @brief returns the readable elements in place, they get removed with consume()
+         * @note without FIFO_SPSC the fifo is read-locked only while the segments are taken
+         */
+        FifoSegments<T> getSegments()
+        {
+            void *pFirst;
+            FIFO_WIDE_INDEX_TYPE contiguous;
+            FifoSegments<T> seg;
+            size_t level = getLevel();      // only the consumer removes elements, the peek sees at least level
+            if ((m_consumerError = fifo_wide_read_peek(m_pHandle, level, &pFirst, &contiguous)) != FIFO_NO_ERROR)
+                return seg;
+            fifo_wide_read_release(m_pHandle, 0);
+            seg.first = FifoSpan<T>(static_cast<const T *>(pFirst), contiguous);
+
+            // *** The rest wrapped around to the start of the fifo memory ***
+            if (level > contiguous)
+            {
+                seg.second = FifoSpan<T>(static_cast<const T *>(m_pHandle->pFifo), level - contiguous);
+            }
+            return seg;
+        }
+
+        /**
+         * @brief removes the n oldest elements after they were read in place with getSegments()
+         * @retval 0 = success
+         * @retval -1 = fail, less than n elements in the fifo
+         */
+        int consume(size_t n)
+        {
+            if (m_pHandle != nullptr && getLevel() < n)     // skipRead(n) would remove the elements there are
+            {
+                m_consumerError = FIFO_EMPTY;
                 return -1;
+            }
+            return skipRead(n);
+        }
+
+        /**
+         * @brief calls f(T&) for up to max_elems elements in place and removes them
+         * f may move from the element, it gets destroyed afterwards. The elements are taken with
+         * getSegments() and removed with one skipRead(), so the read index is written once for all of them.
+         * @return number of elements drained
+         */
+        template<typename F>
+        size_t drain(F&& f, size_t max_elems = SIZE_MAX)
+        {
+            FifoSegments<T> seg = getSegments();
+            size_t n = (seg.size() < max_elems) ? seg.size() : max_elems;
+            size_t first = (n < seg.first.size()) ? n : seg.first.size();
+            T *pData = const_cast<T *>(seg.first.data());      // the consumer owns the slots until they are removed
+            for (size_t i = 0; i < first; i++)
+            {
+                f(pData[i]);
+            }
+            pData = const_cast<T *>(seg.second.data());
+            for (size_t i = 0; i < n - first; i++)
+            {
+                f(pData[i]);
+            }
+            if (n > 0)
+                skipRead(n);
+            return n;
         }
 
         /**
@@ -160,11 +852,75 @@ namespace utils{
          */
         size_t size() const
         {
+            if (m_pHandle == nullptr)   // moved from or allocation failed
+                return 0;
             return m_pHandle->size / m_pHandle->basetype_size;
         }
 
     private:
-        fifo_handle_t *m_pHandle;
-        fifoerror_t m_error;
+        /**
+         * @brief commits n reserved slots when it goes out of scope
+         */
+        struct Commit{
+            fifo_wide_handle_t *pHandle;
+            FIFO_WIDE_INDEX_TYPE n;
+            ~Commit() { fifo_wide_write_commit(pHandle, n); }
+        };
+
+        /**
+         * @brief releases n peeked elements when it goes out of scope
+         */
+        struct Release{
+            fifo_wide_handle_t *pHandle;
+            FIFO_WIDE_INDEX_TYPE n;
+            ~Release() { fifo_wide_read_release(pHandle, n); }
+        };
+
+        /**
+         * @brief destroys and removes the n oldest elements, n has to be at most the fill level
+         * @retval 0 = success
+         * @retval -1 = fail
+         */
+        int destroy(size_t n)
+        {
+            if (m_pHandle == nullptr)
+            {
+                m_consumerError = FIFO_WRONG_PARAM;
+                return -1;
+            }
+            m_consumerError = FIFO_NO_ERROR;
+            while (n > 0)
+            {
+                void *pSlot;
+                FIFO_WIDE_INDEX_TYPE contiguous;
+                if ((m_consumerError = fifo_wide_read_peek(m_pHandle, n, &pSlot, &contiguous)) != FIFO_NO_ERROR)
+                    return -1;
+                for (FIFO_WIDE_INDEX_TYPE i = 0; i < contiguous; i++)
+                {
+                    static_cast<T *>(pSlot)[i].~T();
+                }
+                fifo_wide_read_release(m_pHandle, contiguous);
+                n -= contiguous;
+            }
+            return 0;
+        }
+
+        /**
+         * @brief destroys the elements left in the fifo and frees its memory
+         */
+        void release()
+        {
+            if (m_pHandle != nullptr)
+            {
+                if constexpr (!trivial)
+                    destroy(getLevel());
+                fifo_wide_deinit_free(m_pHandle);
+                m_pHandle = nullptr;
+            }
+        }
+
+        fifo_wide_handle_t *m_pHandle;
+        fifoerror_t m_producerError;                                    // written by the producer
+        alignas(FIFO_CACHE_LINE_SIZE) fifoerror_t m_consumerError;      // written by the consumer, own cache line
     };
 }
\ No newline at end of file
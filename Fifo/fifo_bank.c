@@ -0,0 +1,226 @@
+// *** INCLUDES ***
+#include "fifo_bank.h"
+#include <string.h> // memcpy, memset
+#ifdef _DEBUG
+    #include <assert.h>
+#endif
+#if FIFO_ALLOW_MALLOC == true
+    #include <stdlib.h> // aligned_alloc
+#endif /* FIFO_ALLOW_MALLOC */
+
+// *** DEFINES ***
+#define _ALIGN_UP(n)    (((n) + FIFO_CACHE_LINE_SIZE -1) / FIFO_CACHE_LINE_SIZE * FIFO_CACHE_LINE_SIZE)
+#define _SLOT(pBank, idx, pos)  ((pBank)->pData + (((idx) * ((pBank)->mask +1)) + ((pos) & (pBank)->mask)) * (pBank)->basetype_size)
+
+/**
+ * @brief returns the memory size needed by fifo_bank_init()
+ * @param count number of fifos
+ * @param capacity capacity of each fifo in elements
+ * @param basetype_size size of the fifo basetype eg: sizeof(uint8_t)
+ * @retval 0 = invalid parameter
+ * @return size in bytes
+ */
+size_t fifo_bank_memSize(size_t count, size_t capacity, SIZE_FIFO_BASE_TYPE basetype_size)
+{
+    if (count == 0 || capacity == 0 || basetype_size == 0 || capacity > FIFO_BANK_MAX_CAPACITY)
+        return 0;
+    if (count > SIZE_MAX / 4 / capacity / basetype_size)
+        return 0;
+    // indices first, the element memory starts on a new cache line
+    return _ALIGN_UP(2 * count * sizeof(FIFO_BANK_INDEX_TYPE)) + count * capacity * basetype_size;
+}
+
+/**
+ * @brief initializes a bank of count empty fifos in the memory pMem
+ * @note If _DEBUG is defined every Parameter will be checked with assert()
+ * @param pBank pointer to the bank handle
+ * @param pMem memory of fifo_bank_memSize() bytes, aligned to FIFO_CACHE_LINE_SIZE for the best performance
+ * @param count number of fifos
+ * @param capacity capacity of each fifo in elements, must be a power of two up to FIFO_BANK_MAX_CAPACITY
+ * @param basetype_size size of the fifo basetype eg: sizeof(uint8_t)
+ * @retval 0 = success
+ * @retval -1 = NULL Pointer as Parameter
+ * @retval -2 = invalid count or capacity
+ * @retval -3 = invalid basetype_size
+ */
+int8_t fifo_bank_init(fifo_bank_t *pBank, void *pMem, size_t count, size_t capacity, SIZE_FIFO_BASE_TYPE basetype_size)
+{
+#ifdef _DEBUG
+    assert(pBank != NULL);
+    assert(pMem != NULL);
+    assert(basetype_size > 0 && basetype_size <= FIFO_MAX_BASETYPE_SIZE);
+#endif
+    // *** Checking Parameters ***
+    if (pBank == NULL || pMem == NULL)
+        return -1;
+    if (basetype_size == 0 || basetype_size > FIFO_MAX_BASETYPE_SIZE)
+        return -3;
+    if ((capacity & (capacity -1)) != 0 || fifo_bank_memSize(count, capacity, basetype_size) == 0)
+        return -2;
+
+    // *** Initialize Handle ***
+    pBank->count = count;
+    pBank->mask = capacity -1;
+    pBank->basetype_size = basetype_size;
+    pBank->pWrite = (FIFO_BANK_INDEX_TYPE *)pMem;
+    pBank->pRead = pBank->pWrite + count;
+    pBank->pData = (uint8_t *)pMem + _ALIGN_UP(2 * count * sizeof(FIFO_BANK_INDEX_TYPE));
+    memset(pMem, 0, 2 * count * sizeof(FIFO_BANK_INDEX_TYPE));
+    return 0;
+}
+
+#if FIFO_ALLOW_MALLOC
+/**
+ * @brief allocates and initializes a bank, the handle and the memory of all fifos are one block
+ * @note memory has to be freed with fifo_bank_deinit_free()
+ * @param count number of fifos
+ * @param capacity capacity of each fifo in elements, must be a power of two up to FIFO_BANK_MAX_CAPACITY
+ * @param basetype_size size of the fifo basetype eg: sizeof(uint8_t)
+ * @retval NULL = failed
+ * @return pointer to the bank handle
+ */
+fifo_bank_t* fifo_bank_init_malloc(size_t count, size_t capacity, SIZE_FIFO_BASE_TYPE basetype_size)
+{
+    size_t size = fifo_bank_memSize(count, capacity, basetype_size);
+    if (size == 0)
+        return NULL;
+
+    // *** Allocate Handle and Memory in one block ***
+    size_t offset = _ALIGN_UP(sizeof(fifo_bank_t));
+    fifo_bank_t *pBank = (fifo_bank_t *)aligned_alloc(FIFO_CACHE_LINE_SIZE, _ALIGN_UP(offset + size));
+    if (pBank != NULL && fifo_bank_init(pBank, (uint8_t *)pBank + offset, count, capacity, basetype_size) != 0)
+    {
+        free(pBank);
+        pBank = NULL;
+    }
+    return pBank;
+}
+
+/**
+ * @brief deallocates a bank from fifo_bank_init_malloc()
+ * @param pBank pointer to the bank handle
+ */
+void fifo_bank_deinit_free(fifo_bank_t *pBank)
+{
+    free(pBank);
+}
+#endif  /* FIFO_ALLOW_MALLOC */
+
+/**
+ * @brief puts an element into fifo idx of the bank
+ * @param pBank pointer to the bank handle
+ * @param idx number of the fifo
+ * @param [in] pData pointer to the data to be put onto the fifo
+ * @return fifoerror_t
+ */
+fifoerror_t fifo_bank_put(fifo_bank_t *pBank, size_t idx, const void *pData)
+{
+#ifdef _DEBUG
+    assert(pBank != NULL);
+    assert(idx < pBank->count);
+    assert(pData != NULL);
+#endif
+    // *** Checking Parameters ***
+    if (pBank == NULL || idx >= pBank->count || pData == NULL)
+        return FIFO_WRONG_PARAM;
+
+    FIFO_BANK_INDEX_TYPE write = pBank->pWrite[idx];
+    if ((FIFO_BANK_INDEX_TYPE)(write - pBank->pRead[idx]) > pBank->mask)     // No space
+        return FIFO_FULL;
+    memcpy(_SLOT(pBank, idx, write), pData, pBank->basetype_size);
+    pBank->pWrite[idx] = write +1;
+    return FIFO_NO_ERROR;
+}
+
+/**
+ * @brief gets an element from fifo idx of the bank
+ * @param pBank pointer to the bank handle
+ * @param idx number of the fifo
+ * @param [out] pData pointer to the storage for the data from the fifo
+ * @return fifoerror_t
+ */
+fifoerror_t fifo_bank_get(fifo_bank_t *pBank, size_t idx, void *pData)
+{
+#ifdef _DEBUG
+    assert(pBank != NULL);
+    assert(idx < pBank->count);
+    assert(pData != NULL);
+#endif
+    // *** Checking Parameters ***
+    if (pBank == NULL || idx >= pBank->count || pData == NULL)
+        return FIFO_WRONG_PARAM;
+
+    FIFO_BANK_INDEX_TYPE read = pBank->pRead[idx];
+    if (pBank->pWrite[idx] == read)     // no data in fifo
+        return FIFO_EMPTY;
+    memcpy(pData, _SLOT(pBank, idx, read), pBank->basetype_size);
+    pBank->pRead[idx] = read +1;
+    return FIFO_NO_ERROR;
+}
+
+/**
+ * @brief returns the fill level of fifo idx of the bank
+ * @param pBank pointer to the bank handle
+ * @param idx number of the fifo
+ * @retval fill level of the fifo in elements
+ */
+size_t fifo_bank_getLevel(const fifo_bank_t *pBank, size_t idx)
+{
+#ifdef _DEBUG
+    assert(pBank != NULL);
+    assert(idx < pBank->count);
+#endif
+    if (pBank == NULL || idx >= pBank->count)
+    {
+        return 0;
+    }
+    return (FIFO_BANK_INDEX_TYPE)(pBank->pWrite[idx] - pBank->pRead[idx]);
+}
+
+/**
+ * @brief flushes fifo idx of the bank
+ * @param pBank pointer to the bank handle
+ * @param idx number of the fifo
+ * @return fifoerror_t
+ */
+fifoerror_t fifo_bank_flush(fifo_bank_t *pBank, size_t idx)
+{
+#ifdef _DEBUG
+    assert(pBank != NULL);
+    assert(idx < pBank->count);
+#endif
+    if (pBank == NULL || idx >= pBank->count)
+    {
+        return FIFO_WRONG_PARAM;
+    }
+    pBank->pRead[idx] = pBank->pWrite[idx];
+    return FIFO_NO_ERROR;
+}
+
+/**
+ * @brief finds the first fifo with elements, starting at fifo start
+ * @param pBank pointer to the bank handle
+ * @param start number of the first fifo to look at
+ * @retval pBank->count = all fifos from start on are empty
+ * @retval SIZE_MAX = NULL Pointer as Parameter, ends a loop like i < pBank->count as well
+ * @return number of the fifo
+ */
+size_t fifo_bank_nextNonEmpty(const fifo_bank_t *pBank, size_t start)
+{
+#ifdef _DEBUG
+    assert(pBank != NULL);
+#endif
+    if (pBank == NULL)
+    {
+        return SIZE_MAX;
+    }
+    const FIFO_BANK_INDEX_TYPE *pWrite = pBank->pWrite, *pRead = pBank->pRead;
+    for (size_t i = start; i < pBank->count; i++)     // two dense arrays, one compare per fifo
+    {
+        if (pWrite[i] != pRead[i])
+        {
+            return i;
+        }
+    }
+    return pBank->count;
+}
@@ -0,0 +1,144 @@
+/**
+ * @file fifo_bank.h
+ * @brief a bank of many small fifos of the same shape in one contiguous block of memory
+ * All fifos of a bank have the same capacity and basetype. Their read and write indices are kept in two dense
+ * arrays, so the overhead per fifo is 2 * sizeof(FIFO_BANK_INDEX_TYPE) bytes and a sweep over all fifos, eg: with
+ * fifo_bank_nextNonEmpty(), is a linear scan of these arrays.
+ * The element memory of fifo i is at pData + i * capacity * basetype_size.
+ * @note the capacity has to be a power of two, all of the slots can be used
+ * @note the functions have no lock, a bank is meant to be used by one thread
+ * @author Josef Aschwanden
+ * @date Oct - 2026
+ * @version 1.0
+ */
+
+#ifndef _FIFO_BANK_H_
+#define _FIFO_BANK_H_
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// *** INCLUDES ***
+#include <stddef.h>
+#include "fifo.h"
+
+// *** DEFINES ***
+/**
+ * @brief type of the free running indices of a bank fifo, the capacity is limited to half its range
+ */
+#ifndef FIFO_BANK_INDEX_TYPE
+#define FIFO_BANK_INDEX_TYPE    uint16_t
+#endif
+
+/**
+ * @brief maximum capacity of a bank fifo in elements
+ */
+#define FIFO_BANK_MAX_CAPACITY  (((size_t)(FIFO_BANK_INDEX_TYPE)-1 >> 1) +1)
+
+// *** TYPEDEF ***
+/**
+ * @brief this structure is used as handle for a fifo bank
+ */
+typedef struct{
+    size_t count;                           /*!< number of fifos */
+    size_t mask;                            /*!< capacity of each fifo in elements -1 */
+    SIZE_FIFO_BASE_TYPE basetype_size;      /*!< sizeof the fifo basetype (bytes) */
+    FIFO_BANK_INDEX_TYPE *pWrite;           /*!< write index of every fifo, free running */
+    FIFO_BANK_INDEX_TYPE *pRead;            /*!< read index of every fifo, free running */
+    uint8_t *pData;                         /*!< element memory of all fifos */
+}fifo_bank_t;
+
+/**
+ * @brief returns the memory size needed by fifo_bank_init()
+ * @param count number of fifos
+ * @param capacity capacity of each fifo in elements
+ * @param basetype_size size of the fifo basetype eg: sizeof(uint8_t)
+ * @retval 0 = invalid parameter
+ * @return size in bytes
+ */
+size_t fifo_bank_memSize(size_t count, size_t capacity, SIZE_FIFO_BASE_TYPE basetype_size);
+
+/**
+ * @brief initializes a bank of count empty fifos in the memory pMem
+ * @note If _DEBUG is defined every Parameter will be checked with assert()
+ * @param pBank pointer to the bank handle
+ * @param pMem memory of fifo_bank_memSize() bytes, aligned to FIFO_CACHE_LINE_SIZE for the best performance
+ * @param count number of fifos
+ * @param capacity capacity of each fifo in elements, must be a power of two up to FIFO_BANK_MAX_CAPACITY
+ * @param basetype_size size of the fifo basetype eg: sizeof(uint8_t)
+ * @retval 0 = success
+ * @retval -1 = NULL Pointer as Parameter
+ * @retval -2 = invalid count or capacity
+ * @retval -3 = invalid basetype_size
+ */
+int8_t fifo_bank_init(fifo_bank_t *pBank, void *pMem, size_t count, size_t capacity, SIZE_FIFO_BASE_TYPE basetype_size);
+
+#if FIFO_ALLOW_MALLOC
+/**
+ * @brief allocates and initializes a bank, the handle and the memory of all fifos are one block
+ * @note memory has to be freed with fifo_bank_deinit_free()
+ * @param count number of fifos
+ * @param capacity capacity of each fifo in elements, must be a power of two up to FIFO_BANK_MAX_CAPACITY
+ * @param basetype_size size of the fifo basetype eg: sizeof(uint8_t)
+ * @retval NULL = failed
+ * @return pointer to the bank handle
+ */
+fifo_bank_t* fifo_bank_init_malloc(size_t count, size_t capacity, SIZE_FIFO_BASE_TYPE basetype_size);
+
+/**
+ * @brief deallocates a bank from fifo_bank_init_malloc()
+ * @param pBank pointer to the bank handle
+ */
+void fifo_bank_deinit_free(fifo_bank_t *pBank);
+#endif  /* FIFO_ALLOW_MALLOC */
+
+/**
+ * @brief puts an element into fifo idx of the bank
+ * @param pBank pointer to the bank handle
+ * @param idx number of the fifo
+ * @param [in] pData pointer to the data to be put onto the fifo
+ * @return fifoerror_t
+ */
+fifoerror_t fifo_bank_put(fifo_bank_t *pBank, size_t idx, const void *pData);
+
+/**
+ * @brief gets an element from fifo idx of the bank
+ * @param pBank pointer to the bank handle
+ * @param idx number of the fifo
+ * @param [out] pData pointer to the storage for the data from the fifo
+ * @return fifoerror_t
+ */
+fifoerror_t fifo_bank_get(fifo_bank_t *pBank, size_t idx, void *pData);
+
+/**
+ * @brief returns the fill level of fifo idx of the bank
+ * @param pBank pointer to the bank handle
+ * @param idx number of the fifo
+ * @retval fill level of the fifo in elements
+ */
+size_t fifo_bank_getLevel(const fifo_bank_t *pBank, size_t idx);
+
+/**
+ * @brief flushes fifo idx of the bank
+ * @param pBank pointer to the bank handle
+ * @param idx number of the fifo
+ * @return fifoerror_t
+ */
+fifoerror_t fifo_bank_flush(fifo_bank_t *pBank, size_t idx);
+
+/**
+ * @brief finds the first fifo with elements, starting at fifo start
+ * @param pBank pointer to the bank handle
+ * @param start number of the first fifo to look at
+ * @retval pBank->count = all fifos from start on are empty
+ * @retval SIZE_MAX = NULL Pointer as Parameter, ends a loop like i < pBank->count as well
+ * @return number of the fifo
+ */
+size_t fifo_bank_nextNonEmpty(const fifo_bank_t *pBank, size_t start);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif  // _FIFO_BANK_H_
@@ -0,0 +1,87 @@
+/**
+ * @file fifo_bench.cpp
+ * @brief this Programm measures the throughput of the Executor with 1 .. N workers
+ * Every run submits short tasks in batches and waits for all of them, the speedup is relative to one worker.
+ * Usage: ./bench_executor [max workers, default one per core] [tasks per run, default 200000]
+ * @author Josef Aschwanden
+ * @date Oct - 2026
+ * @version 1.0
+ */
+
+// *** INCLUDES ***
+#include "fifo_executor.hpp"
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <functional>
+#include <thread>
+#include <vector>
+
+// *** DEFINES ***
+#define BATCH_SIZE  256     // tasks per submit_batch() call
+#define TASK_LOOPS  200     // work of one task, about a microsecond
+
+/**
+ * @brief short task, the result is returned so the loop is not optimized away
+ */
+static uint32_t shortTask(uint32_t seed)
+{
+	for (uint32_t i = 0; i < TASK_LOOPS; i++)
+	{
+		seed = seed * 1664525u + 1013904223u;
+	}
+	return seed;
+}
+
+/**
+ * @brief runs tasks short tasks on an Executor with workers threads
+ * @retval tasks per second
+ */
+static double run(size_t workers, size_t tasks)
+{
+	utils::Executor executor(workers, 1024);
+	std::vector<std::function<uint32_t()>> batch;
+	for (uint32_t i = 0; i < BATCH_SIZE; i++)
+	{
+		batch.push_back([i]{ return shortTask(i); });
+	}
+
+	uint32_t sum = 0;
+	auto start = std::chrono::steady_clock::now();
+	for (size_t done = 0; done < tasks; done += BATCH_SIZE)
+	{
+		auto futures = executor.submit_batch(batch.begin(), batch.end());
+		for (auto& future : futures)
+		{
+			sum += future.get();
+		}
+	}
+	std::chrono::duration<double> seconds = std::chrono::steady_clock::now() - start;
+	if (sum == 1)	// keeps sum alive
+		printf(" ");
+	return tasks / seconds.count();
+}
+
+int main(int argc, char **argv)
+{
+	size_t maxWorkers = std::thread::hardware_concurrency();
+	size_t tasks = 200000;
+	if (argc > 1)
+		maxWorkers = strtoul(argv[1], NULL, 10);
+	if (argc > 2)
+		tasks = strtoul(argv[2], NULL, 10);
+	if (maxWorkers == 0)
+		maxWorkers = 1;
+
+	printf("workers  tasks/s     speedup\n");
+	double base = 0;
+	for (size_t workers = 1; workers <= maxWorkers; workers++)
+	{
+		double rate = run(workers, tasks);
+		if (workers == 1)
+			base = rate;
+		printf("%7zu  %10.0f  %7.2f\n", workers, rate, rate / base);
+	}
+	return 0;
+}
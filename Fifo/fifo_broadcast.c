@@ -0,0 +1,305 @@
+// *** INCLUDES ***
+#include "fifo_broadcast.h"
+#include <string.h> // memcpy
+#ifdef _DEBUG
+    #include <assert.h>
+#endif
+#if FIFO_ALLOW_MALLOC == true
+    #include <stdlib.h> // malloc, free
+#endif /* FIFO_ALLOW_MALLOC */
+
+// *** DEFINES ***
+#define _SLOT(pRing, pos)   ((uint8_t *)(pRing)->pFifo + ((pos) & (pRing)->mask) * (pRing)->basetype_size)
+
+// *** STATIC FUNCTIONS ***
+/**
+ * @brief returns the position a consumer may read up to: the producer, or the slowest consumer it depends on
+ * @note positions are free running, the one with the smallest distance from pos is the smallest
+ */
+static size_t _limitOf(fifo_broadcast_t *pRing, size_t consumer, size_t pos)
+{
+    size_t limit = __atomic_load_n(&pRing->write_pos, __ATOMIC_ACQUIRE);
+    for (uint32_t depends = pRing->cursor[consumer].depends; depends != 0; depends &= depends -1)
+    {
+        size_t dep_pos = __atomic_load_n(&pRing->cursor[__builtin_ctz(depends)].pos, __ATOMIC_ACQUIRE);
+        if (dep_pos - pos < limit - pos)
+        {
+            limit = dep_pos;
+        }
+    }
+    return limit;
+}
+
+/**
+ * @brief returns the number of elements a consumer may read, the copy in limit is refreshed when it shows none
+ */
+static size_t _available(fifo_broadcast_t *pRing, size_t consumer, size_t pos)
+{
+    fifo_broadcast_cursor_t *pCursor = &pRing->cursor[consumer];
+    if (pCursor->limit == pos)
+    {
+        pCursor->limit = _limitOf(pRing, consumer, pos);
+    }
+    return pCursor->limit - pos;
+}
+
+/**
+ * @brief initializes a broadcast ring without consumers
+ * @note If _DEBUG is defined every Parameter will be checked with assert()
+ * @param pRing pointer to the ring handle
+ * @param pBuffer pointer to the element memory
+ * @param size_fifo size of pBuffer in elements, must be a power of two
+ * @param basetype_size size of the fifo basetype eg: sizeof(uint8_t)
+ * @retval 0 = success
+ * @retval -1 = NULL Pointer as Parameter
+ * @retval -2 = invalid fifo size
+ * @retval -3 = invalid basetype_size
+ */
+int8_t fifo_broadcast_init(fifo_broadcast_t *pRing, void *pBuffer, size_t size_fifo, SIZE_FIFO_BASE_TYPE basetype_size)
+{
+#ifdef _DEBUG
+    assert(pRing != NULL);
+    assert(pBuffer != NULL);
+    assert(basetype_size > 0 && basetype_size <= FIFO_MAX_BASETYPE_SIZE);
+#endif
+    // *** Checking Parameters ***
+    if (pRing == NULL || pBuffer == NULL)
+        return -1;
+    if (basetype_size == 0 || basetype_size > FIFO_MAX_BASETYPE_SIZE)
+        return -3;
+    if (size_fifo == 0 || (size_fifo & (size_fifo -1)) != 0)
+        return -2;
+
+    // *** Initialize Handle ***
+    pRing->basetype_size = basetype_size;
+    pRing->mask = size_fifo - 1;
+    pRing->pFifo = pBuffer;
+    pRing->consumers = 0;
+    pRing->write_pos = 0;
+    pRing->gating_cache = 0;
+    return 0;
+}
+
+#if FIFO_ALLOW_MALLOC
+/**
+ * @brief allocates a broadcast ring and its element memory, and initializes it
+ * @note memory has to be freed with fifo_broadcast_deinit_free()
+ * @param size_fifo size of the ring in elements, must be a power of two
+ * @param basetype_size size of the fifo basetype eg: sizeof(uint8_t)
+ * @retval NULL = failed
+ * @return pointer to the ring handle
+ */
+fifo_broadcast_t* fifo_broadcast_init_malloc(size_t size_fifo, SIZE_FIFO_BASE_TYPE basetype_size)
+{
+    // *** Checking Parameters ***
+    if (basetype_size == 0 || basetype_size > FIFO_MAX_BASETYPE_SIZE)
+        return NULL;
+    if (size_fifo > SIZE_MAX / basetype_size)
+        return NULL;
+
+    // *** Allocate Handle ***
+    fifo_broadcast_t *pRing = (fifo_broadcast_t *)malloc(sizeof(*pRing));
+
+    if (pRing != NULL)
+    {
+        // *** Allocate Buffer ***
+        void *pBuffer = malloc(size_fifo * basetype_size);
+        if (pBuffer == NULL || fifo_broadcast_init(pRing, pBuffer, size_fifo, basetype_size) != 0)
+        {
+            free(pBuffer);
+            free(pRing);     // therefore free previously allocated memory
+            pRing = NULL;
+        }
+    }
+    return pRing;
+}
+
+/**
+ * @brief deallocates a broadcast ring and its element memory
+ * @param pRing pointer to the ring handle
+ */
+void fifo_broadcast_deinit_free(fifo_broadcast_t *pRing)
+{
+    if (pRing != NULL)
+    {
+        free(pRing->pFifo);
+        free(pRing);
+    }
+}
+#endif  /* FIFO_ALLOW_MALLOC */
+
+/**
+ * @brief adds a consumer, it gets the elements put from now on, or the ones its dependencies have not released yet
+ * @param pRing pointer to the ring handle
+ * @param depends mask of the consumers (bit i = consumer i) that have to release an element first, 0 = none
+ * @retval -1 = too many consumers or depends has a consumer that was not added yet
+ * @return number of the consumer
+ */
+int8_t fifo_broadcast_addConsumer(fifo_broadcast_t *pRing, uint32_t depends)
+{
+#ifdef _DEBUG
+    assert(pRing != NULL);
+#endif
+    // *** Checking Parameters, only consumers added before can be dependencies, so there are no cycles ***
+    if (pRing == NULL || pRing->consumers == FIFO_BROADCAST_MAX_CONSUMERS)
+        return -1;
+    size_t consumer = pRing->consumers;
+    if ((depends >> consumer) != 0)
+        return -1;
+
+    // *** Start at the producer, or behind it at the slowest dependency ***
+    fifo_broadcast_cursor_t *pCursor = &pRing->cursor[consumer];
+    pCursor->depends = depends;
+    pCursor->pos = pRing->write_pos;
+    for (; depends != 0; depends &= depends -1)
+    {
+        size_t dep_pos = pRing->cursor[__builtin_ctz(depends)].pos;
+        if (pRing->write_pos - dep_pos > pRing->write_pos - pCursor->pos)
+        {
+            pCursor->pos = dep_pos;
+        }
+    }
+    pCursor->limit = pCursor->pos;
+    __atomic_store_n(&pRing->consumers, consumer + 1, __ATOMIC_RELEASE);
+    return (int8_t)consumer;
+}
+
+/**
+ * @brief puts an element into the ring, only called by the producer
+ * @param pRing pointer to the ring handle
+ * @param [in] pData pointer to the data to be put onto the ring
+ * @retval FIFO_FULL        the slowest consumer has not released the oldest element yet
+ * @return fifoerror_t
+ */
+fifoerror_t fifo_broadcast_put(fifo_broadcast_t *pRing, const void *pData)
+{
+#ifdef _DEBUG
+    assert(pRing != NULL);
+    assert(pData != NULL);
+#endif
+    // *** Checking Parameters ***
+    if (pRing == NULL || pData == NULL)
+        return FIFO_WRONG_PARAM;
+
+    size_t write_pos = pRing->write_pos;
+    if (write_pos - pRing->gating_cache > pRing->mask)
+    {
+        // *** Looks full with the copy, find the slowest consumer ***
+        size_t gating = write_pos;
+        size_t consumers = __atomic_load_n(&pRing->consumers, __ATOMIC_ACQUIRE);
+        for (size_t i = 0; i < consumers; i++)
+        {
+            size_t pos = __atomic_load_n(&pRing->cursor[i].pos, __ATOMIC_ACQUIRE);
+            if (write_pos - pos > write_pos - gating)
+            {
+                gating = pos;
+            }
+        }
+        pRing->gating_cache = gating;
+        if (write_pos - gating > pRing->mask)
+            return FIFO_FULL;
+    }
+
+    // *** Write the element, then publish it ***
+    memcpy(_SLOT(pRing, write_pos), pData, pRing->basetype_size);
+    __atomic_store_n(&pRing->write_pos, write_pos + 1, __ATOMIC_RELEASE);
+    return FIFO_NO_ERROR;
+}
+
+/**
+ * @brief gets the next element of a consumer, the element stays in the ring for the other consumers
+ * @param pRing pointer to the ring handle
+ * @param consumer number of the consumer
+ * @param [out] pData pointer to the storage for the data from the ring
+ * @return fifoerror_t
+ */
+fifoerror_t fifo_broadcast_get(fifo_broadcast_t *pRing, size_t consumer, void *pData)
+{
+#ifdef _DEBUG
+    assert(pRing != NULL);
+    assert(consumer < pRing->consumers);
+    assert(pData != NULL);
+#endif
+    // *** Checking Parameters ***
+    if (pRing == NULL || consumer >= pRing->consumers || pData == NULL)
+        return FIFO_WRONG_PARAM;
+
+    size_t pos = pRing->cursor[consumer].pos;
+    if (_available(pRing, consumer, pos) == 0)
+        return FIFO_EMPTY;
+    memcpy(pData, _SLOT(pRing, pos), pRing->basetype_size);
+    __atomic_store_n(&pRing->cursor[consumer].pos, pos + 1, __ATOMIC_RELEASE);
+    return FIFO_NO_ERROR;
+}
+
+/**
+ * @brief returns the elements a consumer may read in place, up to the end of the element memory
+ * @param pRing pointer to the ring handle
+ * @param consumer number of the consumer
+ * @param [out] ppData pointer to the oldest element of the consumer
+ * @param [out] pAvailable number of elements at *ppData
+ * @return fifoerror_t
+ */
+fifoerror_t fifo_broadcast_peek(fifo_broadcast_t *pRing, size_t consumer, void **ppData, size_t *pAvailable)
+{
+#ifdef _DEBUG
+    assert(pRing != NULL);
+    assert(consumer < pRing->consumers);
+    assert(ppData != NULL);
+    assert(pAvailable != NULL);
+#endif
+    // *** Checking Parameters ***
+    if (pRing == NULL || consumer >= pRing->consumers || ppData == NULL || pAvailable == NULL)
+        return FIFO_WRONG_PARAM;
+
+    size_t pos = pRing->cursor[consumer].pos;
+    size_t available = _available(pRing, consumer, pos);
+    size_t contiguous = pRing->mask + 1 - (pos & pRing->mask);
+    *ppData = _SLOT(pRing, pos);
+    *pAvailable = (available > contiguous) ? contiguous : available;
+    return (available == 0) ? FIFO_EMPTY : FIFO_NO_ERROR;
+}
+
+/**
+ * @brief releases n elements of a consumer after it read them with fifo_broadcast_peek()
+ * @param pRing pointer to the ring handle
+ * @param consumer number of the consumer
+ * @param n number of elements, at most *pAvailable of the last fifo_broadcast_peek()
+ * @return fifoerror_t
+ */
+fifoerror_t fifo_broadcast_release(fifo_broadcast_t *pRing, size_t consumer, size_t n)
+{
+#ifdef _DEBUG
+    assert(pRing != NULL);
+    assert(consumer < pRing->consumers);
+#endif
+    // *** Checking Parameters ***
+    if (pRing == NULL || consumer >= pRing->consumers)
+        return FIFO_WRONG_PARAM;
+
+    size_t pos = pRing->cursor[consumer].pos;
+    if (n > pRing->cursor[consumer].limit - pos)     // more than peeked
+        return FIFO_WRONG_PARAM;
+    __atomic_store_n(&pRing->cursor[consumer].pos, pos + n, __ATOMIC_RELEASE);
+    return FIFO_NO_ERROR;
+}
+
+/**
+ * @brief returns the number of elements a consumer has not read yet
+ * @param pRing pointer to the ring handle
+ * @param consumer number of the consumer
+ * @retval fill level in elements
+ */
+size_t fifo_broadcast_getLevel(fifo_broadcast_t *pRing, size_t consumer)
+{
+#ifdef _DEBUG
+    assert(pRing != NULL);
+    assert(consumer < pRing->consumers);
+#endif
+    if (pRing == NULL || consumer >= pRing->consumers)
+    {
+        return 0;
+    }
+    size_t pos = __atomic_load_n(&pRing->cursor[consumer].pos, __ATOMIC_ACQUIRE);
+    return __atomic_load_n(&pRing->write_pos, __ATOMIC_ACQUIRE) - pos;
+}
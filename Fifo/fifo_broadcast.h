@@ -0,0 +1,149 @@
+/**
+ * @file fifo_broadcast.h
+ * @brief single producer / multi consumer broadcast ring, every consumer gets every element (disruptor style)
+ * The producer writes every element once. Each consumer has its own read cursor and reads the elements in place,
+ * the producer only has to wait for the slowest consumer. A consumer can depend on other consumers, it then only
+ * gets an element after all of them have released it, so pipelined stages share one buffer without copies.
+ * The producer keeps a copy of the smallest consumer cursor and every consumer a copy of the position it may read
+ * up to, so the cursors of the other threads are only loaded when the copy shows a full / empty ring.
+ * @note the capacity has to be a power of two, all of the slots can be used
+ * @note consumers have to be added while the producer does not put
+ * @author Josef Aschwanden
+ * @date Oct - 2026
+ * @version 1.0
+ */
+
+#ifndef _FIFO_BROADCAST_H_
+#define _FIFO_BROADCAST_H_
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// *** INCLUDES ***
+#include <stddef.h>
+#include "fifo.h"
+
+// *** DEFINES ***
+/**
+ * @brief maximum number of consumers of a broadcast ring, one bit of a dependency mask per consumer
+ */
+#define FIFO_BROADCAST_MAX_CONSUMERS    16
+
+// *** TYPEDEF ***
+/**
+ * @brief read cursor of one consumer, on its own cache line
+ */
+typedef struct{
+    size_t pos;                             /*!< next element to be read, free running */
+    size_t limit;                           /*!< copy of the position the consumer may read up to, only used by the consumer */
+    uint32_t depends;                       /*!< consumers that have to release an element before this one gets it */
+    uint8_t _pad[FIFO_CACHE_LINE_SIZE - 2 * sizeof(size_t) - sizeof(uint32_t)];
+}fifo_broadcast_cursor_t;
+
+/**
+ * @brief this structure is used as handle for the broadcast ring
+ */
+typedef struct{
+    SIZE_FIFO_BASE_TYPE basetype_size;      /*!< sizeof the fifo basetype (bytes) */
+    size_t mask;                            /*!< capacity in elements -1 */
+    void *pFifo;                            /*!< pointer to the element memory */
+    size_t consumers;                       /*!< number of consumers */
+    uint8_t _pad0[FIFO_CACHE_LINE_SIZE];
+    size_t write_pos;                       /*!< next element to be written, free running */
+    size_t gating_cache;                    /*!< copy of the smallest consumer cursor, only used by the producer */
+    uint8_t _pad1[FIFO_CACHE_LINE_SIZE - 2 * sizeof(size_t)];
+    fifo_broadcast_cursor_t cursor[FIFO_BROADCAST_MAX_CONSUMERS];  /*!< read cursors of the consumers */
+}fifo_broadcast_t;
+
+/**
+ * @brief initializes a broadcast ring without consumers
+ * @note If _DEBUG is defined every Parameter will be checked with assert()
+ * @param pRing pointer to the ring handle
+ * @param pBuffer pointer to the element memory
+ * @param size_fifo size of pBuffer in elements, must be a power of two
+ * @param basetype_size size of the fifo basetype eg: sizeof(uint8_t)
+ * @retval 0 = success
+ * @retval -1 = NULL Pointer as Parameter
+ * @retval -2 = invalid fifo size
+ * @retval -3 = invalid basetype_size
+ */
+int8_t fifo_broadcast_init(fifo_broadcast_t *pRing, void *pBuffer, size_t size_fifo, SIZE_FIFO_BASE_TYPE basetype_size);
+
+#if FIFO_ALLOW_MALLOC
+/**
+ * @brief allocates a broadcast ring and its element memory, and initializes it
+ * @note memory has to be freed with fifo_broadcast_deinit_free()
+ * @param size_fifo size of the ring in elements, must be a power of two
+ * @param basetype_size size of the fifo basetype eg: sizeof(uint8_t)
+ * @retval NULL = failed
+ * @return pointer to the ring handle
+ */
+fifo_broadcast_t* fifo_broadcast_init_malloc(size_t size_fifo, SIZE_FIFO_BASE_TYPE basetype_size);
+
+/**
+ * @brief deallocates a broadcast ring and its element memory
+ * @param pRing pointer to the ring handle
+ */
+void fifo_broadcast_deinit_free(fifo_broadcast_t *pRing);
+#endif  /* FIFO_ALLOW_MALLOC */
+
+/**
+ * @brief adds a consumer, it gets the elements put from now on, or the ones its dependencies have not released yet
+ * @param pRing pointer to the ring handle
+ * @param depends mask of the consumers (bit i = consumer i) that have to release an element first, 0 = none
+ * @retval -1 = too many consumers or depends has a consumer that was not added yet
+ * @return number of the consumer
+ */
+int8_t fifo_broadcast_addConsumer(fifo_broadcast_t *pRing, uint32_t depends);
+
+/**
+ * @brief puts an element into the ring, only called by the producer
+ * @param pRing pointer to the ring handle
+ * @param [in] pData pointer to the data to be put onto the ring
+ * @retval FIFO_FULL        the slowest consumer has not released the oldest element yet
+ * @return fifoerror_t
+ */
+fifoerror_t fifo_broadcast_put(fifo_broadcast_t *pRing, const void *pData);
+
+/**
+ * @brief gets the next element of a consumer, the element stays in the ring for the other consumers
+ * @param pRing pointer to the ring handle
+ * @param consumer number of the consumer
+ * @param [out] pData pointer to the storage for the data from the ring
+ * @return fifoerror_t
+ */
+fifoerror_t fifo_broadcast_get(fifo_broadcast_t *pRing, size_t consumer, void *pData);
+
+/**
+ * @brief returns the elements a consumer may read in place, up to the end of the element memory
+ * @param pRing pointer to the ring handle
+ * @param consumer number of the consumer
+ * @param [out] ppData pointer to the oldest element of the consumer
+ * @param [out] pAvailable number of elements at *ppData
+ * @return fifoerror_t
+ */
+fifoerror_t fifo_broadcast_peek(fifo_broadcast_t *pRing, size_t consumer, void **ppData, size_t *pAvailable);
+
+/**
+ * @brief releases n elements of a consumer after it read them with fifo_broadcast_peek()
+ * @param pRing pointer to the ring handle
+ * @param consumer number of the consumer
+ * @param n number of elements, at most *pAvailable of the last fifo_broadcast_peek()
+ * @return fifoerror_t
+ */
+fifoerror_t fifo_broadcast_release(fifo_broadcast_t *pRing, size_t consumer, size_t n);
+
+/**
+ * @brief returns the number of elements a consumer has not read yet
+ * @param pRing pointer to the ring handle
+ * @param consumer number of the consumer
+ * @retval fill level in elements
+ */
+size_t fifo_broadcast_getLevel(fifo_broadcast_t *pRing, size_t consumer);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif  // _FIFO_BROADCAST_H_
@@ -0,0 +1,277 @@
+// *** INCLUDES ***
+#include "fifo_deque.h"
+#include <string.h> // memcpy
+#ifdef _DEBUG
+    #include <assert.h>
+#endif
+#if FIFO_ALLOW_MALLOC == true
+    #include <stdlib.h> // malloc, free
+#endif /* FIFO_ALLOW_MALLOC */
+
+// *** DEFINES ***
+#define _SLOT(pDeque, pArray, idx)  ((pArray)->pData + ((size_t)(idx) & (pArray)->mask) * (pDeque)->basetype_size)
+
+// *** STATIC FUNCTIONS ***
+#if FIFO_ALLOW_MALLOC
+/**
+ * @brief replaces the full array by one of twice the size with the elements from top to bottom, called by the owner
+ * @note the new array gets published with release, so a thief that loads it sees the copied elements
+ * @retval NULL = out of memory
+ * @return the new array
+ */
+static fifo_deque_array_t *_grow(fifo_deque_t *pDeque, fifo_deque_array_t *pOld, int64_t top, int64_t bottom)
+{
+    size_t capacity = (pOld->mask + 1) * 2;
+    if (capacity == 0 || capacity > (SIZE_MAX - sizeof(fifo_deque_array_t)) / pDeque->basetype_size)
+        return NULL;
+    fifo_deque_array_t *pNew = (fifo_deque_array_t *)malloc(sizeof(fifo_deque_array_t) + capacity * pDeque->basetype_size);
+    if (pNew == NULL)
+        return NULL;
+    pNew->mask = capacity - 1;
+    pNew->pData = (uint8_t *)(pNew + 1);
+    pNew->pRetired = pOld;
+    for (int64_t i = top; i < bottom; i++)
+    {
+        memcpy(_SLOT(pDeque, pNew, i), _SLOT(pDeque, pOld, i), pDeque->basetype_size);
+    }
+    __atomic_store_n(&pDeque->pArray, pNew, __ATOMIC_RELEASE);
+    return pNew;
+}
+#endif  /* FIFO_ALLOW_MALLOC */
+
+/**
+ * @brief initializes an empty deque
+ * @note If _DEBUG is defined every Parameter will be checked with assert()
+ * @param pDeque pointer to the deque handle
+ * @param pBuffer pointer to the memory of the first array, it is not freed by the deque
+ * @param size_deque size of pBuffer in elements, must be a power of two
+ * @param basetype_size size of the fifo basetype eg: sizeof(uint8_t)
+ * @retval 0 = success
+ * @retval -1 = NULL Pointer as Parameter
+ * @retval -2 = invalid deque size
+ * @retval -3 = invalid basetype_size
+ */
+int8_t fifo_deque_init(fifo_deque_t *pDeque, void *pBuffer, size_t size_deque, SIZE_FIFO_BASE_TYPE basetype_size)
+{
+#ifdef _DEBUG
+    assert(pDeque != NULL);
+    assert(pBuffer != NULL);
+    assert(basetype_size > 0 && basetype_size <= FIFO_MAX_BASETYPE_SIZE);
+#endif
+    // *** Checking Parameters ***
+    if (pDeque == NULL || pBuffer == NULL)
+        return -1;
+    if (basetype_size == 0 || basetype_size > FIFO_MAX_BASETYPE_SIZE)
+        return -3;
+    if (size_deque == 0 || (size_deque & (size_deque -1)) != 0)
+        return -2;
+
+    // *** Initialize Handle ***
+    pDeque->basetype_size = basetype_size;
+    pDeque->first.mask = size_deque - 1;
+    pDeque->first.pData = (uint8_t *)pBuffer;
+    pDeque->first.pRetired = NULL;
+    pDeque->pArray = &pDeque->first;
+    pDeque->top = 0;
+    pDeque->bottom = 0;
+    return 0;
+}
+
+#if FIFO_ALLOW_MALLOC
+/**
+ * @brief frees the arrays the deque has grown to, the memory passed to fifo_deque_init() is not freed
+ * @param pDeque pointer to the deque handle
+ */
+void fifo_deque_deinit(fifo_deque_t *pDeque)
+{
+    if (pDeque != NULL)
+    {
+        while (pDeque->pArray != &pDeque->first)
+        {
+            fifo_deque_array_t *pRetired = pDeque->pArray->pRetired;
+            free(pDeque->pArray);
+            pDeque->pArray = pRetired;
+        }
+    }
+}
+
+/**
+ * @brief allocates a deque handle and its first array, and initializes it
+ * @note memory has to be freed with fifo_deque_deinit_free()
+ * @param size_deque initial capacity in elements, must be a power of two
+ * @param basetype_size size of the fifo basetype eg: sizeof(uint8_t)
+ * @retval NULL = failed
+ * @return pointer to the deque handle
+ */
+fifo_deque_t* fifo_deque_init_malloc(size_t size_deque, SIZE_FIFO_BASE_TYPE basetype_size)
+{
+    // *** Checking Parameters ***
+    if (basetype_size == 0 || basetype_size > FIFO_MAX_BASETYPE_SIZE)
+        return NULL;
+    if (size_deque > SIZE_MAX / basetype_size)
+        return NULL;
+
+    // *** Allocate Handle ***
+    fifo_deque_t *pDeque = (fifo_deque_t *)malloc(sizeof(*pDeque));
+
+    if (pDeque != NULL)
+    {
+        // *** Allocate Buffer ***
+        void *pBuffer = malloc(size_deque * basetype_size);
+        if (pBuffer == NULL || fifo_deque_init(pDeque, pBuffer, size_deque, basetype_size) != 0)
+        {
+            free(pBuffer);
+            free(pDeque);     // therefore free previously allocated memory
+            pDeque = NULL;
+        }
+    }
+    return pDeque;
+}
+
+/**
+ * @brief deallocates a deque from fifo_deque_init_malloc() and all of its arrays
+ * @param pDeque pointer to the deque handle
+ */
+void fifo_deque_deinit_free(fifo_deque_t *pDeque)
+{
+    if (pDeque != NULL)
+    {
+        fifo_deque_deinit(pDeque);
+        free(pDeque->first.pData);
+        free(pDeque);
+    }
+}
+#endif  /* FIFO_ALLOW_MALLOC */
+
+/**
+ * @brief pushes an element at the bottom, only called by the owner
+ * @param pDeque pointer to the deque handle
+ * @param [in] pData pointer to the data to be pushed
+ * @retval FIFO_FULL        the array is full and could not grow
+ * @return fifoerror_t
+ */
+fifoerror_t fifo_deque_push(fifo_deque_t *pDeque, const void *pData)
+{
+#ifdef _DEBUG
+    assert(pDeque != NULL);
+    assert(pData != NULL);
+#endif
+    // *** Checking Parameters ***
+    if (pDeque == NULL || pData == NULL)
+        return FIFO_WRONG_PARAM;
+
+    int64_t bottom = __atomic_load_n(&pDeque->bottom, __ATOMIC_RELAXED);
+    int64_t top = __atomic_load_n(&pDeque->top, __ATOMIC_ACQUIRE);
+    fifo_deque_array_t *pArray = pDeque->pArray;     // only the owner writes pArray
+
+    // *** Grow the array when it is full ***
+    if ((uint64_t)(bottom - top) > pArray->mask)
+    {
+#if FIFO_ALLOW_MALLOC
+        pArray = _grow(pDeque, pArray, top, bottom);
+        if (pArray == NULL)
+            return FIFO_FULL;
+#else
+        return FIFO_FULL;
+#endif
+    }
+
+    // *** Write the element, then publish it ***
+    memcpy(_SLOT(pDeque, pArray, bottom), pData, pDeque->basetype_size);
+    __atomic_store_n(&pDeque->bottom, bottom + 1, __ATOMIC_RELEASE);
+    return FIFO_NO_ERROR;
+}
+
+/**
+ * @brief pops the newest element from the bottom, only called by the owner
+ * @param pDeque pointer to the deque handle
+ * @param [out] pData pointer to the storage for the element
+ * @return fifoerror_t
+ */
+fifoerror_t fifo_deque_pop(fifo_deque_t *pDeque, void *pData)
+{
+#ifdef _DEBUG
+    assert(pDeque != NULL);
+    assert(pData != NULL);
+#endif
+    // *** Checking Parameters ***
+    if (pDeque == NULL || pData == NULL)
+        return FIFO_WRONG_PARAM;
+
+    // *** Take the element first, then look if a thief went for it ***
+    int64_t bottom = __atomic_load_n(&pDeque->bottom, __ATOMIC_RELAXED) - 1;
+    fifo_deque_array_t *pArray = pDeque->pArray;
+    __atomic_store_n(&pDeque->bottom, bottom, __ATOMIC_RELAXED);
+    __atomic_thread_fence(__ATOMIC_SEQ_CST);     // the store of bottom is visible before top is loaded, see fifo_deque_steal()
+    int64_t top = __atomic_load_n(&pDeque->top, __ATOMIC_RELAXED);
+
+    fifoerror_t ret = FIFO_NO_ERROR;
+    if (top > bottom)   // was empty
+    {
+        ret = FIFO_EMPTY;
+    }
+    else
+    {
+        memcpy(pData, _SLOT(pDeque, pArray, bottom), pDeque->basetype_size);
+        if (top != bottom)  // more elements left, no thief can reach this one
+            return FIFO_NO_ERROR;
+
+        // *** Last element, race the thieves for it ***
+        if (!__atomic_compare_exchange_n(&pDeque->top, &top, top + 1, false, __ATOMIC_SEQ_CST, __ATOMIC_RELAXED))
+        {
+            ret = FIFO_EMPTY;
+        }
+    }
+    __atomic_store_n(&pDeque->bottom, bottom + 1, __ATOMIC_RELAXED);
+    return ret;
+}
+
+/**
+ * @brief steals the oldest element from the top, may be called by any thread
+ * @param pDeque pointer to the deque handle
+ * @param [out] pData pointer to the storage for the element
+ * @retval FIFO_BUISY       another thread took the element first, try again
+ * @return fifoerror_t
+ */
+fifoerror_t fifo_deque_steal(fifo_deque_t *pDeque, void *pData)
+{
+#ifdef _DEBUG
+    assert(pDeque != NULL);
+    assert(pData != NULL);
+#endif
+    // *** Checking Parameters ***
+    if (pDeque == NULL || pData == NULL)
+        return FIFO_WRONG_PARAM;
+
+    int64_t top = __atomic_load_n(&pDeque->top, __ATOMIC_ACQUIRE);
+    __atomic_thread_fence(__ATOMIC_SEQ_CST);
+    int64_t bottom = __atomic_load_n(&pDeque->bottom, __ATOMIC_ACQUIRE);
+    if (top >= bottom)
+        return FIFO_EMPTY;
+
+    // *** Copy the element, it is only kept if top was not moved in the meantime ***
+    fifo_deque_array_t *pArray = __atomic_load_n(&pDeque->pArray, __ATOMIC_ACQUIRE);
+    memcpy(pData, _SLOT(pDeque, pArray, top), pDeque->basetype_size);
+    if (!__atomic_compare_exchange_n(&pDeque->top, &top, top + 1, false, __ATOMIC_SEQ_CST, __ATOMIC_RELAXED))
+        return FIFO_BUISY;
+    return FIFO_NO_ERROR;
+}
+
+/**
+ * @brief returns the number of elements in the deque, only a snapshot while thieves steal
+ * @param pDeque pointer to the deque handle
+ * @retval fill level in elements
+ */
+size_t fifo_deque_getLevel(fifo_deque_t *pDeque)
+{
+#ifdef _DEBUG
+    assert(pDeque != NULL);
+#endif
+    if (pDeque == NULL)
+    {
+        return 0;
+    }
+    int64_t top = __atomic_load_n(&pDeque->top, __ATOMIC_ACQUIRE);
+    int64_t bottom = __atomic_load_n(&pDeque->bottom, __ATOMIC_ACQUIRE);
+    return (bottom > top) ? (size_t)(bottom - top) : 0;
+}
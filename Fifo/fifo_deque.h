@@ -0,0 +1,126 @@
+/**
+ * @file fifo_deque.h
+ * @brief work stealing deque (Chase-Lev) with the element model of fifo_handle_t
+ * The owner thread pushes and pops elements at the bottom (LIFO), any number of thief threads steal elements from the
+ * top (FIFO). Push and pop of the owner are plain loads and stores, only when pop and a thief go for the last
+ * element one compare and swap on top decides. Thieves claim an element with a compare and swap on top.
+ * When the array is full the owner replaces it with one of twice the size (FIFO_ALLOW_MALLOC). The old array is kept
+ * until the deque is freed, because a thief may still copy an element out of it.
+ * @note the capacity has to be a power of two, all of the slots can be used
+ * @author Josef Aschwanden
+ * @date Oct - 2026
+ * @version 1.0
+ */
+
+#ifndef _FIFO_DEQUE_H_
+#define _FIFO_DEQUE_H_
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// *** INCLUDES ***
+#include <stddef.h>
+#include "fifo.h"
+
+// *** TYPEDEF ***
+/**
+ * @brief element memory of a deque, replaced by one of twice the size when it is full
+ */
+typedef struct fifo_deque_array{
+    size_t mask;                            /*!< capacity in elements -1 */
+    uint8_t *pData;                         /*!< element memory */
+    struct fifo_deque_array *pRetired;      /*!< array used before this one, freed with the deque */
+}fifo_deque_array_t;
+
+/**
+ * @brief this structure is used as handle for the work stealing deque
+ * top and bottom are on separate cache lines, top is written by the thieves and bottom only by the owner
+ */
+typedef struct{
+    SIZE_FIFO_BASE_TYPE basetype_size;      /*!< sizeof the fifo basetype (bytes) */
+    fifo_deque_array_t first;               /*!< array with the memory passed to fifo_deque_init() */
+    fifo_deque_array_t *pArray;             /*!< array in use */
+    uint8_t _pad0[FIFO_CACHE_LINE_SIZE];
+    int64_t top;                            /*!< next element to be stolen, free running */
+    uint8_t _pad1[FIFO_CACHE_LINE_SIZE - sizeof(int64_t)];
+    int64_t bottom;                         /*!< next element to be pushed, free running */
+    uint8_t _pad2[FIFO_CACHE_LINE_SIZE - sizeof(int64_t)];
+}fifo_deque_t;
+
+/**
+ * @brief initializes an empty deque
+ * @note If _DEBUG is defined every Parameter will be checked with assert()
+ * @param pDeque pointer to the deque handle
+ * @param pBuffer pointer to the memory of the first array, it is not freed by the deque
+ * @param size_deque size of pBuffer in elements, must be a power of two
+ * @param basetype_size size of the fifo basetype eg: sizeof(uint8_t)
+ * @retval 0 = success
+ * @retval -1 = NULL Pointer as Parameter
+ * @retval -2 = invalid deque size
+ * @retval -3 = invalid basetype_size
+ */
+int8_t fifo_deque_init(fifo_deque_t *pDeque, void *pBuffer, size_t size_deque, SIZE_FIFO_BASE_TYPE basetype_size);
+
+#if FIFO_ALLOW_MALLOC
+/**
+ * @brief frees the arrays the deque has grown to, the memory passed to fifo_deque_init() is not freed
+ * @param pDeque pointer to the deque handle
+ */
+void fifo_deque_deinit(fifo_deque_t *pDeque);
+
+/**
+ * @brief allocates a deque handle and its first array, and initializes it
+ * @note memory has to be freed with fifo_deque_deinit_free()
+ * @param size_deque initial capacity in elements, must be a power of two
+ * @param basetype_size size of the fifo basetype eg: sizeof(uint8_t)
+ * @retval NULL = failed
+ * @return pointer to the deque handle
+ */
+fifo_deque_t* fifo_deque_init_malloc(size_t size_deque, SIZE_FIFO_BASE_TYPE basetype_size);
+
+/**
+ * @brief deallocates a deque from fifo_deque_init_malloc() and all of its arrays
+ * @param pDeque pointer to the deque handle
+ */
+void fifo_deque_deinit_free(fifo_deque_t *pDeque);
+#endif  /* FIFO_ALLOW_MALLOC */
+
+/**
+ * @brief pushes an element at the bottom, only called by the owner
+ * @param pDeque pointer to the deque handle
+ * @param [in] pData pointer to the data to be pushed
+ * @retval FIFO_FULL        the array is full and could not grow
+ * @return fifoerror_t
+ */
+fifoerror_t fifo_deque_push(fifo_deque_t *pDeque, const void *pData);
+
+/**
+ * @brief pops the newest element from the bottom, only called by the owner
+ * @param pDeque pointer to the deque handle
+ * @param [out] pData pointer to the storage for the element
+ * @return fifoerror_t
+ */
+fifoerror_t fifo_deque_pop(fifo_deque_t *pDeque, void *pData);
+
+/**
+ * @brief steals the oldest element from the top, may be called by any thread
+ * @param pDeque pointer to the deque handle
+ * @param [out] pData pointer to the storage for the element
+ * @retval FIFO_BUISY       another thread took the element first, try again
+ * @return fifoerror_t
+ */
+fifoerror_t fifo_deque_steal(fifo_deque_t *pDeque, void *pData);
+
+/**
+ * @brief returns the number of elements in the deque, only a snapshot while thieves steal
+ * @param pDeque pointer to the deque handle
+ * @retval fill level in elements
+ */
+size_t fifo_deque_getLevel(fifo_deque_t *pDeque);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif  // _FIFO_DEQUE_H_
@@ -0,0 +1,370 @@
+/**
+ * @brief this file contains a thread pool executor built on the mpmc fifos of the c fifo library (Linux)
+ * Every worker thread has a local fifo_mpmc_handle_t of tasks. Tasks submitted from outside the pool are spread
+ * round robin over the local fifos, tasks submitted by a worker go into its own fifo. When a local fifo is full the
+ * task goes into the global overflow queue. A worker takes tasks from its own fifo, then from the overflow queue and
+ * then steals from the fifos of the other workers, so there is no central queue all threads contend on.
+ * Idle workers park on a condition variable, submit() only locks its mutex when a worker is parked.
+ * @note link fifo_mpmc.o (fifo_mpmc.c)
+ * @author Josef Aschwanden
+ * @date Oct - 2026
+ * @version 1.0
+ */
+// *** INCLUDES ***
+#include "fifo_mpmc.h"
+#include <pthread.h>
+#include <sched.h>
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <functional>
+#include <future>
+#include <iterator>
+#include <memory>
+#include <mutex>
+#include <new>
+#include <stdexcept>
+#include <thread>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#pragma once
+
+namespace utils{
+    /**
+     * @brief thread pool with one local fifo per worker, a global overflow queue and futures for the results
+     * @note the executor can neither be copied nor moved, the destructor runs the tasks left and joins the workers
+     */
+    class Executor{
+        /**
+         * @brief type erased task, the fifos hold pointers to it
+         */
+        struct Task{
+            virtual ~Task() {}
+            virtual void run() = 0;
+        };
+
+        template<typename R>
+        struct PackagedTask : Task{
+            std::packaged_task<R()> task;
+            template<typename F>
+            explicit PackagedTask(F&& f) : task(std::forward<F>(f)) {}
+            void run() override { task(); }
+        };
+
+        /**
+         * @brief worker the calling thread belongs to, nullptr outside of a pool
+         */
+        struct Current{
+            const Executor *pExecutor;
+            size_t worker;
+        };
+        static Current& current()
+        {
+            static thread_local Current id{nullptr, 0};
+            return id;
+        }
+
+    public:
+
+        /**
+         * @brief constructor: starts threads workers, each with a local fifo of queue_size tasks
+         * @param threads number of worker threads, 0 = one per core
+         * @param queue_size size of each local fifo in tasks, must be a power of two
+         * @param pin true = every worker runs on one of the cores the calling thread may run on only, round robin
+         * @throw std::invalid_argument queue_size is not a power of two
+         * @throw std::bad_alloc a local fifo could not be allocated
+         */
+        explicit Executor(size_t threads = 0, size_t queue_size = 256, bool pin = true)
+            : m_overflowLevel(0), m_stop(false), m_idle(0), m_wakeups(0), m_next(0)
+        {
+            if (queue_size < 2 || (queue_size & (queue_size -1)) != 0)
+                throw std::invalid_argument("Executor: queue_size has to be a power of two");
+            size_t cores = std::thread::hardware_concurrency();
+            if (cores == 0)
+                cores = 1;
+            if (threads == 0)
+                threads = cores;
+            for (size_t i = 0; i < threads; i++)
+            {
+                fifo_mpmc_handle_t *pQueue = fifo_mpmc_init_malloc(queue_size, sizeof(Task *));
+                if (pQueue == nullptr)
+                {
+                    release();
+                    throw std::bad_alloc();
+                }
+                m_queues.push_back(pQueue);
+            }
+            std::vector<int> allowed;
+            if (pin)
+                allowed = allowedCpus();
+            try
+            {
+                for (size_t i = 0; i < threads; i++)
+                {
+                    m_workers.emplace_back(&Executor::work, this, i);
+                    if (!allowed.empty())
+                    {
+                        cpu_set_t cpus;
+                        CPU_ZERO(&cpus);
+                        CPU_SET(allowed[i % allowed.size()], &cpus);
+                        // a worker that can not be pinned runs on any core
+                        (void)pthread_setaffinity_np(m_workers.back().native_handle(), sizeof(cpus), &cpus);
+                    }
+                }
+            }
+            catch (...)     // a thread could not be started, stop the ones that were
+            {
+                stop();
+                release();
+                throw;
+            }
+        }
+
+        Executor(const Executor&) = delete;
+        Executor& operator=(const Executor&) = delete;
+
+        /**
+         * @brief destructor: runs the tasks left, then stops and joins the workers
+         */
+        ~Executor()
+        {
+            stop();
+            release();
+        }
+
+        /**
+         * @brief returns the number of worker threads
+         */
+        size_t workers() const
+        {
+            return m_queues.size();
+        }
+
+        /**
+         * @brief submits a callable, it gets called with args by one of the workers
+         * @return future of the result of the callable
+         */
+        template<typename F, typename... Args>
+        auto submit(F&& f, Args&&... args) -> std::future<std::invoke_result_t<std::decay_t<F>, std::decay_t<Args>...>>
+        {
+            using R = std::invoke_result_t<std::decay_t<F>, std::decay_t<Args>...>;
+            // f and the arguments are stored by value and moved into the call, so move only arguments work
+            auto *pTask = new PackagedTask<R>(
+                [f = std::forward<F>(f), args = std::tuple<std::decay_t<Args>...>(std::forward<Args>(args)...)]() mutable -> R {
+                    return std::apply(std::move(f), std::move(args));
+                });
+            std::future<R> future = pTask->task.get_future();
+            push(pTask, nextQueue());
+            wake(1);
+            return future;
+        }
+
+        /**
+         * @brief submits all callables of [first, last), they are spread over the local fifos and the workers get woken once
+         * @return futures of the results, in the order of the callables
+         */
+        template<typename It>
+        auto submit_batch(It first, It last) -> std::vector<std::future<decltype((*first)())>>
+        {
+            using R = decltype((*first)());
+            std::vector<std::future<R>> futures;
+            futures.reserve(std::distance(first, last));
+            size_t queue = nextQueue();
+            for (; first != last; ++first)
+            {
+                auto *pTask = new PackagedTask<R>(*first);
+                futures.push_back(pTask->task.get_future());
+                push(pTask, queue);
+                if (++queue == m_queues.size())
+                    queue = 0;
+            }
+            wake(futures.size());
+            return futures;
+        }
+
+    private:
+
+        /**
+         * @brief returns the cores the calling thread may run on, empty when they are unknown
+         */
+        static std::vector<int> allowedCpus()
+        {
+            std::vector<int> allowed;
+            cpu_set_t cpus;
+            if (sched_getaffinity(0, sizeof(cpus), &cpus) == 0)
+            {
+                for (int cpu = 0; cpu < CPU_SETSIZE; cpu++)
+                {
+                    if (CPU_ISSET(cpu, &cpus))
+                        allowed.push_back(cpu);
+                }
+            }
+            return allowed;
+        }
+
+        /**
+         * @brief stops the workers after they ran the tasks left and joins them
+         */
+        void stop()
+        {
+            {
+                std::lock_guard<std::mutex> lock(m_parkLock);
+                m_stop.store(true);
+            }
+            m_park.notify_all();
+            for (auto& worker : m_workers)
+                worker.join();
+            m_workers.clear();
+        }
+
+        /**
+         * @brief returns the local fifo for the next task, a worker submits into its own fifo
+         */
+        size_t nextQueue()
+        {
+            const Current& id = current();
+            if (id.pExecutor == this)
+                return id.worker;
+            return m_next.fetch_add(1, std::memory_order_relaxed) % m_queues.size();
+        }
+
+        /**
+         * @brief puts a task into a local fifo, or into the overflow queue when it is full
+         */
+        void push(Task *pTask, size_t queue)
+        {
+            if (fifo_mpmc_put(m_queues[queue], &pTask) != FIFO_NO_ERROR)
+            {
+                std::lock_guard<std::mutex> lock(m_overflowLock);
+                m_overflow.push_back(pTask);
+                m_overflowLevel.fetch_add(1, std::memory_order_relaxed);
+            }
+        }
+
+        /**
+         * @brief wakes up to n parked workers, the mutex is only locked when a worker is parked
+         * @note the fence orders the push of the task before the load of m_idle, a worker counts itself in m_idle
+         * before it looks for tasks a last time, so either the worker finds the task or this sees the worker
+         */
+        void wake(size_t n)
+        {
+            std::atomic_thread_fence(std::memory_order_seq_cst);
+            if (n == 0 || m_idle.load(std::memory_order_relaxed) == 0)
+                return;
+            {
+                std::lock_guard<std::mutex> lock(m_parkLock);
+                m_wakeups++;
+            }
+            if (n == 1)
+                m_park.notify_one();
+            else
+                m_park.notify_all();
+        }
+
+        /**
+         * @brief finds a task: own fifo, overflow queue, then the fifos of the other workers
+         * @retval nullptr = no task
+         */
+        Task *find(size_t worker)
+        {
+            Task *pTask;
+            if (fifo_mpmc_get(m_queues[worker], &pTask) == FIFO_NO_ERROR)
+                return pTask;
+            if (m_overflowLevel.load(std::memory_order_relaxed) != 0)
+            {
+                std::lock_guard<std::mutex> lock(m_overflowLock);
+                if (!m_overflow.empty())
+                {
+                    pTask = m_overflow.front();
+                    m_overflow.pop_front();
+                    m_overflowLevel.fetch_sub(1, std::memory_order_relaxed);
+                    return pTask;
+                }
+            }
+            for (size_t i = 1; i < m_queues.size(); i++)
+            {
+                size_t victim = (worker + i) % m_queues.size();
+                if (fifo_mpmc_get(m_queues[victim], &pTask) == FIFO_NO_ERROR)
+                    return pTask;
+            }
+            return nullptr;
+        }
+
+        /**
+         * @brief parks the worker until a task is submitted, it counts itself as idle and looks for a task a last time before
+         * @retval nullptr = woken or stopped, no task found
+         */
+        Task *park(size_t worker)
+        {
+            m_idle.fetch_add(1);
+            std::atomic_thread_fence(std::memory_order_seq_cst);
+            std::unique_lock<std::mutex> lock(m_parkLock);
+            uint64_t wakeups = m_wakeups;
+            lock.unlock();
+            Task *pTask = find(worker);
+            if (pTask == nullptr)
+            {
+                lock.lock();
+                m_park.wait(lock, [&]{ return m_wakeups != wakeups || m_stop.load(); });
+                lock.unlock();
+            }
+            m_idle.fetch_sub(1);
+            return pTask;
+        }
+
+        /**
+         * @brief loop of a worker thread, it leaves when the executor is stopped and no task is left
+         */
+        void work(size_t worker)
+        {
+            current() = Current{this, worker};
+            for (;;)
+            {
+                Task *pTask = find(worker);
+                if (pTask == nullptr && (pTask = park(worker)) == nullptr)
+                {
+                    if (m_stop.load() && (pTask = find(worker)) == nullptr)
+                        return;
+                    if (pTask == nullptr)
+                        continue;
+                }
+                pTask->run();
+                delete pTask;
+            }
+        }
+
+        /**
+         * @brief frees the local fifos, the tasks left in them are dropped
+         */
+        void release()
+        {
+            Task *pTask;
+            for (auto pQueue : m_queues)
+            {
+                while (fifo_mpmc_get(pQueue, &pTask) == FIFO_NO_ERROR)
+                    delete pTask;
+                fifo_mpmc_deinit_free(pQueue);
+            }
+            m_queues.clear();
+            for (auto pOverflow : m_overflow)
+                delete pOverflow;
+            m_overflow.clear();
+        }
+
+        std::vector<fifo_mpmc_handle_t *> m_queues;
+        std::vector<std::thread> m_workers;
+        std::mutex m_overflowLock;
+        std::deque<Task *> m_overflow;
+        std::atomic<size_t> m_overflowLevel;
+        std::mutex m_parkLock;
+        std::condition_variable m_park;
+        std::atomic<bool> m_stop;
+        std::atomic<size_t> m_idle;
+        uint64_t m_wakeups;                 // changed with m_parkLock held when parked workers are woken
+        std::atomic<size_t> m_next;
+    };
+}
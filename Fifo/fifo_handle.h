@@ -0,0 +1,69 @@
+/**
+ * @file fifo_handle.h
+ * @brief definition of the fifo handle, shared by fifo_handle_t (fifo.h) and fifo_wide_handle_t (fifo_wide.h)
+ * @note this file has no include guard, FIFO_HANDLE_NAME and FIFO_HANDLE_INDEX_TYPE have to be defined before
+ * it is included, they get undefined at the end
+ */
+
+/**
+ * @brief this structure is used as handle for the fifo library
+ * With FIFO_SPSC the producer owned and the consumer owned indices are on separate cache lines.
+ * Each side keeps a copy of the index of the other side and only loads the real one when the fifo
+ * looks full (producer) or empty (consumer) with the copy.
+ */
+typedef struct{
+    SIZE_FIFO_BASE_TYPE basetype_size;      /*!< sizeof the fifo basetype (bytes) */
+    FIFO_HANDLE_INDEX_TYPE size;            /*!< size of the fifo memory (bytes) */
+#if FIFO_SPSC
+#if FIFO_POW2
+    FIFO_HANDLE_INDEX_TYPE mask;            /*!< capacity in elements -1 */
+#endif
+    void *pFifo;                            /*!< pointer to the first adress of the fifo memory */
+    uint8_t _pad0[FIFO_CACHE_LINE_SIZE];
+    FIFO_HANDLE_INDEX_TYPE write_idx;       /*!< write index for fifo write access, offset from pFifo in bytes (element counter with FIFO_POW2) */
+    FIFO_HANDLE_INDEX_TYPE read_idx_cache;  /*!< copy of read_idx, only used by the producer */
+    uint8_t _pad1[FIFO_CACHE_LINE_SIZE - 2 * sizeof(FIFO_HANDLE_INDEX_TYPE)];
+#if FIFO_OVERWRITE
+    FIFO_HANDLE_INDEX_TYPE read_idx __attribute__((aligned(FIFO_READ_POS_ALIGN(FIFO_HANDLE_INDEX_TYPE))));  /*!< read index for fifo read access, offset from pFifo in bytes (element counter with FIFO_POW2) */
+    uint32_t dropped;                       /*!< elements dropped by fifo_put(), moved together with read_idx */
+#else
+    FIFO_HANDLE_INDEX_TYPE read_idx;        /*!< read index for fifo read access, offset from pFifo in bytes (element counter with FIFO_POW2) */
+#endif
+    FIFO_HANDLE_INDEX_TYPE write_idx_cache; /*!< copy of write_idx, only used by the consumer */
+#if FIFO_OVERWRITE
+    uint8_t _pad2[FIFO_CACHE_LINE_SIZE - FIFO_READ_POS_ALIGN(FIFO_HANDLE_INDEX_TYPE) - sizeof(FIFO_HANDLE_INDEX_TYPE)];     // read_idx and dropped fill FIFO_READ_POS_ALIGN bytes
+#else
+    uint8_t _pad2[FIFO_CACHE_LINE_SIZE - 2 * sizeof(FIFO_HANDLE_INDEX_TYPE)];
+#endif
+#else
+    FIFO_HANDLE_INDEX_TYPE read_idx;        /*!< read index for fifo read access, offset from pFifo in bytes (element counter with FIFO_POW2) */
+#if FIFO_OVERWRITE
+    uint32_t dropped;                       /*!< elements dropped by fifo_put(), moved together with read_idx */
+#endif
+    FIFO_HANDLE_INDEX_TYPE write_idx;       /*!< write index for fifo write access, offset from pFifo in bytes (element counter with FIFO_POW2) */
+#if FIFO_POW2
+    FIFO_HANDLE_INDEX_TYPE mask;            /*!< capacity in elements -1 */
+#endif
+    void *pFifo;                            /*!< pointer to the first adress of the fifo memory */
+	uint8_t _lock;                          /*!< flag to lock the fifo */
+#endif
+#if FIFO_MIRROR
+    bool mirrored;                          /*!< the fifo memory is mapped a second time right after pFifo + size */
+#endif
+#if FIFO_OVERWRITE
+    bool overwrite;                         /*!< fifo_put() drops the oldest element when the fifo is full */
+#endif
+#if FIFO_NOTIFY
+    fifo_notify_callback_t notify;          /*!< called by the producer when a put made the fifo non-empty, NULL = none */
+    void *pNotifyCtx;                       /*!< context pointer of notify */
+#endif
+#if FIFO_WAIT
+    uint32_t _data_seq;                     /*!< futex word of the consumers, changes when elements are put while _data_waiters != 0 */
+    uint32_t _data_waiters;                 /*!< number of consumers parked in fifo_get_wait() */
+    uint32_t _space_seq;                    /*!< futex word of the producers, changes when elements are got while _space_waiters != 0 */
+    uint32_t _space_waiters;                /*!< number of producers parked in fifo_put_wait() */
+#endif
+}FIFO_HANDLE_NAME;
+
+#undef FIFO_HANDLE_NAME
+#undef FIFO_HANDLE_INDEX_TYPE
@@ -0,0 +1,228 @@
+// *** INCLUDES ***
+#include "fifo_mpmc.h"
+#include <string.h> // memcpy
+#ifdef _DEBUG
+    #include <assert.h>
+#endif
+#if FIFO_ALLOW_MALLOC == true
+    #include <malloc.h>
+#endif /* FIFO_ALLOW_MALLOC */
+
+// *** DEFINES ***
+#define _SLOT(pHandle, pos)     ((size_t *)((uint8_t *)(pHandle)->pFifo + ((pos) & (pHandle)->mask) * (pHandle)->slot_size))
+#define _SLOT_DATA(pSlot)       ((void *)((pSlot) + 1))
+
+/**
+ * @brief initializes a mpmc fifo handle
+ * @note If _DEBUG is defined every Parameter will be checked with assert()
+ * @param pHandle pointer to the fifo handle
+ * @param pFifo pointer to the fifo memory, aligned to size_t
+ * @param size_fifo size of the fifo memory in bytes, must be a power of two multiple of FIFO_MPMC_SLOT_SIZE(basetype_size)
+ * @param basetype_size size of the fifo basetype eg: sizeof(uint8_t)
+ * @retval 0 = success
+ * @retval -1 = NULL Pointer as Parameter
+ * @retval -2 = invalid fifo size
+ * @retval -3 = invalid basetype_size
+ */
+int8_t fifo_mpmc_init(fifo_mpmc_handle_t *pHandle, void *pFifo, size_t size_fifo, SIZE_FIFO_BASE_TYPE basetype_size)
+{
+#ifdef _DEBUG
+    assert(pHandle != NULL);
+    assert(pFifo != NULL);
+    assert(basetype_size > 0 && basetype_size <= FIFO_MAX_BASETYPE_SIZE);
+#endif
+
+    // *** Checking Parameters ***
+    if (pHandle == NULL || pFifo == NULL)
+        return -1;
+    if (basetype_size == 0 || basetype_size > FIFO_MAX_BASETYPE_SIZE)
+        return -3;
+
+    size_t slot_size = FIFO_MPMC_SLOT_SIZE(basetype_size);
+    size_t capacity = size_fifo / slot_size;
+    if (capacity < 2 || size_fifo % slot_size != 0 || (capacity & (capacity -1)) != 0)
+        return -2;
+
+    // *** Initialize Handle ***
+    pHandle->basetype_size = basetype_size;
+    pHandle->slot_size = slot_size;
+    pHandle->mask = capacity -1;
+    pHandle->pFifo = pFifo;
+    pHandle->write_pos = 0;
+    pHandle->read_pos = 0;
+
+    // *** Initialize Slots ***
+    for (size_t i = 0; i < capacity; i++)
+    {
+        *_SLOT(pHandle, i) = i;     // slot i is free for the producer at position i
+    }
+    __atomic_thread_fence(__ATOMIC_RELEASE);
+    return 0;
+}
+
+#if FIFO_ALLOW_MALLOC
+/**
+ * @brief allocates a mpmc fifo handle and the fifo memory, and initializes it
+ * @note memory has to be freed with fifo_mpmc_deinit_free()
+ * @param size_fifo size of the fifo in elements, must be a power of two
+ * @param basetype_size size of the fifo basetype eg: sizeof(uint8_t)
+ * @retval NULL = failed
+ * @return pointer to the fifo handle
+ */
+fifo_mpmc_handle_t* fifo_mpmc_init_malloc(size_t size_fifo, SIZE_FIFO_BASE_TYPE basetype_size)
+{
+    // *** Checking Parameters ***
+    if (basetype_size == 0 || basetype_size > FIFO_MAX_BASETYPE_SIZE)
+        return NULL;
+    if (size_fifo > SIZE_MAX / FIFO_MPMC_SLOT_SIZE(basetype_size))
+        return NULL;
+
+    fifo_mpmc_handle_t *myHandle = NULL;
+
+    // *** Allocate Handle ***
+    myHandle = (fifo_mpmc_handle_t *)malloc(sizeof(*myHandle));
+
+    if (myHandle != NULL)
+    {
+        // *** Allocate Buffer ***
+        void *pFifo = malloc(size_fifo * FIFO_MPMC_SLOT_SIZE(basetype_size));
+        if (pFifo == NULL || fifo_mpmc_init(myHandle, pFifo, size_fifo * FIFO_MPMC_SLOT_SIZE(basetype_size), basetype_size) != 0)
+        {
+            free(pFifo);
+            free(myHandle);     // therefore free previously allocated memory
+            myHandle = NULL;
+        }
+    }
+    return myHandle;
+}
+
+/**
+ * @brief deallocates a mpmc fifo handle and its buffer
+ * @param pHandle pointer to the fifo handle
+ */
+void fifo_mpmc_deinit_free(fifo_mpmc_handle_t *pHandle)
+{
+#ifdef _DEBUG
+    assert(pHandle != NULL);
+#endif
+    if (pHandle != NULL)
+    {
+        free(pHandle->pFifo);
+        free(pHandle);
+    }
+}
+#endif  /* FIFO_ALLOW_MALLOC */
+
+/**
+ * @brief puts an element into the fifo, may be called from multiple threads
+ * @param pHandle pointer to the fifo handle
+ * @param [in] pData pointer to the data to be put onto the fifo
+ * @return fifoerror_t
+ */
+fifoerror_t fifo_mpmc_put(fifo_mpmc_handle_t *pHandle, const void *pData)
+{
+#ifdef _DEBUG
+    assert(pHandle != NULL);
+    assert(pData != NULL);
+#endif
+    // *** Checking Parameters ***
+    if (pHandle == NULL || pData == NULL)
+        return FIFO_WRONG_PARAM;
+
+    size_t pos = __atomic_load_n(&pHandle->write_pos, __ATOMIC_RELAXED);
+    size_t *pSlot;
+
+    // *** Claim a slot ***
+    for (;;)
+    {
+        pSlot = _SLOT(pHandle, pos);
+        intptr_t diff = (intptr_t)__atomic_load_n(pSlot, __ATOMIC_ACQUIRE) - (intptr_t)pos;
+        if (diff == 0)          // slot is free for this position
+        {
+            if (__atomic_compare_exchange_n(&pHandle->write_pos, &pos, pos +1, true, __ATOMIC_RELAXED, __ATOMIC_RELAXED))
+                break;
+        }
+        else if (diff < 0)      // slot still holds the element of the previous round
+        {
+            return FIFO_FULL;
+        }
+        else                    // another producer claimed the position
+        {
+            pos = __atomic_load_n(&pHandle->write_pos, __ATOMIC_RELAXED);
+        }
+    }
+
+    // *** Write to the slot, then hand it to the consumers ***
+    memcpy(_SLOT_DATA(pSlot), pData, pHandle->basetype_size);
+    __atomic_store_n(pSlot, pos +1, __ATOMIC_RELEASE);
+    return FIFO_NO_ERROR;
+}
+
+/**
+ * @brief gets an element from the fifo, may be called from multiple threads
+ * @param pHandle pointer to the fifo handle
+ * @param [out] pData pointer to the storage for the data from the fifo
+ * @return fifoerror_t
+ */
+fifoerror_t fifo_mpmc_get(fifo_mpmc_handle_t *pHandle, void *pData)
+{
+#ifdef _DEBUG
+    assert(pHandle != NULL);
+    assert(pData != NULL);
+#endif
+    // *** Checking Parameters ***
+    if (pHandle == NULL || pData == NULL)
+        return FIFO_WRONG_PARAM;
+
+    size_t pos = __atomic_load_n(&pHandle->read_pos, __ATOMIC_RELAXED);
+    size_t *pSlot;
+
+    // *** Claim a slot ***
+    for (;;)
+    {
+        pSlot = _SLOT(pHandle, pos);
+        intptr_t diff = (intptr_t)__atomic_load_n(pSlot, __ATOMIC_ACQUIRE) - (intptr_t)(pos +1);
+        if (diff == 0)          // slot holds the element of this position
+        {
+            if (__atomic_compare_exchange_n(&pHandle->read_pos, &pos, pos +1, true, __ATOMIC_RELAXED, __ATOMIC_RELAXED))
+                break;
+        }
+        else if (diff < 0)      // element not written yet
+        {
+            return FIFO_EMPTY;
+        }
+        else                    // another consumer claimed the position
+        {
+            pos = __atomic_load_n(&pHandle->read_pos, __ATOMIC_RELAXED);
+        }
+    }
+
+    // *** Copy the data, then hand the slot to the producers of the next round ***
+    memcpy(pData, _SLOT_DATA(pSlot), pHandle->basetype_size);
+    __atomic_store_n(pSlot, pos + pHandle->mask +1, __ATOMIC_RELEASE);
+    return FIFO_NO_ERROR;
+}
+
+/**
+ * @brief returns the fill level of a fifo
+ * @note the value is only a snapshot while other threads access the fifo
+ * @param pHandle pointer to a fifo handle
+ * @retval fill level of the fifo in elements
+ */
+size_t fifo_mpmc_getLevel(fifo_mpmc_handle_t *pHandle)
+{
+#ifdef _DEBUG
+    assert(pHandle != NULL);
+#endif
+    if (pHandle == NULL)
+    {
+        return 0;
+    }
+    size_t read_pos = __atomic_load_n(&pHandle->read_pos, __ATOMIC_ACQUIRE);     // read_pos first, write_pos can only be bigger
+    size_t level = __atomic_load_n(&pHandle->write_pos, __ATOMIC_ACQUIRE) - read_pos;
+    if (level > pHandle->mask +1)   // consumers claimed more positions in the meantime
+    {
+        level = pHandle->mask +1;
+    }
+    return level;
+}
@@ -0,0 +1,110 @@
+/**
+ * @file fifo_mpmc.h
+ * @brief bounded multi producer / multi consumer fifo
+ * Any number of threads may call fifo_mpmc_put() and fifo_mpmc_get() on the same fifo at the same time.
+ * Every slot carries a sequence number, producers and consumers claim slots with a compare and swap on
+ * the write / read position, so there is no global lock and no critical section.
+ * The fifo uses the same element model as fifo_handle_t (basetype_size bytes per element) and returns fifoerror_t.
+ * @note the capacity has to be a power of two, all of the slots can be used
+ * @author Josef Aschwanden
+ * @date Oct - 2026
+ * @version 1.0
+ */
+
+#ifndef _FIFO_MPMC_H_
+#define _FIFO_MPMC_H_
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// *** INCLUDES ***
+#include <stddef.h>
+#include "fifo.h"
+
+// *** DEFINES ***
+/**
+ * @brief size of one slot in bytes (sequence number and element, aligned to the sequence number)
+ * @param basetype_size size of the fifo basetype eg: sizeof(uint8_t)
+ */
+#define FIFO_MPMC_SLOT_SIZE(basetype_size)  \
+    ((sizeof(size_t) + (basetype_size) + sizeof(size_t) -1) / sizeof(size_t) * sizeof(size_t))
+
+// *** TYPEDEF ***
+/**
+ * @brief this structure is used as handle for the mpmc fifo
+ * write_pos and read_pos are on separate cache lines so producers and consumers do not share one
+ */
+typedef struct{
+    SIZE_FIFO_BASE_TYPE basetype_size;      /*!< sizeof the fifo basetype (bytes) */
+    size_t slot_size;                       /*!< size of one slot (bytes), see FIFO_MPMC_SLOT_SIZE() */
+    size_t mask;                            /*!< capacity in elements -1 */
+    void *pFifo;                            /*!< pointer to the first slot */
+    uint8_t _pad0[FIFO_CACHE_LINE_SIZE];
+    size_t write_pos;                       /*!< next position to be claimed by a producer, free running */
+    uint8_t _pad1[FIFO_CACHE_LINE_SIZE - sizeof(size_t)];
+    size_t read_pos;                        /*!< next position to be claimed by a consumer, free running */
+    uint8_t _pad2[FIFO_CACHE_LINE_SIZE - sizeof(size_t)];
+}fifo_mpmc_handle_t;
+
+/**
+ * @brief initializes a mpmc fifo handle
+ * @note If _DEBUG is defined every Parameter will be checked with assert()
+ * @param pHandle pointer to the fifo handle
+ * @param pFifo pointer to the fifo memory, aligned to size_t
+ * @param size_fifo size of the fifo memory in bytes, must be a power of two multiple of FIFO_MPMC_SLOT_SIZE(basetype_size)
+ * @param basetype_size size of the fifo basetype eg: sizeof(uint8_t)
+ * @retval 0 = success
+ * @retval -1 = NULL Pointer as Parameter
+ * @retval -2 = invalid fifo size
+ * @retval -3 = invalid basetype_size
+ */
+int8_t fifo_mpmc_init(fifo_mpmc_handle_t *pHandle, void *pFifo, size_t size_fifo, SIZE_FIFO_BASE_TYPE basetype_size);
+
+#if FIFO_ALLOW_MALLOC
+/**
+ * @brief allocates a mpmc fifo handle and the fifo memory, and initializes it
+ * @note memory has to be freed with fifo_mpmc_deinit_free()
+ * @param size_fifo size of the fifo in elements, must be a power of two
+ * @param basetype_size size of the fifo basetype eg: sizeof(uint8_t)
+ * @retval NULL = failed
+ * @return pointer to the fifo handle
+ */
+fifo_mpmc_handle_t* fifo_mpmc_init_malloc(size_t size_fifo, SIZE_FIFO_BASE_TYPE basetype_size);
+
+/**
+ * @brief deallocates a mpmc fifo handle and its buffer
+ * @param pHandle pointer to the fifo handle
+ */
+void fifo_mpmc_deinit_free(fifo_mpmc_handle_t *pHandle);
+#endif  /* FIFO_ALLOW_MALLOC */
+
+/**
+ * @brief puts an element into the fifo, may be called from multiple threads
+ * @param pHandle pointer to the fifo handle
+ * @param [in] pData pointer to the data to be put onto the fifo
+ * @return fifoerror_t
+ */
+fifoerror_t fifo_mpmc_put(fifo_mpmc_handle_t *pHandle, const void *pData);
+
+/**
+ * @brief gets an element from the fifo, may be called from multiple threads
+ * @param pHandle pointer to the fifo handle
+ * @param [out] pData pointer to the storage for the data from the fifo
+ * @return fifoerror_t
+ */
+fifoerror_t fifo_mpmc_get(fifo_mpmc_handle_t *pHandle, void *pData);
+
+/**
+ * @brief returns the fill level of a fifo
+ * @note the value is only a snapshot while other threads access the fifo
+ * @param pHandle pointer to a fifo handle
+ * @retval fill level of the fifo in elements
+ */
+size_t fifo_mpmc_getLevel(fifo_mpmc_handle_t *pHandle);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif  // _FIFO_MPMC_H_
@@ -0,0 +1,219 @@
+// *** INCLUDES ***
+#include "fifo_prio.h"
+#ifdef _DEBUG
+    #include <assert.h>
+#endif
+#if FIFO_ALLOW_MALLOC == true
+    #include <stdlib.h> // malloc, free
+#endif /* FIFO_ALLOW_MALLOC */
+
+// *** STATIC FUNCTIONS ***
+/**
+ * @brief clears the ready bit of a lane that looked empty, and sets it again if a producer put an element in the meantime
+ * @note the bit is cleared before the lane is looked at, a producer that puts after the look sets the bit after the clear
+ */
+static void _clearReady(fifo_prio_t *pPrio, size_t lane)
+{
+    uint32_t bit = (uint32_t)1 << lane;
+    __atomic_fetch_and(&pPrio->ready, ~bit, __ATOMIC_SEQ_CST);
+    if (fifo_hasElementsLeft(pPrio->pLane[lane]))
+    {
+        __atomic_fetch_or(&pPrio->ready, bit, __ATOMIC_SEQ_CST);
+    }
+}
+
+/**
+ * @brief initializes a priority fifo with lanes that were initialized before, they may already hold elements
+ * @note If _DEBUG is defined every Parameter will be checked with assert()
+ * @param pPrio pointer to the priority fifo handle
+ * @param pLanes array of lanes handles, index 0 = highest priority
+ * @param lanes number of lanes, 1 to FIFO_PRIO_MAX_LANES
+ * @retval 0 = success
+ * @retval -1 = NULL Pointer as Parameter
+ * @retval -2 = invalid number of lanes
+ */
+int8_t fifo_prio_init(fifo_prio_t *pPrio, fifo_handle_t *const pLanes[], size_t lanes)
+{
+#ifdef _DEBUG
+    assert(pPrio != NULL);
+    assert(pLanes != NULL);
+    assert(lanes > 0 && lanes <= FIFO_PRIO_MAX_LANES);
+#endif
+    // *** Checking Parameters ***
+    if (pPrio == NULL || pLanes == NULL)
+        return -1;
+    if (lanes == 0 || lanes > FIFO_PRIO_MAX_LANES)
+        return -2;
+    for (size_t i = 0; i < lanes; i++)
+    {
+        if (pLanes[i] == NULL)
+            return -1;
+    }
+
+    // *** Initialize Handle ***
+    pPrio->lanes = lanes;
+    pPrio->ready = 0;
+    for (size_t i = 0; i < lanes; i++)
+    {
+        pPrio->pLane[i] = pLanes[i];
+        if (fifo_hasElementsLeft(pLanes[i]))
+        {
+            pPrio->ready |= (uint32_t)1 << i;
+        }
+    }
+    return 0;
+}
+
+#if FIFO_ALLOW_MALLOC
+/**
+ * @brief allocates a priority fifo and its lanes, and initializes it
+ * @note memory has to be freed with fifo_prio_deinit_free()
+ * @param lanes number of lanes, 1 to FIFO_PRIO_MAX_LANES
+ * @param size_fifo size of every lane in elements
+ * @param basetype_size size of the fifo basetype eg: sizeof(uint8_t)
+ * @retval NULL = failed
+ * @return pointer to the priority fifo handle
+ */
+fifo_prio_t* fifo_prio_init_malloc(size_t lanes, FIFO_INDEX_TYPE size_fifo, SIZE_FIFO_BASE_TYPE basetype_size)
+{
+    // *** Checking Parameters ***
+    if (lanes == 0 || lanes > FIFO_PRIO_MAX_LANES)
+        return NULL;
+
+    // *** Allocate Handle ***
+    fifo_prio_t *pPrio = (fifo_prio_t *)malloc(sizeof(*pPrio));
+    if (pPrio == NULL)
+        return NULL;
+
+    // *** Allocate Lanes ***
+    fifo_handle_t *pLanes[FIFO_PRIO_MAX_LANES];
+    size_t allocated = 0;
+    while (allocated < lanes && (pLanes[allocated] = fifo_init_malloc(size_fifo, basetype_size)) != NULL)
+    {
+        allocated++;
+    }
+    if (allocated != lanes || fifo_prio_init(pPrio, pLanes, lanes) != 0)
+    {
+        while (allocated > 0)
+        {
+            fifo_deinit_free(pLanes[--allocated]);     // therefore free previously allocated memory
+        }
+        free(pPrio);
+        pPrio = NULL;
+    }
+    return pPrio;
+}
+
+/**
+ * @brief deallocates a priority fifo from fifo_prio_init_malloc() and its lanes
+ * @param pPrio pointer to the priority fifo handle
+ */
+void fifo_prio_deinit_free(fifo_prio_t *pPrio)
+{
+    if (pPrio != NULL)
+    {
+        for (size_t i = 0; i < pPrio->lanes; i++)
+        {
+            fifo_deinit_free(pPrio->pLane[i]);
+        }
+        free(pPrio);
+    }
+}
+#endif  /* FIFO_ALLOW_MALLOC */
+
+/**
+ * @brief puts an element into the lane of the priority
+ * @param pPrio pointer to the priority fifo handle
+ * @param priority lane of the element, 0 = highest priority
+ * @param [in] pData pointer to the data to be put onto the fifo
+ * @return fifoerror_t
+ */
+fifoerror_t fifo_prio_put(fifo_prio_t *pPrio, size_t priority, const void *pData)
+{
+#ifdef _DEBUG
+    assert(pPrio != NULL);
+    assert(priority < pPrio->lanes);
+    assert(pData != NULL);
+#endif
+    // *** Checking Parameters ***
+    if (pPrio == NULL || priority >= pPrio->lanes)
+        return FIFO_WRONG_PARAM;
+
+    fifoerror_t ret = fifo_put(pPrio->pLane[priority], pData);
+    if (ret == FIFO_NO_ERROR)
+    {
+        // *** Mark the lane as ready, the bitmap is only written when the bit is not set yet ***
+        uint32_t bit = (uint32_t)1 << priority;
+        __atomic_thread_fence(__ATOMIC_SEQ_CST);    // the put is visible before the bit is looked at, see _clearReady()
+        if ((__atomic_load_n(&pPrio->ready, __ATOMIC_RELAXED) & bit) == 0)
+        {
+            __atomic_fetch_or(&pPrio->ready, bit, __ATOMIC_SEQ_CST);
+        }
+    }
+    return ret;
+}
+
+/**
+ * @brief gets the oldest element of the highest priority lane with elements
+ * @param pPrio pointer to the priority fifo handle
+ * @param [out] pData pointer to the storage for the data from the fifo
+ * @param [out] pPriority lane the element was taken from, may be NULL
+ * @return fifoerror_t
+ */
+fifoerror_t fifo_prio_get(fifo_prio_t *pPrio, void *pData, size_t *pPriority)
+{
+#ifdef _DEBUG
+    assert(pPrio != NULL);
+    assert(pData != NULL);
+#endif
+    // *** Checking Parameters ***
+    if (pPrio == NULL || pData == NULL)
+        return FIFO_WRONG_PARAM;
+
+    uint32_t ready = __atomic_load_n(&pPrio->ready, __ATOMIC_ACQUIRE);
+    while (ready != 0)
+    {
+        size_t lane = (size_t)__builtin_ctz(ready);     // highest priority lane with elements
+        fifoerror_t ret = fifo_get(pPrio->pLane[lane], pData);
+        if (ret != FIFO_EMPTY)
+        {
+            if (ret == FIFO_NO_ERROR)
+            {
+                if (!fifo_hasElementsLeft(pPrio->pLane[lane]))
+                {
+                    _clearReady(pPrio, lane);
+                }
+                if (pPriority != NULL)
+                {
+                    *pPriority = lane;
+                }
+            }
+            return ret;
+        }
+        _clearReady(pPrio, lane);   // the bit was set by a put whose element was taken before
+        ready = __atomic_load_n(&pPrio->ready, __ATOMIC_ACQUIRE);
+    }
+    return FIFO_EMPTY;
+}
+
+/**
+ * @brief returns the number of elements in all lanes
+ * @param pPrio pointer to the priority fifo handle
+ * @retval fill level in elements
+ */
+size_t fifo_prio_getLevel(fifo_prio_t *pPrio)
+{
+#ifdef _DEBUG
+    assert(pPrio != NULL);
+#endif
+    if (pPrio == NULL)
+    {
+        return 0;
+    }
+    size_t level = 0;
+    for (size_t i = 0; i < pPrio->lanes; i++)
+    {
+        level += fifo_getLevel(pPrio->pLane[i]);
+    }
+    return level;
+}
@@ -0,0 +1,102 @@
+/**
+ * @file fifo_prio.h
+ * @brief priority fifo made of up to FIFO_PRIO_MAX_LANES lanes of fifo_handle_t
+ * Lane 0 has the highest priority. Every lane has a bit in the ready bitmap which is set by fifo_prio_put() after
+ * an element was put into the lane. fifo_prio_get() finds the highest priority lane with elements by one bit scan of
+ * the bitmap, so the empty lanes are not looked at. A bit is only cleared by the consumer, and it looks at the
+ * lane again after clearing, so an element is never left behind in a lane with a cleared bit.
+ * Elements of the same lane keep their order, an element of a lane with a higher priority overtakes them.
+ * @note every lane keeps the rules of fifo_handle_t, one producer and one consumer thread at the same time with FIFO_SPSC
+ * @author Josef Aschwanden
+ * @date Oct - 2026
+ * @version 1.0
+ */
+
+#ifndef _FIFO_PRIO_H_
+#define _FIFO_PRIO_H_
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// *** INCLUDES ***
+#include <stddef.h>
+#include "fifo.h"
+
+// *** DEFINES ***
+/**
+ * @brief maximum number of lanes, one bit of the ready bitmap per lane
+ */
+#define FIFO_PRIO_MAX_LANES     32
+
+// *** TYPEDEF ***
+/**
+ * @brief this structure is used as handle for the priority fifo
+ */
+typedef struct{
+    size_t lanes;                                   /*!< number of lanes */
+    uint32_t ready;                                 /*!< bit i is set when lane i may have elements */
+    fifo_handle_t *pLane[FIFO_PRIO_MAX_LANES];      /*!< lanes, index 0 = highest priority */
+}fifo_prio_t;
+
+/**
+ * @brief initializes a priority fifo with lanes that were initialized before, they may already hold elements
+ * @note If _DEBUG is defined every Parameter will be checked with assert()
+ * @param pPrio pointer to the priority fifo handle
+ * @param pLanes array of lanes handles, index 0 = highest priority
+ * @param lanes number of lanes, 1 to FIFO_PRIO_MAX_LANES
+ * @retval 0 = success
+ * @retval -1 = NULL Pointer as Parameter
+ * @retval -2 = invalid number of lanes
+ */
+int8_t fifo_prio_init(fifo_prio_t *pPrio, fifo_handle_t *const pLanes[], size_t lanes);
+
+#if FIFO_ALLOW_MALLOC
+/**
+ * @brief allocates a priority fifo and its lanes, and initializes it
+ * @note memory has to be freed with fifo_prio_deinit_free()
+ * @param lanes number of lanes, 1 to FIFO_PRIO_MAX_LANES
+ * @param size_fifo size of every lane in elements
+ * @param basetype_size size of the fifo basetype eg: sizeof(uint8_t)
+ * @retval NULL = failed
+ * @return pointer to the priority fifo handle
+ */
+fifo_prio_t* fifo_prio_init_malloc(size_t lanes, FIFO_INDEX_TYPE size_fifo, SIZE_FIFO_BASE_TYPE basetype_size);
+
+/**
+ * @brief deallocates a priority fifo from fifo_prio_init_malloc() and its lanes
+ * @param pPrio pointer to the priority fifo handle
+ */
+void fifo_prio_deinit_free(fifo_prio_t *pPrio);
+#endif  /* FIFO_ALLOW_MALLOC */
+
+/**
+ * @brief puts an element into the lane of the priority
+ * @param pPrio pointer to the priority fifo handle
+ * @param priority lane of the element, 0 = highest priority
+ * @param [in] pData pointer to the data to be put onto the fifo
+ * @return fifoerror_t
+ */
+fifoerror_t fifo_prio_put(fifo_prio_t *pPrio, size_t priority, const void *pData);
+
+/**
+ * @brief gets the oldest element of the highest priority lane with elements
+ * @param pPrio pointer to the priority fifo handle
+ * @param [out] pData pointer to the storage for the data from the fifo
+ * @param [out] pPriority lane the element was taken from, may be NULL
+ * @return fifoerror_t
+ */
+fifoerror_t fifo_prio_get(fifo_prio_t *pPrio, void *pData, size_t *pPriority);
+
+/**
+ * @brief returns the number of elements in all lanes
+ * @param pPrio pointer to the priority fifo handle
+ * @retval fill level in elements
+ */
+size_t fifo_prio_getLevel(fifo_prio_t *pPrio);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif  // _FIFO_PRIO_H_
@@ -0,0 +1,255 @@
+// *** INCLUDES ***
+#include "fifo_set.h"
+#if FIFO_NOTIFY
+#include <errno.h>
+#include <limits.h>
+#include <stdlib.h> // calloc, free
+#include <time.h>
+#include <linux/futex.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#ifdef _DEBUG
+    #include <assert.h>
+#endif
+
+// *** DEFINES ***
+#define _WORD(idx)  ((idx) / 64)
+#define _BIT(idx)   ((uint64_t)1 << ((idx) % 64))
+
+// *** STATIC FUNCTIONS ***
+/**
+ * @brief notify callback of every fifo in a set, sets the ready bit of the fifo and wakes the waiting thread
+ * @note runs in the thread of the producer, the bitmap is only written when the bit is not set yet
+ */
+static void _markReady(void *pCtx)
+{
+    fifo_set_member_t *pMember = (fifo_set_member_t *)pCtx;
+    fifo_set_t *pSet = pMember->pSet;
+    uint64_t *pWord = &pSet->pReady[_WORD(pMember->idx)];
+    if ((__atomic_load_n(pWord, __ATOMIC_RELAXED) & _BIT(pMember->idx)) == 0
+        && (__atomic_fetch_or(pWord, _BIT(pMember->idx), __ATOMIC_SEQ_CST) & _BIT(pMember->idx)) == 0)
+    {
+        // the waiter registers in _waiters before it looks at the bitmap a last time, see fifo_set_wait()
+        __atomic_thread_fence(__ATOMIC_SEQ_CST);
+        if (__atomic_load_n(&pSet->_waiters, __ATOMIC_RELAXED) != 0)
+        {
+            __atomic_fetch_add(&pSet->_seq, 1, __ATOMIC_RELEASE);
+            syscall(SYS_futex, &pSet->_seq, FUTEX_WAKE_PRIVATE, INT_MAX, NULL, NULL, 0);
+        }
+    }
+}
+
+/**
+ * @brief collects the fifos with elements, only the fifos with a set bit are looked at
+ * A fifo that was found empty gets its bit cleared, then it is looked at again: a put in between has seen the
+ * fifo non-empty and did not call the notify callback, so the bit is set again.
+ * @return number of fifos in ready
+ */
+static size_t _collect(fifo_set_t *pSet, fifo_handle_t *ready[], size_t max)
+{
+    size_t count = 0;
+    for (size_t w = 0; w < pSet->words && count < max; w++)
+    {
+        uint64_t bits = __atomic_load_n(&pSet->pReady[w], __ATOMIC_ACQUIRE);
+        while (bits != 0 && count < max)
+        {
+            size_t idx = w * 64 + (size_t)__builtin_ctzll(bits);
+            bits &= bits -1;
+            fifo_handle_t *pFifo = pSet->pMember[idx].pFifo;
+            if (pFifo != NULL && fifo_hasElementsLeft(pFifo))
+            {
+                ready[count++] = pFifo;
+                continue;
+            }
+            __atomic_fetch_and(&pSet->pReady[w], ~_BIT(idx), __ATOMIC_SEQ_CST);
+            if (pFifo != NULL && fifo_hasElementsLeft(pFifo))
+            {
+                __atomic_fetch_or(&pSet->pReady[w], _BIT(idx), __ATOMIC_SEQ_CST);
+                ready[count++] = pFifo;
+            }
+        }
+    }
+    return count;
+}
+
+/**
+ * @brief allocates and initializes an empty fifo set
+ * @note memory has to be freed with fifo_set_deinit_free()
+ * @param capacity maximum number of fifos in the set
+ * @retval NULL = failed
+ * @return pointer to the set handle
+ */
+fifo_set_t* fifo_set_init_malloc(size_t capacity)
+{
+    // *** Checking Parameters ***
+    if (capacity == 0 || capacity > SIZE_MAX / sizeof(fifo_set_member_t))
+        return NULL;
+
+    // *** Allocate Handle, Bitmap and Members ***
+    fifo_set_t *pSet = (fifo_set_t *)malloc(sizeof(*pSet));
+    if (pSet == NULL)
+        return NULL;
+    pSet->capacity = capacity;
+    pSet->words = (capacity + 63) / 64;
+    pSet->pReady = (uint64_t *)calloc(pSet->words, sizeof(uint64_t));
+    pSet->pMember = (fifo_set_member_t *)calloc(capacity, sizeof(fifo_set_member_t));
+    if (pSet->pReady == NULL || pSet->pMember == NULL)
+    {
+        free(pSet->pReady);
+        free(pSet->pMember);     // therefore free previously allocated memory
+        free(pSet);
+        return NULL;
+    }
+    for (size_t i = 0; i < capacity; i++)
+    {
+        pSet->pMember[i].pSet = pSet;
+        pSet->pMember[i].idx = i;
+    }
+    pSet->_seq = 0;
+    pSet->_waiters = 0;
+    return pSet;
+}
+
+/**
+ * @brief removes all fifos from the set and deallocates it, the fifos are not freed
+ * @note the producers of all fifos have to be stopped first: a put that loaded the notify callback before it was
+ * cleared still calls it with its member of the set, which is freed by then
+ * @param pSet pointer to the set handle
+ */
+void fifo_set_deinit_free(fifo_set_t *pSet)
+{
+    if (pSet != NULL)
+    {
+        for (size_t i = 0; i < pSet->capacity; i++)
+        {
+            fifo_set_remove(pSet, i);
+        }
+        free(pSet->pReady);
+        free(pSet->pMember);
+        free(pSet);
+    }
+}
+
+/**
+ * @brief adds a fifo to the set, a fifo that already holds elements is ready right away
+ * @note the notify callback of the fifo is taken by the set, see fifo_setNotify()
+ * @param pSet pointer to the set handle
+ * @param pFifo pointer to the fifo handle
+ * @param [out] pIdx number of the fifo in the set, may be NULL
+ * @retval FIFO_FULL        the set has no free slot
+ * @return fifoerror_t
+ */
+fifoerror_t fifo_set_add(fifo_set_t *pSet, fifo_handle_t *pFifo, size_t *pIdx)
+{
+#ifdef _DEBUG
+    assert(pSet != NULL);
+    assert(pFifo != NULL);
+#endif
+    // *** Checking Parameters ***
+    if (pSet == NULL || pFifo == NULL)
+        return FIFO_WRONG_PARAM;
+
+    // *** Find a free slot ***
+    size_t idx = 0;
+    while (idx < pSet->capacity && pSet->pMember[idx].pFifo != NULL)
+    {
+        idx++;
+    }
+    if (idx == pSet->capacity)
+        return FIFO_FULL;
+
+    pSet->pMember[idx].pFifo = pFifo;
+    fifo_setNotify(pFifo, _markReady, &pSet->pMember[idx]);
+    if (fifo_hasElementsLeft(pFifo))     // elements put before the callback was set
+    {
+        _markReady(&pSet->pMember[idx]);
+    }
+    if (pIdx != NULL)
+    {
+        *pIdx = idx;
+    }
+    return FIFO_NO_ERROR;
+}
+
+/**
+ * @brief removes a fifo from the set and clears its notify callback
+ * @note the producer of the fifo has to be stopped first: a put that loaded the notify callback before it was
+ * cleared still calls it with the member of the set, which may be freed or taken by another fifo by then
+ * @param pSet pointer to the set handle
+ * @param idx number of the fifo in the set
+ * @return fifoerror_t
+ */
+fifoerror_t fifo_set_remove(fifo_set_t *pSet, size_t idx)
+{
+#ifdef _DEBUG
+    assert(pSet != NULL);
+    assert(idx < pSet->capacity);
+#endif
+    if (pSet == NULL || idx >= pSet->capacity)
+    {
+        return FIFO_WRONG_PARAM;
+    }
+    if (pSet->pMember[idx].pFifo != NULL)
+    {
+        fifo_setNotify(pSet->pMember[idx].pFifo, NULL, NULL);
+        pSet->pMember[idx].pFifo = NULL;
+        __atomic_fetch_and(&pSet->pReady[_WORD(idx)], ~_BIT(idx), __ATOMIC_RELAXED);
+    }
+    return FIFO_NO_ERROR;
+}
+
+/**
+ * @brief returns the fifos of the set with elements, waits up to timeout_ms until there is one
+ * @param pSet pointer to the set handle
+ * @param timeout_ms maximum time to wait in ms, 0 = do not wait, negative = wait forever
+ * @param [out] ready fifos with elements, lowest number first
+ * @param max size of ready
+ * @retval 0 = timeout, no fifo has elements
+ * @return number of fifos in ready
+ */
+size_t fifo_set_wait(fifo_set_t *pSet, int32_t timeout_ms, fifo_handle_t *ready[], size_t max)
+{
+#ifdef _DEBUG
+    assert(pSet != NULL);
+    assert(ready != NULL);
+#endif
+    if (pSet == NULL || ready == NULL || max == 0)
+    {
+        return 0;
+    }
+    size_t count = _collect(pSet, ready, max);
+    if (count > 0 || timeout_ms == 0)
+        return count;
+
+    // *** Absolute deadline, the wait may be woken several times ***
+    struct timespec deadline, *pDeadline = NULL;
+    if (timeout_ms > 0)
+    {
+        clock_gettime(CLOCK_MONOTONIC, &deadline);
+        deadline.tv_sec += timeout_ms / 1000;
+        deadline.tv_nsec += (long)(timeout_ms % 1000) * 1000000L;
+        if (deadline.tv_nsec >= 1000000000L)
+        {
+            deadline.tv_sec++;
+            deadline.tv_nsec -= 1000000000L;
+        }
+        pDeadline = &deadline;
+    }
+
+    // *** Register as waiter, look a last time, then park ***
+    bool expired = false;
+    while (count == 0 && !expired)
+    {
+        __atomic_store_n(&pSet->_waiters, 1, __ATOMIC_SEQ_CST);
+        uint32_t seq = __atomic_load_n(&pSet->_seq, __ATOMIC_ACQUIRE);
+        count = _collect(pSet, ready, max);
+        if (count == 0)
+        {
+            long ret = syscall(SYS_futex, &pSet->_seq, FUTEX_WAIT_BITSET_PRIVATE, seq, pDeadline, NULL, FUTEX_BITSET_MATCH_ANY);
+            expired = (ret == -1 && errno == ETIMEDOUT);
+        }
+        __atomic_store_n(&pSet->_waiters, 0, __ATOMIC_RELAXED);
+    }
+    return (count == 0) ? _collect(pSet, ready, max) : count;
+}
+#endif  /* FIFO_NOTIFY */
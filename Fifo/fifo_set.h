@@ -0,0 +1,106 @@
+/**
+ * @file fifo_set.h
+ * @brief readiness multiplexer over many fifo_handle_t, like poll() for fifos (Linux only, needs FIFO_NOTIFY)
+ * A fifo added to a set gets a notify callback (fifo_setNotify()) that sets its bit in the ready bitmap of the set
+ * when a put makes it non-empty, and wakes the thread parked in fifo_set_wait(). fifo_set_wait() only looks at the
+ * fifos with a set bit, so its cost depends on the number of fifos with elements, not on the number of fifos in the set.
+ * A fifo is returned by every fifo_set_wait() as long as it has elements, its bit is cleared when it was found empty.
+ * @note any number of producers may put into the fifos of a set, one thread calls fifo_set_wait()
+ * @author Josef Aschwanden
+ * @date Oct - 2026
+ * @version 1.0
+ */
+
+#ifndef _FIFO_SET_H_
+#define _FIFO_SET_H_
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// *** INCLUDES ***
+#include <stddef.h>
+#include "fifo.h"
+
+#if FIFO_NOTIFY
+
+// *** TYPEDEF ***
+struct fifo_set;
+
+/**
+ * @brief one fifo of a set, the context pointer of its notify callback
+ */
+typedef struct{
+    struct fifo_set *pSet;                  /*!< set the fifo belongs to */
+    size_t idx;                             /*!< bit of the fifo in the ready bitmap */
+    fifo_handle_t *pFifo;                   /*!< the fifo, NULL = slot is free */
+}fifo_set_member_t;
+
+/**
+ * @brief this structure is used as handle for a fifo set
+ */
+typedef struct fifo_set{
+    size_t capacity;                        /*!< maximum number of fifos */
+    size_t words;                           /*!< number of 64 bit words of the ready bitmap */
+    uint64_t *pReady;                       /*!< bit idx is set when fifo idx may have elements */
+    fifo_set_member_t *pMember;             /*!< capacity fifos */
+    uint32_t _seq;                          /*!< futex word, changes when a bit is set while _waiters != 0 */
+    uint32_t _waiters;                      /*!< 1 while a thread is parked in fifo_set_wait() */
+}fifo_set_t;
+
+/**
+ * @brief allocates and initializes an empty fifo set
+ * @note memory has to be freed with fifo_set_deinit_free()
+ * @param capacity maximum number of fifos in the set
+ * @retval NULL = failed
+ * @return pointer to the set handle
+ */
+fifo_set_t* fifo_set_init_malloc(size_t capacity);
+
+/**
+ * @brief removes all fifos from the set and deallocates it, the fifos are not freed
+ * @note the producers of all fifos have to be stopped first: a put that loaded the notify callback before it was
+ * cleared still calls it with its member of the set, which is freed by then
+ * @param pSet pointer to the set handle
+ */
+void fifo_set_deinit_free(fifo_set_t *pSet);
+
+/**
+ * @brief adds a fifo to the set, a fifo that already holds elements is ready right away
+ * @note the notify callback of the fifo is taken by the set, see fifo_setNotify()
+ * @param pSet pointer to the set handle
+ * @param pFifo pointer to the fifo handle
+ * @param [out] pIdx number of the fifo in the set, may be NULL
+ * @retval FIFO_FULL        the set has no free slot
+ * @return fifoerror_t
+ */
+fifoerror_t fifo_set_add(fifo_set_t *pSet, fifo_handle_t *pFifo, size_t *pIdx);
+
+/**
+ * @brief removes a fifo from the set and clears its notify callback
+ * @note the producer of the fifo has to be stopped first: a put that loaded the notify callback before it was
+ * cleared still calls it with the member of the set, which may be freed or taken by another fifo by then
+ * @param pSet pointer to the set handle
+ * @param idx number of the fifo in the set
+ * @return fifoerror_t
+ */
+fifoerror_t fifo_set_remove(fifo_set_t *pSet, size_t idx);
+
+/**
+ * @brief returns the fifos of the set with elements, waits up to timeout_ms until there is one
+ * @param pSet pointer to the set handle
+ * @param timeout_ms maximum time to wait in ms, 0 = do not wait, negative = wait forever
+ * @param [out] ready fifos with elements, lowest number first
+ * @param max size of ready
+ * @retval 0 = timeout, no fifo has elements
+ * @return number of fifos in ready
+ */
+size_t fifo_set_wait(fifo_set_t *pSet, int32_t timeout_ms, fifo_handle_t *ready[], size_t max);
+
+#endif  /* FIFO_NOTIFY */
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif  // _FIFO_SET_H_
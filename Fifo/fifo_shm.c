@@ -0,0 +1,363 @@
+// *** INCLUDES ***
+#include "fifo_shm.h"
+#include <string.h> // memcpy
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#ifdef _DEBUG
+    #include <assert.h>
+#endif
+
+// *** DEFINES ***
+#define _DATA_OFFSET    ((sizeof(fifo_shm_header_t) + FIFO_CACHE_LINE_SIZE -1) / FIFO_CACHE_LINE_SIZE * FIFO_CACHE_LINE_SIZE)
+
+// *** STATIC FUNCTIONS ***
+/**
+ * @brief copies n elements into the fifo, the first element goes to position pos
+ * @note at most two memcpy calls are made, one up to the end of the fifo memory and one from its start
+ */
+static void _copyToFifo(fifo_shm_t *pShm, uint64_t pos, const void *pData, size_t n)
+{
+    size_t basetype_size = pShm->basetype_size;
+    size_t first = (size_t)(pos & pShm->mask) * basetype_size, bytes = n * basetype_size;
+    size_t contiguous = (size_t)(pShm->mask +1) * basetype_size - first;
+    if (bytes <= contiguous)
+    {
+        memcpy(pShm->pData + first, pData, bytes);
+    }
+    else    // wraps around
+    {
+        memcpy(pShm->pData + first, pData, contiguous);
+        memcpy(pShm->pData, (const uint8_t *)pData + contiguous, bytes - contiguous);
+    }
+}
+
+/**
+ * @brief copies n elements out of the fifo, the first element is at position pos
+ * @note at most two memcpy calls are made, one up to the end of the fifo memory and one from its start
+ */
+static void _copyFromFifo(fifo_shm_t *pShm, uint64_t pos, void *pData, size_t n)
+{
+    size_t basetype_size = pShm->basetype_size;
+    size_t first = (size_t)(pos & pShm->mask) * basetype_size, bytes = n * basetype_size;
+    size_t contiguous = (size_t)(pShm->mask +1) * basetype_size - first;
+    if (bytes <= contiguous)
+    {
+        memcpy(pData, pShm->pData + first, bytes);
+    }
+    else    // wraps around
+    {
+        memcpy(pData, pShm->pData + first, contiguous);
+        memcpy((uint8_t *)pData + contiguous, pShm->pData, bytes - contiguous);
+    }
+}
+
+/**
+ * @brief checks a header against the size of its segment
+ * @retval true = the header describes a valid fifo
+ */
+static bool _isValid(const fifo_shm_header_t *pHeader, size_t segment_size)
+{
+    if (__atomic_load_n(&pHeader->magic, __ATOMIC_ACQUIRE) != FIFO_SHM_MAGIC || pHeader->version != FIFO_SHM_VERSION)
+        return false;
+    if (pHeader->segment_size != segment_size)
+        return false;
+    if (pHeader->basetype_size == 0 || pHeader->basetype_size > FIFO_MAX_BASETYPE_SIZE)
+        return false;
+    if (pHeader->data_offset < sizeof(fifo_shm_header_t) || pHeader->data_offset > segment_size)
+        return false;
+
+    uint64_t capacity = pHeader->mask +1;
+    if (capacity < 2 || (capacity & pHeader->mask) != 0)
+        return false;
+    if (capacity != (segment_size - pHeader->data_offset) / pHeader->basetype_size
+        || (segment_size - pHeader->data_offset) % pHeader->basetype_size != 0)
+        return false;
+
+    uint64_t read_pos = __atomic_load_n(&pHeader->read_pos, __ATOMIC_ACQUIRE);
+    if (__atomic_load_n(&pHeader->write_pos, __ATOMIC_ACQUIRE) - read_pos > capacity)
+        return false;
+    return true;
+}
+
+/**
+ * @brief creates a shared memory segment and initializes a fifo in it
+ * @param [out] pShm handle of this process
+ * @param name name of the segment, eg: "/my_fifo", see shm_open()
+ * @param size_fifo size of the fifo in elements, must be a power of two
+ * @param basetype_size size of the fifo basetype eg: sizeof(uint8_t)
+ * @retval 0 = success
+ * @retval -1 = NULL Pointer as Parameter
+ * @retval -2 = invalid fifo size
+ * @retval -3 = invalid basetype_size
+ * @retval -6 = the segment exists already or could not be created / mapped
+ */
+int8_t fifo_shm_create(fifo_shm_t *pShm, const char *name, size_t size_fifo, SIZE_FIFO_BASE_TYPE basetype_size)
+{
+#ifdef _DEBUG
+    assert(pShm != NULL);
+    assert(name != NULL);
+    assert(basetype_size > 0 && basetype_size <= FIFO_MAX_BASETYPE_SIZE);
+#endif
+
+    // *** Checking Parameters ***
+    if (pShm == NULL || name == NULL)
+        return -1;
+    if (size_fifo < 2 || (size_fifo & (size_fifo -1)) != 0 || size_fifo > (SIZE_MAX - _DATA_OFFSET) / FIFO_MAX_BASETYPE_SIZE)
+        return -2;
+    if (basetype_size == 0 || basetype_size > FIFO_MAX_BASETYPE_SIZE)
+        return -3;
+
+    // *** Create and map the segment ***
+    size_t segment_size = _DATA_OFFSET + size_fifo * basetype_size;
+    int fd = shm_open(name, O_RDWR | O_CREAT | O_EXCL, 0600);
+    if (fd < 0)
+        return -6;
+    void *pMap = MAP_FAILED;
+    if (ftruncate(fd, segment_size) == 0)       // new memory is zeroed, magic stays 0 until the header is complete
+    {
+        pMap = mmap(NULL, segment_size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    }
+    close(fd);      // the mapping keeps the segment
+    if (pMap == MAP_FAILED)
+    {
+        shm_unlink(name);
+        return -6;
+    }
+
+    // *** Initialize Header, magic is written last ***
+    fifo_shm_header_t *pHeader = pMap;
+    pHeader->version = FIFO_SHM_VERSION;
+    pHeader->segment_size = segment_size;
+    pHeader->data_offset = _DATA_OFFSET;
+    pHeader->mask = size_fifo -1;
+    pHeader->basetype_size = basetype_size;
+    pHeader->write_pos = 0;
+    pHeader->read_pos = 0;
+    __atomic_store_n(&pHeader->magic, FIFO_SHM_MAGIC, __ATOMIC_RELEASE);
+
+    // *** Initialize Handle ***
+    pShm->pHeader = pHeader;
+    pShm->pData = (uint8_t *)pMap + pHeader->data_offset;
+    pShm->map_size = segment_size;
+    pShm->mask = size_fifo -1;
+    pShm->basetype_size = basetype_size;
+    return 0;
+}
+
+/**
+ * @brief attaches to a fifo created by fifo_shm_create(), maybe in another process
+ * The header is checked against the size of the segment, so a segment of a crashed creator or of a different
+ * version is refused.
+ * @param [out] pShm handle of this process
+ * @param name name of the segment, see shm_open()
+ * @retval 0 = success
+ * @retval -1 = NULL Pointer as Parameter
+ * @retval -6 = the segment does not exist or could not be mapped
+ * @retval -7 = invalid header
+ */
+int8_t fifo_shm_attach(fifo_shm_t *pShm, const char *name)
+{
+#ifdef _DEBUG
+    assert(pShm != NULL);
+    assert(name != NULL);
+#endif
+
+    // *** Checking Parameters ***
+    if (pShm == NULL || name == NULL)
+        return -1;
+
+    // *** Map the whole segment ***
+    struct stat st;
+    int fd = shm_open(name, O_RDWR, 0);
+    if (fd < 0)
+        return -6;
+    if (fstat(fd, &st) != 0)
+    {
+        close(fd);
+        return -6;
+    }
+    if ((size_t)st.st_size < sizeof(fifo_shm_header_t))     // creator crashed before the segment got its size
+    {
+        close(fd);
+        return -7;
+    }
+    void *pMap = mmap(NULL, st.st_size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    close(fd);
+    if (pMap == MAP_FAILED)
+        return -6;
+
+    // *** Validate the header ***
+    if (!_isValid(pMap, st.st_size))
+    {
+        munmap(pMap, st.st_size);
+        return -7;
+    }
+
+    // *** Initialize Handle ***
+    pShm->pHeader = pMap;
+    pShm->pData = (uint8_t *)pMap + pShm->pHeader->data_offset;
+    pShm->map_size = st.st_size;
+    pShm->mask = pShm->pHeader->mask;
+    pShm->basetype_size = pShm->pHeader->basetype_size;
+    return 0;
+}
+
+/**
+ * @brief unmaps the segment from this process, the fifo stays in the segment
+ * @param pShm handle of this process
+ */
+void fifo_shm_detach(fifo_shm_t *pShm)
+{
+#ifdef _DEBUG
+    assert(pShm != NULL);
+#endif
+    if (pShm != NULL && pShm->pHeader != NULL)
+    {
+        munmap(pShm->pHeader, pShm->map_size);
+        pShm->pHeader = NULL;
+        pShm->pData = NULL;
+        pShm->map_size = 0;
+        pShm->mask = 0;
+        pShm->basetype_size = 0;
+    }
+}
+
+/**
+ * @brief removes the name of the segment, it gets freed after the last process detached
+ * @param name name of the segment, see shm_open()
+ * @retval 0 = success
+ * @retval -1 = failed
+ */
+int8_t fifo_shm_unlink(const char *name)
+{
+    if (name == NULL || shm_unlink(name) != 0)
+        return -1;
+    return 0;
+}
+
+/**
+ * @brief puts an element into the fifo, only called by the producer
+ * @param pShm handle of this process
+ * @param [in] pData pointer to the data to be put onto the fifo
+ * @return fifoerror_t
+ */
+fifoerror_t fifo_shm_put(fifo_shm_t *pShm, const void *pData)
+{
+    return fifo_shm_put_n(pShm, pData, 1, NULL);
+}
+
+/**
+ * @brief gets an element from the fifo, only called by the consumer
+ * @param pShm handle of this process
+ * @param [out] pData pointer to the storage for the data from the fifo
+ * @return fifoerror_t
+ */
+fifoerror_t fifo_shm_get(fifo_shm_t *pShm, void *pData)
+{
+    return fifo_shm_get_n(pShm, pData, 1, NULL);
+}
+
+/**
+ * @brief puts up to n elements into the fifo with one update of write_pos, only called by the producer
+ * @param pShm handle of this process
+ * @param [in] pData pointer to the n elements to be put onto the fifo
+ * @param n ammount of elements
+ * @param [out] pWritten number of elements put onto the fifo, may be NULL
+ * @retval FIFO_NO_ERROR    all n elements were put onto the fifo
+ * @retval FIFO_FULL        only *pWritten elements fitted into the fifo
+ * @retval FIFO_WRONG_PARAM NULL pointer or corrupt segment, read_pos / write_pos are more than the capacity apart
+ * @return fifoerror_t
+ */
+fifoerror_t fifo_shm_put_n(fifo_shm_t *pShm, const void *pData, size_t n, size_t *pWritten)
+{
+#ifdef _DEBUG
+    assert(pShm != NULL && pShm->pHeader != NULL);
+    assert(pData != NULL || n == 0);
+#endif
+    // *** Checking Parameters ***
+    if (pShm == NULL || pShm->pHeader == NULL || (pData == NULL && n != 0))
+        return FIFO_WRONG_PARAM;
+
+    fifo_shm_header_t *pHeader = pShm->pHeader;
+    uint64_t write_pos = pHeader->write_pos;
+    uint64_t used = write_pos - __atomic_load_n(&pHeader->read_pos, __ATOMIC_ACQUIRE);
+    if (used > pShm->mask +1)       // corrupt segment, the copy would leave the mapping
+        return FIFO_WRONG_PARAM;
+    uint64_t space = pShm->mask +1 - used;
+    size_t written = (n > space) ? space : n;
+
+    // *** Write to the fifo, then publish all elements at once ***
+    if (written > 0)
+    {
+        _copyToFifo(pShm, write_pos, pData, written);
+        __atomic_store_n(&pHeader->write_pos, write_pos + written, __ATOMIC_RELEASE);
+    }
+    if (pWritten != NULL)
+    {
+        *pWritten = written;
+    }
+    return (written == n) ? FIFO_NO_ERROR : FIFO_FULL;
+}
+
+/**
+ * @brief gets up to n elements from the fifo with one update of read_pos, only called by the consumer
+ * @param pShm handle of this process
+ * @param [out] pData pointer to the storage for n elements
+ * @param n ammount of elements
+ * @param [out] pRead number of elements read from the fifo, may be NULL
+ * @retval FIFO_NO_ERROR    all n elements were read
+ * @retval FIFO_EMPTY       only *pRead elements were in the fifo
+ * @retval FIFO_WRONG_PARAM NULL pointer or corrupt segment, read_pos / write_pos are more than the capacity apart
+ * @return fifoerror_t
+ */
+fifoerror_t fifo_shm_get_n(fifo_shm_t *pShm, void *pData, size_t n, size_t *pRead)
+{
+#ifdef _DEBUG
+    assert(pShm != NULL && pShm->pHeader != NULL);
+    assert(pData != NULL || n == 0);
+#endif
+    // *** Checking Parameters ***
+    if (pShm == NULL || pShm->pHeader == NULL || (pData == NULL && n != 0))
+        return FIFO_WRONG_PARAM;
+
+    fifo_shm_header_t *pHeader = pShm->pHeader;
+    uint64_t read_pos = pHeader->read_pos;
+    uint64_t level = __atomic_load_n(&pHeader->write_pos, __ATOMIC_ACQUIRE) - read_pos;
+    if (level > pShm->mask +1)      // corrupt segment, the copy would leave the mapping
+        return FIFO_WRONG_PARAM;
+    size_t read = (n > level) ? level : n;
+
+    // *** Copy the data, then release all slots at once ***
+    if (read > 0)
+    {
+        _copyFromFifo(pShm, read_pos, pData, read);
+        __atomic_store_n(&pHeader->read_pos, read_pos + read, __ATOMIC_RELEASE);
+    }
+    if (pRead != NULL)
+    {
+        *pRead = read;
+    }
+    return (read == n) ? FIFO_NO_ERROR : FIFO_EMPTY;
+}
+
+/**
+ * @brief returns the fill level of a fifo
+ * @note the value is only a snapshot while the other process accesses the fifo
+ * @param pShm handle of this process
+ * @retval fill level of the fifo in elements, at most the capacity
+ */
+size_t fifo_shm_getLevel(fifo_shm_t *pShm)
+{
+#ifdef _DEBUG
+    assert(pShm != NULL && pShm->pHeader != NULL);
+#endif
+    if (pShm == NULL || pShm->pHeader == NULL)
+    {
+        return 0;
+    }
+    uint64_t read_pos = __atomic_load_n(&pShm->pHeader->read_pos, __ATOMIC_ACQUIRE);     // read_pos first, write_pos can only be bigger
+    uint64_t level = __atomic_load_n(&pShm->pHeader->write_pos, __ATOMIC_ACQUIRE) - read_pos;
+    return (level > pShm->mask +1) ? pShm->mask +1 : level;
+}
@@ -0,0 +1,156 @@
+/**
+ * @file fifo_shm.h
+ * @brief single producer / single consumer fifo in a POSIX shared memory segment, for two processes (Linux)
+ * The whole fifo, header and elements, lives in one shm_open() segment. The header only holds offsets and
+ * free running positions, no pointers, so every process can map the segment at a different address.
+ * The process local fifo_shm_t keeps the pointers of one mapping.
+ * One process creates the segment with fifo_shm_create(), the other one attaches with fifo_shm_attach(),
+ * which validates the header before the fifo is used.
+ * @note the capacity has to be a power of two, all of the slots can be used
+ * @author Josef Aschwanden
+ * @date Oct - 2026
+ * @version 1.0
+ */
+
+#ifndef _FIFO_SHM_H_
+#define _FIFO_SHM_H_
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// *** INCLUDES ***
+#include <stddef.h>
+#include "fifo.h"
+
+// *** DEFINES ***
+#define FIFO_SHM_MAGIC      0x4F464946u     /*!< "FIFO", written last by fifo_shm_create() */
+#define FIFO_SHM_VERSION    1u              /*!< layout version of fifo_shm_header_t */
+
+// *** TYPEDEF ***
+/**
+ * @brief header at the start of the shared memory segment
+ * write_pos and read_pos are on separate cache lines so the two processes do not share one
+ */
+typedef struct{
+    uint32_t magic;                         /*!< FIFO_SHM_MAGIC once the segment is initialized */
+    uint32_t version;                       /*!< FIFO_SHM_VERSION */
+    uint64_t segment_size;                  /*!< size of the whole segment (bytes) */
+    uint64_t data_offset;                   /*!< offset of the first slot from the start of the header (bytes) */
+    uint64_t mask;                          /*!< capacity in elements -1 */
+    uint32_t basetype_size;                 /*!< sizeof the fifo basetype (bytes) */
+    uint8_t _pad0[FIFO_CACHE_LINE_SIZE];
+    uint64_t write_pos;                     /*!< elements put, free running, written by the producer */
+    uint8_t _pad1[FIFO_CACHE_LINE_SIZE - sizeof(uint64_t)];
+    uint64_t read_pos;                      /*!< elements got, free running, written by the consumer */
+    uint8_t _pad2[FIFO_CACHE_LINE_SIZE - sizeof(uint64_t)];
+}fifo_shm_header_t;
+
+/**
+ * @brief process local handle of a shared memory fifo
+ * mask and basetype_size are only read from the segment once, so the other process can not change the size of a copy
+ */
+typedef struct{
+    fifo_shm_header_t *pHeader;             /*!< start of the mapping */
+    uint8_t *pData;                         /*!< first slot in this mapping */
+    size_t map_size;                        /*!< size of the mapping (bytes) */
+    uint64_t mask;                          /*!< capacity in elements -1, copied from the validated header */
+    size_t basetype_size;                   /*!< sizeof the fifo basetype (bytes), copied from the validated header */
+}fifo_shm_t;
+
+/**
+ * @brief creates a shared memory segment and initializes a fifo in it
+ * @param [out] pShm handle of this process
+ * @param name name of the segment, eg: "/my_fifo", see shm_open()
+ * @param size_fifo size of the fifo in elements, must be a power of two
+ * @param basetype_size size of the fifo basetype eg: sizeof(uint8_t)
+ * @retval 0 = success
+ * @retval -1 = NULL Pointer as Parameter
+ * @retval -2 = invalid fifo size
+ * @retval -3 = invalid basetype_size
+ * @retval -6 = the segment exists already or could not be created / mapped
+ */
+int8_t fifo_shm_create(fifo_shm_t *pShm, const char *name, size_t size_fifo, SIZE_FIFO_BASE_TYPE basetype_size);
+
+/**
+ * @brief attaches to a fifo created by fifo_shm_create(), maybe in another process
+ * The header is checked against the size of the segment, so a segment of a crashed creator or of a different
+ * version is refused.
+ * @param [out] pShm handle of this process
+ * @param name name of the segment, see shm_open()
+ * @retval 0 = success
+ * @retval -1 = NULL Pointer as Parameter
+ * @retval -6 = the segment does not exist or could not be mapped
+ * @retval -7 = invalid header
+ */
+int8_t fifo_shm_attach(fifo_shm_t *pShm, const char *name);
+
+/**
+ * @brief unmaps the segment from this process, the fifo stays in the segment
+ * @param pShm handle of this process
+ */
+void fifo_shm_detach(fifo_shm_t *pShm);
+
+/**
+ * @brief removes the name of the segment, it gets freed after the last process detached
+ * @param name name of the segment, see shm_open()
+ * @retval 0 = success
+ * @retval -1 = failed
+ */
+int8_t fifo_shm_unlink(const char *name);
+
+/**
+ * @brief puts an element into the fifo, only called by the producer
+ * @param pShm handle of this process
+ * @param [in] pData pointer to the data to be put onto the fifo
+ * @return fifoerror_t
+ */
+fifoerror_t fifo_shm_put(fifo_shm_t *pShm, const void *pData);
+
+/**
+ * @brief gets an element from the fifo, only called by the consumer
+ * @param pShm handle of this process
+ * @param [out] pData pointer to the storage for the data from the fifo
+ * @return fifoerror_t
+ */
+fifoerror_t fifo_shm_get(fifo_shm_t *pShm, void *pData);
+
+/**
+ * @brief puts up to n elements into the fifo with one update of write_pos, only called by the producer
+ * @param pShm handle of this process
+ * @param [in] pData pointer to the n elements to be put onto the fifo
+ * @param n ammount of elements
+ * @param [out] pWritten number of elements put onto the fifo, may be NULL
+ * @retval FIFO_NO_ERROR    all n elements were put onto the fifo
+ * @retval FIFO_FULL        only *pWritten elements fitted into the fifo
+ * @retval FIFO_WRONG_PARAM NULL pointer or corrupt segment, read_pos / write_pos are more than the capacity apart
+ * @return fifoerror_t
+ */
+fifoerror_t fifo_shm_put_n(fifo_shm_t *pShm, const void *pData, size_t n, size_t *pWritten);
+
+/**
+ * @brief gets up to n elements from the fifo with one update of read_pos, only called by the consumer
+ * @param pShm handle of this process
+ * @param [out] pData pointer to the storage for n elements
+ * @param n ammount of elements
+ * @param [out] pRead number of elements read from the fifo, may be NULL
+ * @retval FIFO_NO_ERROR    all n elements were read
+ * @retval FIFO_EMPTY       only *pRead elements were in the fifo
+ * @retval FIFO_WRONG_PARAM NULL pointer or corrupt segment, read_pos / write_pos are more than the capacity apart
+ * @return fifoerror_t
+ */
+fifoerror_t fifo_shm_get_n(fifo_shm_t *pShm, void *pData, size_t n, size_t *pRead);
+
+/**
+ * @brief returns the fill level of a fifo
+ * @note the value is only a snapshot while the other process accesses the fifo
+ * @param pShm handle of this process
+ * @retval fill level of the fifo in elements, at most the capacity
+ */
+size_t fifo_shm_getLevel(fifo_shm_t *pShm);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif  // _FIFO_SHM_H_
@@ -0,0 +1,305 @@
+// *** INCLUDES ***
+#include "fifo_spill.h"
+#include <stdio.h>  // snprintf
+#include <stdlib.h>
+#include <string.h> // memcpy
+#include <unistd.h>
+#ifdef _DEBUG
+    #include <assert.h>
+#endif
+
+// *** STATIC FUNCTIONS ***
+/**
+ * @brief writes all bytes to the spill file at offset
+ * @retval true = success
+ */
+static bool _writeAll(int fd, const void *pData, size_t bytes, uint64_t offset)
+{
+    while (bytes > 0)
+    {
+        ssize_t done = pwrite(fd, pData, bytes, (off_t)offset);
+        if (done <= 0)
+            return false;
+        pData = (const uint8_t *)pData + done;
+        bytes -= done;
+        offset += done;
+    }
+    return true;
+}
+
+/**
+ * @brief reads all bytes from the spill file at offset
+ * @retval true = success
+ */
+static bool _readAll(int fd, void *pData, size_t bytes, uint64_t offset)
+{
+    while (bytes > 0)
+    {
+        ssize_t done = pread(fd, pData, bytes, (off_t)offset);
+        if (done <= 0)
+            return false;
+        pData = (uint8_t *)pData + done;
+        bytes -= done;
+        offset += done;
+    }
+    return true;
+}
+
+/**
+ * @brief appends the elements of the batch buffer that are not in the ring yet to the spill file
+ * @note lock has to be held
+ * @retval true = success
+ */
+static bool _flushBatch(fifo_spill_t *pSpill)
+{
+    size_t basetype_size = pSpill->pRing->basetype_size, n = pSpill->batch_level - pSpill->batch_read;
+    if (!_writeAll(pSpill->fd, (uint8_t *)pSpill->pBatch + pSpill->batch_read * basetype_size, n * basetype_size,
+                   pSpill->file_written * basetype_size))
+        return false;
+    pSpill->file_written += n;
+    pSpill->spilled += n;
+    pSpill->batch_level = 0;
+    pSpill->batch_read = 0;
+    return true;
+}
+
+/**
+ * @brief moves spilled elements into the ring, oldest first: spill file, then batch buffer
+ * When everything was moved the spill file is truncated and the producer may write to the ring again.
+ * @note lock has to be held, the consumer is the only writer of the ring while spilling is set
+ */
+static void _refill(fifo_spill_t *pSpill)
+{
+    size_t basetype_size = pSpill->pRing->basetype_size;
+    FIFO_WIDE_INDEX_TYPE space = fifo_wide_getEmptySpace(pSpill->pRing);
+
+    // *** Read the spill file in place into the ring ***
+    while (space > 0 && pSpill->file_read < pSpill->file_written)
+    {
+        void *pSlot;
+        FIFO_WIDE_INDEX_TYPE contiguous, n = space;
+        if (n > pSpill->file_written - pSpill->file_read)
+        {
+            n = pSpill->file_written - pSpill->file_read;
+        }
+        if (fifo_wide_write_reserve(pSpill->pRing, n, &pSlot, &contiguous) != FIFO_NO_ERROR)
+            break;
+        if (!_readAll(pSpill->fd, pSlot, contiguous * basetype_size, pSpill->file_read * basetype_size))
+        {
+            fifo_wide_write_commit(pSpill->pRing, 0);
+            return;     // try again with the next get
+        }
+        fifo_wide_write_commit(pSpill->pRing, contiguous);
+        pSpill->file_read += contiguous;
+        space -= contiguous;
+    }
+    if (pSpill->file_read != pSpill->file_written)
+        return;
+
+    // *** Spill file drained, give the disk space back ***
+    if (pSpill->file_written != 0 && ftruncate(pSpill->fd, 0) == 0)
+    {
+        pSpill->file_written = 0;
+        pSpill->file_read = 0;
+    }
+
+    // *** Then the batch buffer, its elements are newer than the ones of the file ***
+    FIFO_WIDE_INDEX_TYPE moved = 0;
+    fifo_wide_put_n(pSpill->pRing, (uint8_t *)pSpill->pBatch + pSpill->batch_read * basetype_size,
+                    pSpill->batch_level - pSpill->batch_read, &moved);
+    pSpill->batch_read += moved;
+    if (pSpill->batch_read == pSpill->batch_level && pSpill->file_written == 0)
+    {
+        pSpill->batch_level = 0;
+        pSpill->batch_read = 0;
+        __atomic_store_n(&pSpill->spilling, false, __ATOMIC_RELEASE);     // hand the ring back to the producer
+    }
+}
+
+/**
+ * @brief allocates the ring and the batch buffer and creates the spill file
+ * @param pSpill pointer to the handle
+ * @param size_fifo size of the ring in elements
+ * @param basetype_size size of the fifo basetype eg: sizeof(uint8_t)
+ * @param dir directory of the spill file, eg: "/var/tmp"
+ * @param batch_size elements per append to the spill file
+ * @retval 0 = success
+ * @retval -1 = NULL Pointer as Parameter
+ * @retval -2 = invalid fifo size
+ * @retval -3 = invalid basetype_size or batch_size
+ * @retval -6 = the spill file could not be created
+ * @retval -7 = the batch buffer could not be allocated
+ */
+int8_t fifo_spill_init(fifo_spill_t *pSpill, size_t size_fifo, SIZE_FIFO_BASE_TYPE basetype_size, const char *dir, size_t batch_size)
+{
+#ifdef _DEBUG
+    assert(pSpill != NULL);
+    assert(dir != NULL);
+#endif
+    // *** Checking Parameters ***
+    if (pSpill == NULL || dir == NULL)
+        return -1;
+    if (basetype_size == 0 || basetype_size > FIFO_MAX_BASETYPE_SIZE || batch_size == 0 || batch_size > SIZE_MAX / basetype_size)
+        return -3;
+
+    // *** Allocate Ring and Batch Buffer ***
+    pSpill->pRing = fifo_wide_init_malloc(size_fifo, basetype_size);
+    if (pSpill->pRing == NULL)
+        return -2;
+    pSpill->pBatch = malloc(batch_size * basetype_size);
+    if (pSpill->pBatch == NULL)
+    {
+        fifo_wide_deinit_free(pSpill->pRing);
+        pSpill->pRing = NULL;
+        return -7;
+    }
+
+    // *** Create the spill file, it is unlinked right away and vanishes with the last close ***
+    char path[4096];
+    pSpill->fd = -1;
+    if (snprintf(path, sizeof(path), "%s/fifo_spill_XXXXXX", dir) < (int)sizeof(path))
+    {
+        pSpill->fd = mkstemp(path);
+        if (pSpill->fd >= 0)
+        {
+            unlink(path);
+        }
+    }
+    if (pSpill->fd < 0)
+    {
+        free(pSpill->pBatch);
+        fifo_wide_deinit_free(pSpill->pRing);
+        pSpill->pRing = NULL;
+        return -6;
+    }
+
+    // *** Initialize Handle ***
+    pSpill->spilling = false;
+    pSpill->file_written = 0;
+    pSpill->file_read = 0;
+    pSpill->batch_size = batch_size;
+    pSpill->batch_level = 0;
+    pSpill->batch_read = 0;
+    pSpill->spilled = 0;
+    pthread_mutex_init(&pSpill->lock, NULL);
+    return 0;
+}
+
+/**
+ * @brief frees the ring and the batch buffer and closes the spill file, its elements are lost
+ * @param pSpill pointer to the handle
+ */
+void fifo_spill_deinit(fifo_spill_t *pSpill)
+{
+#ifdef _DEBUG
+    assert(pSpill != NULL);
+#endif
+    if (pSpill != NULL && pSpill->pRing != NULL)
+    {
+        close(pSpill->fd);
+        free(pSpill->pBatch);
+        fifo_wide_deinit_free(pSpill->pRing);
+        pSpill->pRing = NULL;
+        pthread_mutex_destroy(&pSpill->lock);
+    }
+}
+
+/**
+ * @brief puts an element into the ring or, if it is full or elements are spilled, into the spill file
+ * @param pSpill pointer to the handle
+ * @param [in] pData pointer to the data to be put onto the fifo
+ * @retval FIFO_FULL        the spill file could not be written
+ * @return fifoerror_t
+ */
+fifoerror_t fifo_spill_put(fifo_spill_t *pSpill, const void *pData)
+{
+#ifdef _DEBUG
+    assert(pSpill != NULL);
+    assert(pData != NULL);
+#endif
+    // *** Checking Parameters ***
+    if (pSpill == NULL || pSpill->pRing == NULL || pData == NULL)
+        return FIFO_WRONG_PARAM;
+
+    // *** Fast path, nothing is spilled ***
+    fifoerror_t ret;
+    if (!__atomic_load_n(&pSpill->spilling, __ATOMIC_ACQUIRE))
+    {
+        ret = fifo_wide_put(pSpill->pRing, pData);
+        if (ret != FIFO_FULL)
+            return ret;
+    }
+
+    pthread_mutex_lock(&pSpill->lock);
+    if (!pSpill->spilling)
+    {
+        if ((ret = fifo_wide_put(pSpill->pRing, pData)) != FIFO_FULL)     // the consumer made space in the meantime
+        {
+            pthread_mutex_unlock(&pSpill->lock);
+            return ret;
+        }
+        __atomic_store_n(&pSpill->spilling, true, __ATOMIC_RELEASE);      // from now on only the consumer writes the ring
+    }
+
+    // *** Collect the element, append full batches to the spill file ***
+    ret = FIFO_NO_ERROR;
+    if (pSpill->batch_level == pSpill->batch_size && !_flushBatch(pSpill))
+    {
+        ret = FIFO_FULL;
+    }
+    else
+    {
+        memcpy((uint8_t *)pSpill->pBatch + pSpill->batch_level * pSpill->pRing->basetype_size, pData, pSpill->pRing->basetype_size);
+        pSpill->batch_level++;
+    }
+    pthread_mutex_unlock(&pSpill->lock);
+    return ret;
+}
+
+/**
+ * @brief gets an element from the ring, the ring gets refilled from the spill file when it is empty
+ * @param pSpill pointer to the handle
+ * @param [out] pData pointer to the storage for the data from the fifo
+ * @return fifoerror_t
+ */
+fifoerror_t fifo_spill_get(fifo_spill_t *pSpill, void *pData)
+{
+#ifdef _DEBUG
+    assert(pSpill != NULL);
+    assert(pData != NULL);
+#endif
+    // *** Checking Parameters ***
+    if (pSpill == NULL || pSpill->pRing == NULL || pData == NULL)
+        return FIFO_WRONG_PARAM;
+
+    fifoerror_t ret = fifo_wide_get(pSpill->pRing, pData);
+    if (ret != FIFO_EMPTY || !__atomic_load_n(&pSpill->spilling, __ATOMIC_ACQUIRE))
+        return ret;
+
+    // *** Ring is empty, move spilled elements into it ***
+    pthread_mutex_lock(&pSpill->lock);
+    _refill(pSpill);
+    pthread_mutex_unlock(&pSpill->lock);
+    return fifo_wide_get(pSpill->pRing, pData);
+}
+
+/**
+ * @brief returns the number of elements in the ring, the spill file and the batch buffer
+ * @param pSpill pointer to the handle
+ * @retval fill level in elements
+ */
+uint64_t fifo_spill_getLevel(fifo_spill_t *pSpill)
+{
+#ifdef _DEBUG
+    assert(pSpill != NULL);
+#endif
+    if (pSpill == NULL || pSpill->pRing == NULL)
+    {
+        return 0;
+    }
+    pthread_mutex_lock(&pSpill->lock);
+    uint64_t level = fifo_wide_getLevel(pSpill->pRing) + (pSpill->file_written - pSpill->file_read)
+                   + (pSpill->batch_level - pSpill->batch_read);
+    pthread_mutex_unlock(&pSpill->lock);
+    return level;
+}
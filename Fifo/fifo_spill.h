@@ -0,0 +1,97 @@
+/**
+ * @file fifo_spill.h
+ * @brief fifo with an overflow file, elements that do not fit into the ring in memory are spilled to disk (Linux)
+ * As long as the ring has space fifo_spill_put() and fifo_spill_get() are plain fifo_wide_put() / fifo_wide_get().
+ * When the ring is full the producer collects elements in a batch buffer and appends full batches to an unlinked
+ * spill file. When the consumer finds the ring empty it refills the ring from the file and then from the batch
+ * buffer, so the elements keep their order. After everything was drained the file is truncated and the producer
+ * writes to the ring again.
+ * The memory used is the ring and one batch buffer, the file is only written and read sequentially.
+ * @note one producer thread and one consumer thread may use the fifo at the same time, the ring is a
+ * fifo_wide_handle_t, use FIFO_SPSC for a lock free ring
+ * @author Josef Aschwanden
+ * @date Oct - 2026
+ * @version 1.0
+ */
+
+#ifndef _FIFO_SPILL_H_
+#define _FIFO_SPILL_H_
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// *** INCLUDES ***
+#include <pthread.h>
+#include "fifo_wide.h"
+
+// *** TYPEDEF ***
+/**
+ * @brief this structure is used as handle for the fifo with an overflow file
+ * Everything but pRing and spilling is only accessed with lock held
+ */
+typedef struct{
+    fifo_wide_handle_t *pRing;              /*!< fifo in memory */
+    bool spilling;                          /*!< set by the producer when the ring is full, cleared by the consumer after the spill was drained */
+    int fd;                                 /*!< unlinked spill file */
+    uint64_t file_written;                  /*!< elements appended to the spill file */
+    uint64_t file_read;                     /*!< elements read back from the spill file */
+    void *pBatch;                           /*!< elements collected for the next append */
+    size_t batch_size;                      /*!< size of the batch buffer in elements */
+    size_t batch_level;                     /*!< elements in the batch buffer */
+    size_t batch_read;                      /*!< elements of the batch buffer already moved to the ring */
+    uint64_t spilled;                       /*!< elements written to the spill file since init, statistics */
+    pthread_mutex_t lock;                   /*!< protects the spill file and the batch buffer */
+}fifo_spill_t;
+
+/**
+ * @brief allocates the ring and the batch buffer and creates the spill file
+ * @param pSpill pointer to the handle
+ * @param size_fifo size of the ring in elements
+ * @param basetype_size size of the fifo basetype eg: sizeof(uint8_t)
+ * @param dir directory of the spill file, eg: "/var/tmp"
+ * @param batch_size elements per append to the spill file
+ * @retval 0 = success
+ * @retval -1 = NULL Pointer as Parameter
+ * @retval -2 = invalid fifo size
+ * @retval -3 = invalid basetype_size or batch_size
+ * @retval -6 = the spill file could not be created
+ * @retval -7 = the batch buffer could not be allocated
+ */
+int8_t fifo_spill_init(fifo_spill_t *pSpill, size_t size_fifo, SIZE_FIFO_BASE_TYPE basetype_size, const char *dir, size_t batch_size);
+
+/**
+ * @brief frees the ring and the batch buffer and closes the spill file, its elements are lost
+ * @param pSpill pointer to the handle
+ */
+void fifo_spill_deinit(fifo_spill_t *pSpill);
+
+/**
+ * @brief puts an element into the ring or, if it is full or elements are spilled, into the spill file
+ * @param pSpill pointer to the handle
+ * @param [in] pData pointer to the data to be put onto the fifo
+ * @retval FIFO_FULL        the spill file could not be written
+ * @return fifoerror_t
+ */
+fifoerror_t fifo_spill_put(fifo_spill_t *pSpill, const void *pData);
+
+/**
+ * @brief gets an element from the ring, the ring gets refilled from the spill file when it is empty
+ * @param pSpill pointer to the handle
+ * @param [out] pData pointer to the storage for the data from the fifo
+ * @return fifoerror_t
+ */
+fifoerror_t fifo_spill_get(fifo_spill_t *pSpill, void *pData);
+
+/**
+ * @brief returns the number of elements in the ring, the spill file and the batch buffer
+ * @param pSpill pointer to the handle
+ * @retval fill level in elements
+ */
+uint64_t fifo_spill_getLevel(fifo_spill_t *pSpill);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif  // _FIFO_SPILL_H_
@@ -25,6 +25,9 @@ int main(void)
 	
 	testInitMalloc();
 	printCritical();
+
+	testInitMallocAligned();
+	printCritical();
 	
 	testDeinitFree();
 	printCritical();
@@ -55,5 +58,77 @@ int main(void)
 
 	testSkipWrite();
 	printCritical();
+
+	testPutGetN();
+	printCritical();
+
+	testReserveCommit();
+	printCritical();
+
+	testDrain();
+	printCritical();
+
+	testRecord();
+	printCritical();
+
+	testWide();
+	printCritical();
+
+#if FIFO_POW2
+	testPow2();
+	printCritical();
+#endif
+
+	testMpmc();
+	printCritical();
+
+	testShm();
+	printCritical();
+
+	testSpill();
+	printCritical();
+
+	testBank();
+	printCritical();
+
+	testPrio();
+	printCritical();
+
+	testDeque();
+	printCritical();
+
+	testBroadcast();
+	printCritical();
+
+#if FIFO_NOTIFY
+	testSet();
+	printCritical();
+
+	testEventfd();
+	printCritical();
+
+	testEventfdWakeup();
+	printCritical();
+#endif
+
+#if FIFO_SPSC
+	testSpscThreads();
+	printCritical();
+#endif
+
+#if FIFO_OVERWRITE
+	testOverwrite();
+	printCritical();
+#endif
+
+#if FIFO_WAIT && FIFO_SPSC
+	testWait();
+	printCritical();
+#endif
+
+#if FIFO_MIRROR
+	testMirror();
+	printCritical();
+#endif
 }
 
@@ -0,0 +1,515 @@
+/**
+ * @file fifo_test.cpp
+ * @brief this Programm is used to test the c++ wrappers of the fifo library
+ * @author Josef Aschwanden
+ * @date Oct - 2026
+ * @version 1.0
+ */
+
+// *** INCLUDES ***
+#include "fifo.hpp"
+#include "fifo_executor.hpp"
+#include "test.h"
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <functional>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+
+/**
+ * @brief element that counts its living instances and owns heap memory, so leaks and double destruction show up
+ */
+struct Counted{
+	static int alive;
+	std::string text;
+	explicit Counted(uint32_t value = 0) : text(std::string(40, 'x') + std::to_string(value)) { alive++; }
+	Counted(const Counted& other) : text(other.text) { alive++; }
+	Counted(Counted&& other) noexcept : text(std::move(other.text)) { alive++; }
+	Counted& operator=(const Counted& other) { text = other.text; return *this; }
+	Counted& operator=(Counted&& other) noexcept { text = std::move(other.text); return *this; }
+	~Counted() { alive--; }
+	bool is(uint32_t value) const { return text == std::string(40, 'x') + std::to_string(value); }
+};
+int Counted::alive = 0;
+
+/**
+ * @brief element whose constructor throws when fail is true
+ */
+struct Throwing{
+	std::string text;
+	explicit Throwing(bool fail) : text("constructed")
+	{
+		if (fail)
+			throw std::runtime_error("Throwing");
+	}
+};
+
+/**
+ * @brief test of Fifo<T> with types that are not trivially copyable: construction / destruction balance,
+ * move only types, wrap around and moving the fifo itself
+ */
+static void testFifoNonTrivial(void)
+{
+	printf("Test of Fifo<T> with non trivial types started\n");
+	Counted rcv;
+	int alive = Counted::alive;		// rcv
+
+	// ** wrap around with put(const T&), put(T&&), emplace() and get() **
+	{
+		utils::Fifo<Counted> fifo(8);
+		size_t capacity = fifo.getEmptySpace();
+		uint32_t next = 0, expected = 0;
+		for (uint32_t j = 0; j < 100; j++)
+		{
+			for (uint32_t i = 0; i < j % capacity + 1; i++, next++)
+			{
+				Counted tx(next);
+				int ret = (i % 3 == 0) ? fifo.put(tx) : (i % 3 == 1) ? fifo.put(std::move(tx)) : fifo.emplace(next);
+				if (ret != 0) print_debuginfo((int)next);
+			}
+			while (fifo.get(rcv) == 0)
+			{
+				if (!rcv.is(expected++)) print_debuginfo((int)expected);
+			}
+			if (fifo.getConsumerError() != FIFO_EMPTY) print_debugs("");
+		}
+		if (expected != next) print_debuginfo((int)expected);
+		if (Counted::alive != alive) print_debuginfo(Counted::alive - alive);
+
+		// ** full fifo, bulk put / get **
+		Counted tx[16], rx[16];
+		alive = Counted::alive;
+		if (fifo.put(tx, 16) != capacity || fifo.getProducerError() != FIFO_FULL) print_debugs("");
+		if (fifo.emplace(0u) != -1 || fifo.getProducerError() != FIFO_FULL) print_debugs("");
+		if (Counted::alive != alive + (int)capacity) print_debuginfo(Counted::alive - alive);
+		if (fifo.get(rx, 16) != capacity || fifo.getConsumerError() != FIFO_EMPTY) print_debugs("");
+		if (fifo.getProducerError() != FIFO_FULL || fifo.getError() != FIFO_FULL) print_debugs("");	// not changed by the consumer
+		if (Counted::alive != alive) print_debuginfo(Counted::alive - alive);
+
+		// ** skipRead() and flush() destroy the elements **
+		for (uint32_t i = 0; i < 5; i++)
+		{
+			fifo.emplace(i);
+		}
+		if (fifo.skipRead(2) != 0 || fifo.getLevel() != 3) print_debugs("");
+		if (fifo.get(rcv) != 0 || !rcv.is(2)) print_debugs("");
+		if (fifo.skipRead(10) != 0 || fifo.getLevel() != 0) print_debugs("");	// limited like fifo_skip_read_n()
+		if (fifo.skipRead() != -1 || fifo.getConsumerError() != FIFO_EMPTY) print_debugs("");
+		fifo.emplace(1u);
+		fifo.emplace(2u);
+		if (fifo.flush() != 0 || fifo.hasElementsLeft()) print_debugs("");
+		if (Counted::alive != alive) print_debuginfo(Counted::alive - alive);
+
+		// ** the destructor destroys the elements left **
+		for (uint32_t i = 0; i < 4; i++)
+		{
+			fifo.emplace(i);
+		}
+	}
+	alive -= 32;	// tx and rx
+	if (Counted::alive != alive) print_debuginfo(Counted::alive - alive);
+
+	// ** move construction and move assignment **
+	{
+		utils::Fifo<Counted> a(8), b(8);
+		a.emplace(1u);
+		a.emplace(2u);
+		b.emplace(3u);
+		utils::Fifo<Counted> c(std::move(a));
+		if (a.size() != 0 || a.getLevel() != 0 || a.emplace(4u) != -1) print_debugs("");	// moved from
+		if (c.getLevel() != 2 || c.get(rcv) != 0 || !rcv.is(1)) print_debugs("");
+		c = std::move(b);	// destroys the element 2
+		if (Counted::alive != alive + 1) print_debuginfo(Counted::alive - alive);
+		if (c.get(rcv) != 0 || !rcv.is(3) || c.get(rcv) != -1) print_debugs("");
+		if (b.size() != 0) print_debugs("");
+	}
+	if (Counted::alive != alive) print_debuginfo(Counted::alive - alive);
+
+	// ** move only type **
+	{
+		utils::Fifo<std::unique_ptr<uint32_t>> fifo(4);
+		std::unique_ptr<uint32_t> p(new uint32_t(7));
+		if (fifo.put(std::move(p)) != 0 || p) print_debugs("");
+		if (fifo.emplace(new uint32_t(8)) != 0) print_debugs("");
+		if (fifo.get(p) != 0 || !p || *p != 7) print_debugs("");
+		if (fifo.emplace(new uint32_t(9)) != 0) print_debugs("");	// left in the fifo, freed by its destructor
+	}
+
+	// ** a throwing constructor commits nothing **
+	{
+		utils::Fifo<Throwing> fifo(4);
+		bool thrown = false;
+		try
+		{
+			fifo.emplace(true);
+		}
+		catch (const std::runtime_error&)
+		{
+			thrown = true;
+		}
+		if (!thrown || fifo.getLevel() != 0) print_debugs("");
+		if (fifo.emplace(false) != 0 || fifo.getLevel() != 1) print_debugs("");	// not locked after the exception
+	}
+	printf("Test of Fifo<T> with non trivial types ended\n");
+}
+
+/**
+ * @brief checks getSegments() and consume() of a fifo that can take capacity elements:
+ * the wrapped two segment case, the iterator over it and consume() after getSegments()
+ */
+template<typename F>
+static void testSegmentsOf(F& fifo, F& other, size_t capacity)
+{
+	uint32_t tx[16], rcv;
+	for (uint32_t i = 0; i < 16; i++)
+	{
+		tx[i] = i;
+	}
+
+	// ** empty **
+	auto seg = fifo.getSegments();
+	if (!seg.empty() || seg.begin() != seg.end()) print_debugs("");
+
+	// ** move the read index to the middle, then fill the fifo so it wraps around **
+	fifo.put(tx, capacity - 3);
+	while (fifo.get(rcv) == 0) {}
+	if (fifo.put(tx, capacity) != capacity) print_debugs("");
+	seg = fifo.getSegments();
+	if (seg.size() != capacity || seg.first.size() == 0 || seg.second.size() == 0) print_debuginfo((int)seg.second.size());
+	for (size_t i = 0; i < seg.first.size(); i++)
+	{
+		if (seg.first[i] != i) print_debuginfo((int)i);
+	}
+	for (size_t i = 0; i < seg.second.size(); i++)
+	{
+		if (seg.second[i] != seg.first.size() + i) print_debuginfo((int)i);
+	}
+
+	// ** the iterator runs over both segments, begin() != end() although the fifo is full **
+	uint32_t expected = 0;
+	for (auto it = seg.begin(); it != seg.end(); ++it)
+	{
+		if (*it != expected++) print_debuginfo((int)expected);
+	}
+	if (expected != capacity) print_debuginfo((int)expected);
+
+	// ** iterators of two segment sets with the same number of elements are not equal **
+	other.put(tx, capacity);
+	auto seg_other = other.getSegments();
+	if (seg_other.size() != seg.size() || seg_other.begin() == seg.begin()) print_debugs("");
+	if (seg_other.end() == seg.end() || fifo.getSegments().begin() != seg.begin()) print_debugs("");
+	other.flush();
+
+	// ** consume() after getSegments() removes the oldest elements **
+	if (fifo.consume(2) != 0 || fifo.getLevel() != capacity - 2) print_debugs("");
+	seg = fifo.getSegments();
+	if (seg.size() != capacity - 2 || *seg.begin() != 2) print_debugs("");
+	if (fifo.consume(capacity) != -1 || fifo.getConsumerError() != FIFO_EMPTY || fifo.getLevel() != capacity - 2) print_debugs("");
+	if (fifo.consume(capacity - 2) != 0 || fifo.hasElementsLeft()) print_debugs("");
+	if (!fifo.getSegments().empty()) print_debugs("");
+}
+
+/**
+ * @brief test of getSegments() and consume() of Fifo<T, N> and Fifo<T>
+ */
+static void testSegments(void)
+{
+	printf("Test of Fifo getSegments() started\n");
+	utils::Fifo<uint32_t, 8> fifoN, otherN;
+	testSegmentsOf(fifoN, otherN, 8);
+	utils::Fifo<uint32_t> fifo(8), other(8);
+	testSegmentsOf(fifo, other, fifo.getEmptySpace());
+	printf("Test of Fifo getSegments() ended\n");
+}
+
+/**
+ * @brief checks drain() of a fifo that can take capacity elements: all elements, max_elems and the wrapped case
+ */
+template<typename F>
+static void testDrainOf(F& fifo, size_t capacity)
+{
+	uint32_t tx[16], rcv;
+	for (uint32_t i = 0; i < 16; i++)
+	{
+		tx[i] = i;
+	}
+	uint32_t expected = 0;
+	auto check = [&expected](uint32_t& value) {
+		if (value != expected++) print_debuginfo((int)expected);
+	};
+
+	// ** empty **
+	if (fifo.drain(check) != 0 || fifo.getConsumerError() != FIFO_EMPTY) print_debugs("");
+
+	// ** max_elems limits the elements drained **
+	fifo.put(tx, 5);
+	if (fifo.drain(check, 2) != 2 || expected != 2 || fifo.getLevel() != 3) print_debugs("");
+	if (fifo.drain(check) != 3 || expected != 5 || fifo.hasElementsLeft()) print_debugs("");
+
+	// ** wrapped around the end of the fifo memory **
+	fifo.put(tx, capacity - 3);
+	while (fifo.get(rcv) == 0) {}
+	fifo.put(tx, capacity);
+	expected = 0;
+	if (fifo.drain(check) != capacity || expected != capacity || fifo.hasElementsLeft()) print_debuginfo((int)expected);
+}
+
+/**
+ * @brief test of drain() of Fifo<T, N> and Fifo<T>, with a non trivial type the drained elements get destroyed
+ */
+static void testFifoDrain(void)
+{
+	printf("Test of Fifo drain() started\n");
+	utils::Fifo<uint32_t, 8> fifoN;
+	testDrainOf(fifoN, 8);
+	utils::Fifo<uint32_t> fifo(8);
+	testDrainOf(fifo, fifo.getEmptySpace());
+
+	// ** f may move from the element **
+	int alive = Counted::alive;
+	{
+		utils::Fifo<Counted> fifoCounted(8);
+		for (uint32_t i = 0; i < 5; i++)
+		{
+			fifoCounted.emplace(i);
+		}
+		uint32_t expected = 0;
+		Counted rcv;
+		size_t n = fifoCounted.drain([&](Counted& value) {
+			rcv = std::move(value);
+			if (!rcv.is(expected++)) print_debuginfo((int)expected);
+		});
+		if (n != 5 || fifoCounted.hasElementsLeft()) print_debuginfo((int)n);
+		if (Counted::alive != alive + 1) print_debuginfo(Counted::alive - alive);	// rcv
+	}
+	if (Counted::alive != alive) print_debuginfo(Counted::alive - alive);
+	printf("Test of Fifo drain() ended\n");
+}
+
+#define FIFO_N_TEST_ELEMENTS 1000000
+
+/**
+ * @brief test of Fifo<T, N>: capacity, wrap around, partial put / get, skipRead() and one producer / consumer thread
+ */
+static void testFifoN(void)
+{
+	printf("Test of Fifo<T, N> started\n");
+	utils::Fifo<uint32_t, 8> fifo;
+	uint32_t tx[16], rx[16], rcv;
+	for (uint32_t i = 0; i < 16; i++)
+	{
+		tx[i] = i;
+	}
+
+	// ** the read and the write index do not share a cache line **
+	if (alignof(utils::Fifo<uint8_t, 4>) < FIFO_CACHE_LINE_SIZE) print_debuginfo((int)alignof(utils::Fifo<uint8_t, 4>));
+	if (sizeof(utils::Fifo<uint8_t, 4>) < 2 * FIFO_CACHE_LINE_SIZE) print_debuginfo((int)sizeof(utils::Fifo<uint8_t, 4>));
+
+	// ** all N elements can be used **
+	if (fifo.get(rcv) != -1 || fifo.getConsumerError() != FIFO_EMPTY) print_debugs("");
+	for (uint32_t i = 0; i < 8; i++)
+	{
+		if (fifo.put(tx[i]) != 0) print_debuginfo((int)i);
+	}
+	if (fifo.put(tx[8]) != -1 || fifo.getProducerError() != FIFO_FULL) print_debugs("");
+	if (fifo.hasSpaceLeft() || fifo.getLevel() != 8 || fifo.getEmptySpace() != 0) print_debugs("");
+	for (uint32_t i = 0; i < 8; i++)
+	{
+		if (fifo.get(rcv) != 0 || rcv != i) print_debuginfo((int)i);
+	}
+	if (fifo.hasElementsLeft()) print_debugs("");
+
+	// ** batches around the wrap point **
+	for (uint32_t j = 0; j < 40; j++)
+	{
+		size_t n = j % 8 + 1;
+		if (fifo.put(&tx[j % 8], n) != n || fifo.getProducerError() != FIFO_NO_ERROR) print_debuginfo((int)j);
+		if (fifo.get(rx, n) != n || fifo.getConsumerError() != FIFO_NO_ERROR) print_debuginfo((int)j);
+		for (size_t i = 0; i < n; i++)
+		{
+			if (rx[i] != tx[j % 8 + i]) print_debuginfo((int)j);
+		}
+	}
+
+	// ** partial put / get **
+	if (fifo.put(tx, 10) != 8 || fifo.getProducerError() != FIFO_FULL) print_debugs("");
+	if (fifo.get(rx, 10) != 8 || fifo.getConsumerError() != FIFO_EMPTY) print_debugs("");
+	if (fifo.getProducerError() != FIFO_FULL || fifo.getProducerErrorStr() != "Fifo is full") print_debugs("");	// not changed by the consumer
+	if (fifo.getError() != FIFO_FULL || fifo.getErrorStr() != "Fifo is full") print_debugs("");
+	for (uint32_t i = 0; i < 8; i++)
+	{
+		if (rx[i] != i) print_debuginfo((int)i);
+	}
+
+	// ** skipRead() is limited to the elements in the fifo, like fifo_skip_read_n() **
+	if (fifo.skipRead() != -1 || fifo.getConsumerError() != FIFO_EMPTY) print_debugs("");
+	fifo.put(tx, 3);
+	if (fifo.skipRead(5) != 0 || fifo.getConsumerError() != FIFO_NO_ERROR || fifo.getLevel() != 0) print_debugs("");
+	fifo.put(tx, 3);
+	if (fifo.skipRead(2) != 0 || fifo.get(rcv) != 0 || rcv != 2) print_debugs("");
+	fifo.put(tx, 3);
+	if (fifo.flush() != 0 || fifo.hasElementsLeft()) print_debugs("");
+
+	// ** one producer and one consumer thread **
+	utils::Fifo<uint32_t, 64> shared;
+	std::thread producer([&shared]{
+		for (uint32_t i = 0; i < FIFO_N_TEST_ELEMENTS; i++)
+		{
+			while (shared.put(i) != 0)
+				std::this_thread::yield();	// keep the test fast on a single core
+		}
+	});
+	uint32_t errors = 0;
+	for (uint32_t i = 0; i < FIFO_N_TEST_ELEMENTS; i++)
+	{
+		while (shared.get(rcv) != 0)
+			std::this_thread::yield();
+		if (rcv != i) errors++;
+	}
+	producer.join();
+	if (errors != 0) print_debuginfo((int)errors);
+	printf("Test of Fifo<T, N> ended\n");
+}
+
+#define EXECUTOR_TEST_TASKS 10000
+
+/**
+ * @brief test of the Executor: futures, batches, the overflow queue, tasks that submit tasks and the shutdown
+ */
+static void testExecutor(void)
+{
+	printf("Test of Executor started\n");
+
+	// ** queue_size has to be a power of two **
+	bool thrown = false;
+	try
+	{
+		utils::Executor executor(1, 3, false);
+	}
+	catch (const std::invalid_argument&)
+	{
+		thrown = true;
+	}
+	if (!thrown) print_debugs("");
+
+	// ** a local fifo that can not be allocated **
+	thrown = false;
+	try
+	{
+		utils::Executor executor(1, (size_t)1 << (sizeof(size_t) * 8 - 2), false);
+	}
+	catch (const std::bad_alloc&)
+	{
+		thrown = true;
+	}
+	if (!thrown) print_debugs("");
+
+	// ** submit() with arguments, move only arguments, void and exceptions **
+	{
+		utils::Executor executor(2, 16);
+		if (executor.workers() != 2) print_debuginfo((int)executor.workers());
+		if (executor.submit([](int a, int b) { return a + b; }, 2, 3).get() != 5) print_debugs("");
+		std::unique_ptr<int> p(new int(7));
+		if (executor.submit([](std::unique_ptr<int> q) { return *q; }, std::move(p)).get() != 7) print_debugs("");
+		std::string text = "fifo";
+		auto length = executor.submit([](const std::string& s) { return s.size(); }, text);
+		text.clear();	// the argument is a copy
+		if (length.get() != 4) print_debuginfo((int)length.get());
+		std::atomic<int> done(0);
+		executor.submit([&done] { done++; }).get();
+		if (done != 1) print_debugs("");
+		auto failing = executor.submit([]() -> int { throw std::runtime_error("task"); });
+		thrown = false;
+		try
+		{
+			failing.get();
+		}
+		catch (const std::runtime_error&)
+		{
+			thrown = true;
+		}
+		if (!thrown) print_debugs("");
+	}
+
+	// ** submit_batch() returns the futures in the order of the callables **
+	{
+		utils::Executor executor(4, 16);
+		std::vector<std::function<int()>> tasks;
+		for (int i = 0; i < 100; i++)
+		{
+			tasks.push_back([i] { return i * i; });
+		}
+		auto futures = executor.submit_batch(tasks.begin(), tasks.end());
+		if (futures.size() != tasks.size()) print_debuginfo((int)futures.size());
+		for (int i = 0; i < (int)futures.size(); i++)
+		{
+			if (futures[i].get() != i * i) print_debuginfo(i);
+		}
+	}
+
+	// ** local fifos of 2 tasks, the rest goes into the overflow queue **
+	{
+		utils::Executor executor(2, 2, false);
+		std::atomic<uint32_t> done(0);
+		std::vector<std::future<void>> futures;
+		for (uint32_t i = 0; i < EXECUTOR_TEST_TASKS; i++)
+		{
+			futures.push_back(executor.submit([&done] { done++; }));
+		}
+		for (auto& future : futures)
+		{
+			future.get();
+		}
+		if (done != EXECUTOR_TEST_TASKS) print_debuginfo((int)done);
+	}
+
+	// ** a task submits tasks into its own fifo **
+	{
+		utils::Executor executor(2, 4, false);
+		auto parent = executor.submit([&executor] {
+			std::vector<std::future<int>> children;
+			for (int i = 0; i < 20; i++)
+			{
+				children.push_back(executor.submit([i] { return i; }));
+			}
+			return children;
+		});
+		auto children = parent.get();
+		if (children.size() != 20) print_debuginfo((int)children.size());
+		for (int i = 0; i < (int)children.size(); i++)
+		{
+			if (children[i].get() != i) print_debuginfo(i);
+		}
+	}
+
+	// ** the destructor runs the tasks still queued **
+	std::atomic<uint32_t> done(0);
+	{
+		utils::Executor executor(1, 4, false);
+		executor.submit([] { std::this_thread::sleep_for(std::chrono::milliseconds(20)); });
+		for (uint32_t i = 0; i < 100; i++)
+		{
+			executor.submit([&done] { done++; });
+		}
+	}
+	if (done != 100) print_debuginfo((int)done);
+	printf("Test of Executor ended\n");
+}
+#undef EXECUTOR_TEST_TASKS
+
+/**
+ * @brief this function is a test for the c++ wrappers of the FIFO Library
+ */
+int main(void)
+{
+	testFifoN();
+	testFifoNonTrivial();
+	testSegments();
+	testFifoDrain();
+	testExecutor();
+	return 0;
+}
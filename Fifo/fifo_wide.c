@@ -0,0 +1,57 @@
+/**
+ * @file fifo_wide.c
+ * @brief compiles fifo.c a second time with FIFO_WIDE_INDEX_TYPE indices and fifo_wide_ names
+ */
+// *** INCLUDES ***
+#ifndef _GNU_SOURCE
+#define _GNU_SOURCE     // memfd_create() for FIFO_MIRROR, fifo.c gets included after the system headers
+#endif
+#include "fifo_wide.h"
+
+// *** DEFINES ***
+#undef FIFO_INDEX_TYPE
+#define FIFO_INDEX_TYPE             FIFO_WIDE_INDEX_TYPE
+#undef MAX_FIFO_SIZE
+#define MAX_FIFO_SIZE               FIFO_WIDE_MAX_SIZE
+#define _FIFO_WIDE                  // compiles the functions that only make sense for wide fifos, eg fifo_init_mirror()
+
+#define fifo_handle_t               fifo_wide_handle_t
+#define fifo_init                   fifo_wide_init
+#define fifo_init_malloc            fifo_wide_init_malloc
+#define fifo_init_malloc_aligned    fifo_wide_init_malloc_aligned
+#define fifo_deinit_free            fifo_wide_deinit_free
+#define fifo_init_mirror            fifo_wide_init_mirror
+#define fifo_put                    fifo_wide_put
+#define fifo_get                    fifo_wide_get
+#define fifo_put_n                  fifo_wide_put_n
+#define fifo_get_n                  fifo_wide_get_n
+#define fifo_hasElementsLeft        fifo_wide_hasElementsLeft
+#define fifo_hasSpaceLeft           fifo_wide_hasSpaceLeft
+#define fifo_flush                  fifo_wide_flush
+#define fifo_getEndPtr              fifo_wide_getEndPtr
+#define fifo_skip_read              fifo_wide_skip_read
+#define fifo_skip_read_n            fifo_wide_skip_read_n
+#define fifo_skip_write             fifo_wide_skip_write
+#define fifo_skip_write_n           fifo_wide_skip_write_n
+#define fifo_getLevel               fifo_wide_getLevel
+#define fifo_getEmptySpace          fifo_wide_getEmptySpace
+#define fifo_setOverwrite           fifo_wide_setOverwrite
+#define fifo_getDropped             fifo_wide_getDropped
+#define fifo_setNotify              fifo_wide_setNotify
+#define fifo_openEventfd            fifo_wide_openEventfd
+#define fifo_closeEventfd           fifo_wide_closeEventfd
+#define fifo_write_reserve          fifo_wide_write_reserve
+#define fifo_write_commit           fifo_wide_write_commit
+#define fifo_read_peek              fifo_wide_read_peek
+#define fifo_read_release           fifo_wide_read_release
+#define fifo_drain                  fifo_wide_drain
+#define fifo_put_record             fifo_wide_put_record
+#define fifo_get_record             fifo_wide_get_record
+#define fifo_peek_record            fifo_wide_peek_record
+#define fifo_release_record         fifo_wide_release_record
+#define fifo_put_wait               fifo_wide_put_wait
+#define fifo_get_wait               fifo_wide_get_wait
+#define fifo_put_wait_until         fifo_wide_put_wait_until
+#define fifo_get_wait_until         fifo_wide_get_wait_until
+
+#include "fifo.c"
@@ -0,0 +1,117 @@
+/**
+ * @file fifo_wide.h
+ * @brief fifos with a wide index type, for fifo memory bigger than MAX_FIFO_SIZE
+ * fifo_wide_handle_t is the same fifo as fifo_handle_t, but its size and indices are FIFO_WIDE_INDEX_TYPE.
+ * Small fifos (fifo.h) and wide fifos can be used next to each other in the same program,
+ * the small fifos keep their FIFO_INDEX_TYPE indices.
+ * Every fifo_wide_ function behaves like the fifo_ function with the same name, see fifo.h
+ * @note fifo_wide.c compiles fifo.c a second time with the wide index type
+ * @author Josef Aschwanden
+ * @date Oct - 2026
+ * @version 1.0
+ */
+
+#ifndef _FIFO_WIDE_H_
+#define _FIFO_WIDE_H_
+
+// *** INCLUDES ***
+#include <stddef.h>
+#include "fifo.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// *** DEFINES ***
+/**
+ * @brief index type of the wide fifos, size_t by default, can be set to uint32_t from the build
+ */
+#ifndef FIFO_WIDE_INDEX_TYPE
+#define FIFO_WIDE_INDEX_TYPE    size_t
+#endif
+
+/**
+ * @brief maximum size of a wide fifo in bytes
+ */
+#ifndef FIFO_WIDE_MAX_SIZE
+#define FIFO_WIDE_MAX_SIZE      (((FIFO_WIDE_INDEX_TYPE)-1) / 2)
+#endif
+
+// *** TYPEDEF ***
+#define FIFO_HANDLE_NAME        fifo_wide_handle_t
+#define FIFO_HANDLE_INDEX_TYPE  FIFO_WIDE_INDEX_TYPE
+#include "fifo_handle.h"
+
+/** @defgroup fifo_wide Wide Fifo Functions
+ * @brief fifo functions for fifo_wide_handle_t
+ */
+
+/**
+ * @addtogroup fifo_wide
+ * @{
+ */
+int8_t fifo_wide_init(volatile fifo_wide_handle_t *pHandle, void *pFifo, FIFO_WIDE_INDEX_TYPE size_fifo, SIZE_FIFO_BASE_TYPE basetype_size);
+#if FIFO_ALLOW_MALLOC
+fifo_wide_handle_t* fifo_wide_init_malloc(FIFO_WIDE_INDEX_TYPE size_fifo, SIZE_FIFO_BASE_TYPE basetype_size);
+fifo_wide_handle_t* fifo_wide_init_malloc_aligned(FIFO_WIDE_INDEX_TYPE size_fifo, SIZE_FIFO_BASE_TYPE basetype_size, size_t alignment);
+void fifo_wide_deinit_free(volatile fifo_wide_handle_t *pHandle);
+#if FIFO_MIRROR
+/**
+ * @brief allocates a fifo handle and fifo memory that is mapped twice back to back, and initializes it
+ * @note only for wide fifos, the memory of a fifo_handle_t can never be a multiple of the page size
+ * @note memory has to be freed with fifo_wide_deinit_free()
+ * @param size_fifo size of the fifo in elements, size_fifo * basetype_size has to be a multiple of the page size
+ * @param basetype_size size of the fifo basetype eg: sizeof(uint8_t)
+ * @retval NULL = failed, invalid size or the memory could not be mapped
+ * @return pointer to the fifo handle
+ */
+fifo_wide_handle_t* fifo_wide_init_mirror(FIFO_WIDE_INDEX_TYPE size_fifo, SIZE_FIFO_BASE_TYPE basetype_size);
+#endif  /* FIFO_MIRROR */
+#endif  /* FIFO_ALLOW_MALLOC */
+fifoerror_t fifo_wide_put(volatile fifo_wide_handle_t *pHandle, const void *pData);
+fifoerror_t fifo_wide_get(volatile fifo_wide_handle_t *pHandle, void *pData);
+fifoerror_t fifo_wide_put_n(volatile fifo_wide_handle_t *pHandle, const void *pData, FIFO_WIDE_INDEX_TYPE n, FIFO_WIDE_INDEX_TYPE *pWritten);
+fifoerror_t fifo_wide_get_n(volatile fifo_wide_handle_t *pHandle, void *pData, FIFO_WIDE_INDEX_TYPE n, FIFO_WIDE_INDEX_TYPE *pRead);
+bool fifo_wide_hasElementsLeft(volatile fifo_wide_handle_t *pHandle);
+bool fifo_wide_hasSpaceLeft(volatile fifo_wide_handle_t *pHandle);
+fifoerror_t fifo_wide_flush(volatile fifo_wide_handle_t *pHandle);
+void *fifo_wide_getEndPtr(fifo_wide_handle_t *pHandle);
+fifoerror_t fifo_wide_skip_read(fifo_wide_handle_t *pHandle);
+fifoerror_t fifo_wide_skip_read_n(fifo_wide_handle_t *pHandle, FIFO_WIDE_INDEX_TYPE n);
+fifoerror_t fifo_wide_skip_write(fifo_wide_handle_t *pHandle);
+fifoerror_t fifo_wide_skip_write_n(fifo_wide_handle_t *pHandle, FIFO_WIDE_INDEX_TYPE n);
+FIFO_WIDE_INDEX_TYPE fifo_wide_getLevel(fifo_wide_handle_t *pHandle);
+FIFO_WIDE_INDEX_TYPE fifo_wide_getEmptySpace(fifo_wide_handle_t *pHandle);
+#if FIFO_OVERWRITE
+fifoerror_t fifo_wide_setOverwrite(volatile fifo_wide_handle_t *pHandle, bool overwrite);
+uint32_t fifo_wide_getDropped(volatile fifo_wide_handle_t *pHandle);
+#endif
+#if FIFO_NOTIFY
+fifoerror_t fifo_wide_setNotify(volatile fifo_wide_handle_t *pHandle, fifo_notify_callback_t callback, void *pCtx);
+int fifo_wide_openEventfd(volatile fifo_wide_handle_t *pHandle);
+fifoerror_t fifo_wide_closeEventfd(volatile fifo_wide_handle_t *pHandle, int fd);
+#endif
+fifoerror_t fifo_wide_write_reserve(volatile fifo_wide_handle_t *pHandle, FIFO_WIDE_INDEX_TYPE n, void **ppData, FIFO_WIDE_INDEX_TYPE *pContiguous);
+fifoerror_t fifo_wide_write_commit(volatile fifo_wide_handle_t *pHandle, FIFO_WIDE_INDEX_TYPE n);
+fifoerror_t fifo_wide_read_peek(volatile fifo_wide_handle_t *pHandle, FIFO_WIDE_INDEX_TYPE n, void **ppData, FIFO_WIDE_INDEX_TYPE *pContiguous);
+fifoerror_t fifo_wide_read_release(volatile fifo_wide_handle_t *pHandle, FIFO_WIDE_INDEX_TYPE n);
+fifoerror_t fifo_wide_drain(volatile fifo_wide_handle_t *pHandle, fifo_drain_callback_t callback, void *pCtx, FIFO_WIDE_INDEX_TYPE max_elems, FIFO_WIDE_INDEX_TYPE *pDrained);
+fifoerror_t fifo_wide_put_record(volatile fifo_wide_handle_t *pHandle, const void *pData, FIFO_WIDE_INDEX_TYPE len);
+fifoerror_t fifo_wide_get_record(volatile fifo_wide_handle_t *pHandle, void *pData, FIFO_WIDE_INDEX_TYPE max_len, FIFO_WIDE_INDEX_TYPE *pLen);
+fifoerror_t fifo_wide_peek_record(volatile fifo_wide_handle_t *pHandle, void **ppData, FIFO_WIDE_INDEX_TYPE *pLen);
+fifoerror_t fifo_wide_release_record(volatile fifo_wide_handle_t *pHandle);
+#if FIFO_WAIT
+fifoerror_t fifo_wide_put_wait(volatile fifo_wide_handle_t *pHandle, const void *pData, int32_t timeout_ms);
+fifoerror_t fifo_wide_get_wait(volatile fifo_wide_handle_t *pHandle, void *pData, int32_t timeout_ms);
+fifoerror_t fifo_wide_put_wait_until(volatile fifo_wide_handle_t *pHandle, const void *pData, const struct timespec *pDeadline);
+fifoerror_t fifo_wide_get_wait_until(volatile fifo_wide_handle_t *pHandle, void *pData, const struct timespec *pDeadline);
+#endif  /* FIFO_WAIT */
+/**
+ * @}
+ */
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif  // _FIFO_WIDE_H_
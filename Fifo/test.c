@@ -1,13 +1,1665 @@
 #include "test.h"
 #include "fifo.h"
+#include "fifo_mpmc.h"
+#include "fifo_wide.h"
+#include "fifo_shm.h"
+#include "fifo_spill.h"
+#include "fifo_bank.h"
+#include "fifo_prio.h"
+#include "fifo_set.h"
+#include "fifo_deque.h"
+#include "fifo_broadcast.h"
+#include <stddef.h>
+#include <stdlib.h>
+#include <string.h>
 #include <assert.h>
+#include <pthread.h>
+#include <sched.h>
+#include <time.h>
+#include <unistd.h>
+#include <sys/wait.h>
+#if FIFO_OVERWRITE
+#include <signal.h>
+#include <sys/mman.h>
+#endif
+#if FIFO_NOTIFY
+#include <poll.h>
+#include <sys/epoll.h>
+#endif
+
+#define BROADCAST_TEST_ELEMENTS 1000000
+
+typedef struct{
+	fifo_broadcast_t *pRing;
+	size_t consumer;
+	int8_t upstream[2];		// consumers that have to be past every element this one gets, -1 = none
+	uint64_t sum;
+}broadcastConsumer_t;
+
+static void *broadcastConsumer(void *pArg)
+{
+	broadcastConsumer_t *pConsumer = (broadcastConsumer_t *)pArg;
+	uint32_t expected = 0;
+	while (expected < BROADCAST_TEST_ELEMENTS)
+	{
+		uint32_t *pData;
+		size_t available;
+		if (fifo_broadcast_peek(pConsumer->pRing, pConsumer->consumer, (void **)&pData, &available) != FIFO_NO_ERROR)
+		{
+			sched_yield();
+			continue;
+		}
+		for (size_t i = 0; i < available; i++, expected++)
+		{
+			if (pData[i] != expected)
+			{
+				print_debuginfo(pData[i]);
+				return NULL;
+			}
+			pConsumer->sum += pData[i];
+		}
+		for (size_t i = 0; i < 2; i++)
+		{
+			if (pConsumer->upstream[i] >= 0 && __atomic_load_n(&pConsumer->pRing->cursor[pConsumer->upstream[i]].pos, __ATOMIC_ACQUIRE) < expected)
+				print_debugs("element seen before the consumer it depends on");
+		}
+		fifo_broadcast_release(pConsumer->pRing, pConsumer->consumer, available);
+	}
+	return NULL;
+}
+
+void testBroadcast(void)
+{
+	uint32_t dummy32 = 0, buffer[8];
+	fifo_broadcast_t ring;
+	printf("Test of fifo_broadcast_put() and fifo_broadcast_get() started\n");
+
+	if (fifo_broadcast_init(&ring, buffer, 6, sizeof(uint32_t)) != -2) 	print_debugs("");
+	if (fifo_broadcast_init(&ring, buffer, 8, 0) != -3) 					print_debugs("");
+	if (fifo_broadcast_init(NULL, buffer, 8, sizeof(uint32_t)) != -1) 	print_debugs("");
+	if (fifo_broadcast_init(&ring, buffer, 8, sizeof(uint32_t)) != 0) 	print_debugs("");
+	if (fifo_broadcast_addConsumer(&ring, 1) != -1) 						print_debugs("depends on a consumer that does not exist");
+	if (fifo_broadcast_addConsumer(&ring, 0) != 0) 						print_debugs("");
+	if (fifo_broadcast_addConsumer(&ring, 0) != 1) 						print_debugs("");
+	if (fifo_broadcast_addConsumer(&ring, 1 << 0) != 2) 					print_debugs("");
+	if (fifo_broadcast_get(&ring, 3, &dummy32) != FIFO_WRONG_PARAM) 		print_debugs("");
+	if (fifo_broadcast_get(&ring, 0, &dummy32) != FIFO_EMPTY) 			print_debugs("");
+
+	// ** every consumer gets every element, the producer waits for the slowest **
+	for (uint32_t i = 0; i < 8; i++)
+	{
+		if (fifo_broadcast_put(&ring, &i) != FIFO_NO_ERROR) print_debuginfo(i);
+	}
+	if (fifo_broadcast_put(&ring, &dummy32) != FIFO_FULL) 	print_debugs("");
+	if (fifo_broadcast_get(&ring, 2, &dummy32) != FIFO_EMPTY) print_debugs("consumer 2 depends on consumer 0");
+	for (uint32_t i = 0; i < 8; i++)
+	{
+		if (fifo_broadcast_get(&ring, 0, &dummy32), dummy32 != i) print_debuginfo(dummy32);
+	}
+	if (fifo_broadcast_get(&ring, 0, &dummy32) != FIFO_EMPTY) 	print_debugs("");
+	if (fifo_broadcast_put(&ring, &dummy32) != FIFO_FULL) 		print_debugs("consumers 1 and 2 did not read");
+	if (fifo_broadcast_getLevel(&ring, 1) != 8) 					print_debugs("");
+	for (uint32_t i = 0; i < 8; i++)
+	{
+		if (fifo_broadcast_get(&ring, 1, &dummy32), dummy32 != i) print_debuginfo(dummy32);
+	}
+	uint32_t *pData;
+	size_t available;
+	if (fifo_broadcast_peek(&ring, 2, (void **)&pData, &available) != FIFO_NO_ERROR || available != 8 || pData != buffer) print_debugs("");
+	if (fifo_broadcast_release(&ring, 2, 9) != FIFO_WRONG_PARAM) 	print_debugs("");
+	fifo_broadcast_release(&ring, 2, 3);
+	for (uint32_t i = 8; i < 11; i++)
+	{
+		if (fifo_broadcast_put(&ring, &i) != FIFO_NO_ERROR) print_debuginfo(i);
+	}
+	if (fifo_broadcast_put(&ring, &dummy32) != FIFO_FULL) 	print_debugs("");
+	// ** the elements that wrap around the end are returned in two pieces **
+	if (fifo_broadcast_peek(&ring, 2, (void **)&pData, &available) != FIFO_NO_ERROR || available != 5 || pData[0] != 3) print_debugs("");
+	fifo_broadcast_release(&ring, 2, 5);
+	if (fifo_broadcast_peek(&ring, 2, (void **)&pData, &available) != FIFO_EMPTY) print_debugs("consumer 0 has not read 8 to 10");
+	for (uint32_t i = 8; i < 11; i++)
+	{
+		fifo_broadcast_get(&ring, 0, &dummy32);
+	}
+	if (fifo_broadcast_peek(&ring, 2, (void **)&pData, &available) != FIFO_NO_ERROR || available != 3 || pData[2] != 10) print_debugs("");
+
+	// ** pipeline: consumers 0 and 1 in parallel, consumer 2 after both of them **
+	fifo_broadcast_t *pRing = fifo_broadcast_init_malloc(1024, sizeof(uint32_t));
+	broadcastConsumer_t consumers[3] = {
+		{ pRing, 0, {-1, -1}, 0 },
+		{ pRing, 0, {-1, -1}, 0 },
+		{ pRing, 0, {0, 1}, 0 },
+	};
+	consumers[0].consumer = fifo_broadcast_addConsumer(pRing, 0);
+	consumers[1].consumer = fifo_broadcast_addConsumer(pRing, 0);
+	consumers[2].consumer = fifo_broadcast_addConsumer(pRing, (1 << 0) | (1 << 1));
+	pthread_t threads[3];
+	for (uint32_t i = 0; i < 3; i++)
+	{
+		pthread_create(&threads[i], NULL, broadcastConsumer, &consumers[i]);
+	}
+	for (uint32_t i = 0; i < BROADCAST_TEST_ELEMENTS; i++)
+	{
+		while (fifo_broadcast_put(pRing, &i) == FIFO_FULL) sched_yield();
+	}
+	for (uint32_t i = 0; i < 3; i++)
+	{
+		pthread_join(threads[i], NULL);
+		if (consumers[i].sum != (uint64_t)BROADCAST_TEST_ELEMENTS * (BROADCAST_TEST_ELEMENTS -1) / 2) print_debuginfo(i);
+	}
+	fifo_broadcast_deinit_free(pRing);
+	printf("Test of fifo_broadcast_put() and fifo_broadcast_get() ended\n");
+}
+#undef BROADCAST_TEST_ELEMENTS
+
+#define DEQUE_TEST_THIEVES 3
+#define DEQUE_TEST_ELEMENTS 1000000
+
+static uint8_t dequeSeen[DEQUE_TEST_ELEMENTS];
+static uint32_t dequeTaken;
+static bool dequeDone;
+
+static void dequeTake(uint32_t value)
+{
+	if (value >= DEQUE_TEST_ELEMENTS || __atomic_fetch_add(&dequeSeen[value], 1, __ATOMIC_RELAXED) != 0) print_debuginfo(value);
+	__atomic_fetch_add(&dequeTaken, 1, __ATOMIC_RELAXED);
+}
+
+static void *dequeThief(void *pDeque)
+{
+	uint32_t value;
+	while (!__atomic_load_n(&dequeDone, __ATOMIC_ACQUIRE))
+	{
+		if (fifo_deque_steal(pDeque, &value) == FIFO_NO_ERROR)
+			dequeTake(value);
+	}
+	return NULL;
+}
+
+void testDeque(void)
+{
+	uint32_t dummy32 = 0, buffer[4];
+	fifo_deque_t deque;
+	printf("Test of fifo_deque_push(), fifo_deque_pop() and fifo_deque_steal() started\n");
+
+	if (fifo_deque_init(&deque, buffer, 3, sizeof(uint32_t)) != -2) 	print_debugs("");
+	if (fifo_deque_init(&deque, buffer, 4, 0) != -3) 					print_debugs("");
+	if (fifo_deque_init(NULL, buffer, 4, sizeof(uint32_t)) != -1) 		print_debugs("");
+	if (fifo_deque_init(&deque, buffer, 4, sizeof(uint32_t)) != 0) 		print_debugs("");
+	if (fifo_deque_pop(&deque, &dummy32) != FIFO_EMPTY) 					print_debugs("");
+	if (fifo_deque_steal(&deque, &dummy32) != FIFO_EMPTY) 				print_debugs("");
+
+	// ** the owner pops the newest, thieves steal the oldest, the array grows past the caller buffer **
+	for (uint32_t i = 0; i < 10; i++)
+	{
+		if (fifo_deque_push(&deque, &i) != FIFO_NO_ERROR) print_debuginfo(i);
+	}
+	if (deque.pArray == &deque.first || deque.pArray->mask != 15) 	print_debugs("array did not grow");
+	if (fifo_deque_getLevel(&deque) != 10) 							print_debugs("");
+	if (fifo_deque_pop(&deque, &dummy32), dummy32 != 9) 				print_debuginfo(dummy32);
+	if (fifo_deque_steal(&deque, &dummy32), dummy32 != 0) 			print_debuginfo(dummy32);
+	if (fifo_deque_steal(&deque, &dummy32), dummy32 != 1) 			print_debuginfo(dummy32);
+	for (uint32_t i = 8; i > 1; i--)
+	{
+		if (fifo_deque_pop(&deque, &dummy32) != FIFO_NO_ERROR || dummy32 != i) print_debuginfo(dummy32);
+	}
+	if (fifo_deque_pop(&deque, &dummy32) != FIFO_EMPTY) 		print_debugs("");
+	if (fifo_deque_steal(&deque, &dummy32) != FIFO_EMPTY) 	print_debugs("");
+	if (fifo_deque_getLevel(&deque) != 0) 					print_debugs("");
+	fifo_deque_deinit(&deque);
+
+	// ** owner and thieves at the same time, every element is taken exactly once **
+	fifo_deque_t *pDeque = fifo_deque_init_malloc(2, sizeof(uint32_t));
+	pthread_t thief[DEQUE_TEST_THIEVES];
+	memset(dequeSeen, 0, sizeof(dequeSeen));
+	dequeTaken = 0;
+	dequeDone = false;
+	for (uint32_t i = 0; i < DEQUE_TEST_THIEVES; i++)
+	{
+		pthread_create(&thief[i], NULL, dequeThief, pDeque);
+	}
+	for (uint32_t i = 0; i < DEQUE_TEST_ELEMENTS; i++)
+	{
+		if (fifo_deque_push(pDeque, &i) != FIFO_NO_ERROR) print_debuginfo(i);
+		if (i % 3 == 0 && fifo_deque_pop(pDeque, &dummy32) == FIFO_NO_ERROR)
+			dequeTake(dummy32);
+	}
+	while (fifo_deque_pop(pDeque, &dummy32) == FIFO_NO_ERROR)
+	{
+		dequeTake(dummy32);
+	}
+	__atomic_store_n(&dequeDone, true, __ATOMIC_RELEASE);
+	for (uint32_t i = 0; i < DEQUE_TEST_THIEVES; i++)
+	{
+		pthread_join(thief[i], NULL);
+	}
+	if (dequeTaken != DEQUE_TEST_ELEMENTS) print_debuginfo(dequeTaken);
+	fifo_deque_deinit_free(pDeque);
+	printf("Test of fifo_deque_push(), fifo_deque_pop() and fifo_deque_steal() ended\n");
+}
+#undef DEQUE_TEST_THIEVES
+#undef DEQUE_TEST_ELEMENTS
+
+#if FIFO_NOTIFY
+#define SET_TEST_FIFOS 200
+#define SET_TEST_ELEMENTS 1000000
+
+static void countNotify(void *pCount)
+{
+	(*(uint32_t *)pCount)++;
+}
+
+static void *setProducer(void *ppFifos)
+{
+	fifo_handle_t **ppFifo = (fifo_handle_t **)ppFifos;
+	for (uint32_t i = 1; i <= SET_TEST_ELEMENTS; i++)
+	{
+		while (fifo_put(ppFifo[(i / 8) % SET_TEST_FIFOS], &i) == FIFO_FULL) sched_yield();
+		if (i % 100000 == 0) usleep(1000);		// let the consumer park
+	}
+	return NULL;
+}
+
+void testSet(void)
+{
+	uint32_t dummy32 = 0, notified = 0;
+	fifo_handle_t *pFifo[SET_TEST_FIFOS], *ready[SET_TEST_FIFOS];
+	size_t idx;
+	printf("Test of fifo_set_wait() started\n");
+
+	// ** the callback only comes on the empty -> non-empty transition **
+	pFifo[0] = fifo_init_malloc(8, sizeof(uint32_t));
+	if (fifo_setNotify(pFifo[0], countNotify, &notified) != FIFO_NO_ERROR) 	print_debugs("");
+	for (uint32_t i = 0; i < 3; i++)
+	{
+		fifo_put(pFifo[0], &i);
+	}
+	if (notified != 1) print_debuginfo(notified);
+	fifo_get(pFifo[0], &dummy32);
+	fifo_put_n(pFifo[0], &dummy32, 1, NULL);
+	if (notified != 1) print_debuginfo(notified);
+	while (fifo_get(pFifo[0], &dummy32) == FIFO_NO_ERROR);
+	fifo_put_n(pFifo[0], &dummy32, 1, NULL);
+	if (notified != 2) print_debuginfo(notified);
+	fifo_skip_write_n(pFifo[0], 0);
+	fifo_flush(pFifo[0]);
+	fifo_skip_write_n(pFifo[0], 0);
+	if (notified != 2) print_debuginfo(notified);
+	fifo_setNotify(pFifo[0], NULL, NULL);
+
+	// ** only the fifos with elements are returned **
+	fifo_set_t *pSet = fifo_set_init_malloc(SET_TEST_FIFOS);
+	if (pSet == NULL)
+	{
+		print_debugs("Allocation failed");
+		assert(0);
+	}
+	for (uint32_t i = 1; i < SET_TEST_FIFOS; i++)
+	{
+		pFifo[i] = fifo_init_malloc(8, sizeof(uint32_t));
+	}
+	fifo_put(pFifo[150], &dummy32);		// put before the fifo is added
+	for (uint32_t i = 0; i < SET_TEST_FIFOS; i++)
+	{
+		if (fifo_set_add(pSet, pFifo[i], &idx) != FIFO_NO_ERROR || idx != i) print_debuginfo(i);
+	}
+	if (fifo_set_add(pSet, pFifo[0], NULL) != FIFO_FULL) 	print_debugs("");
+	if (fifo_set_wait(pSet, 0, ready, SET_TEST_FIFOS) != 1 || ready[0] != pFifo[150]) print_debugs("");
+	fifo_put(pFifo[70], &dummy32);
+	fifo_put(pFifo[70], &dummy32);
+	if (fifo_set_wait(pSet, 0, ready, 1) != 1 || ready[0] != pFifo[70]) 	print_debugs("");
+	fifo_get(pFifo[70], &dummy32);
+	if (fifo_set_wait(pSet, 0, ready, SET_TEST_FIFOS) != 2 || ready[1] != pFifo[150]) 	print_debugs("a fifo with elements is returned again");
+	fifo_get(pFifo[70], &dummy32);
+	fifo_get(pFifo[150], &dummy32);
+	struct timespec start, end;
+	clock_gettime(CLOCK_MONOTONIC, &start);
+	if (fifo_set_wait(pSet, 20, ready, SET_TEST_FIFOS) != 0) print_debugs("");
+	clock_gettime(CLOCK_MONOTONIC, &end);
+	if ((end.tv_sec - start.tv_sec) * 1000 + (end.tv_nsec - start.tv_nsec) / 1000000 < 19) print_debugs("timeout too short");
+	if (pSet->pReady[70 / 64] != 0 || pSet->pReady[150 / 64] != 0) print_debugs("bits of empty fifos not cleared");
+	fifo_put(pFifo[3], &dummy32);
+	if (fifo_set_remove(pSet, 3) != FIFO_NO_ERROR) print_debugs("");
+	if (fifo_set_wait(pSet, 0, ready, SET_TEST_FIFOS) != 0) print_debugs("");
+	fifo_get(pFifo[3], &dummy32);
+	fifo_set_add(pSet, pFifo[3], NULL);
+
+	// ** a parked consumer gets every element **
+	pthread_t producer;
+	uint64_t sum = 0;
+	uint32_t received = 0;
+	pthread_create(&producer, NULL, setProducer, pFifo);
+	while (received < SET_TEST_ELEMENTS)
+	{
+		size_t count = fifo_set_wait(pSet, 1000, ready, SET_TEST_FIFOS);
+		if (count == 0)
+		{
+			print_debugs("elements lost");
+			break;
+		}
+		for (size_t i = 0; i < count; i++)
+		{
+			while (fifo_get(ready[i], &dummy32) == FIFO_NO_ERROR)
+			{
+				sum += dummy32;
+				received++;
+			}
+		}
+	}
+	pthread_join(producer, NULL);
+	if (sum != (uint64_t)SET_TEST_ELEMENTS * (SET_TEST_ELEMENTS +1) / 2) print_debugs("");
+
+	fifo_set_deinit_free(pSet);
+	for (uint32_t i = 0; i < SET_TEST_FIFOS; i++)
+	{
+		fifo_deinit_free(pFifo[i]);
+	}
+	printf("Test of fifo_set_wait() ended\n");
+}
+#undef SET_TEST_FIFOS
+#undef SET_TEST_ELEMENTS
+
+#define EVENTFD_TEST_ELEMENTS 1000000
+
+static void *eventfdProducer(void *pWide)
+{
+	for (uint32_t i = 1; i <= EVENTFD_TEST_ELEMENTS; i++)
+	{
+		while (fifo_wide_put(pWide, &i) == FIFO_FULL) sched_yield();
+		if (i % 100000 == 0) usleep(1000);		// let the consumer sleep in epoll_wait()
+	}
+	return NULL;
+}
+
+static bool isReadable(int fd)
+{
+	struct pollfd pfd = { .fd = fd, .events = POLLIN };
+	return poll(&pfd, 1, 0) == 1;
+}
+
+void testEventfd(void)
+{
+	uint32_t dummy32 = 0;
+	uint64_t counter;
+	printf("Test of fifo_openEventfd() started\n");
+
+	// ** readable on the empty -> non-empty transition only **
+	fifo_handle_t *pHandle = fifo_init_malloc(8, sizeof(uint32_t));
+	fifo_put(pHandle, &dummy32);
+	int fd = fifo_openEventfd(pHandle);
+	if (fd < 0)
+	{
+		print_debugs("eventfd failed");
+		return;
+	}
+	if (!isReadable(fd)) 	print_debugs("elements put before open");
+	if (read(fd, &counter, sizeof(counter)) != sizeof(counter) || counter != 1) print_debugs("");
+	fifo_get(pHandle, &dummy32);
+	if (isReadable(fd)) 		print_debugs("");
+	fifo_put(pHandle, &dummy32);
+	if (!isReadable(fd)) 	print_debugs("");
+	read(fd, &counter, sizeof(counter));
+	fifo_put(pHandle, &dummy32);
+	fifo_put(pHandle, &dummy32);
+	if (isReadable(fd)) 		print_debugs("fifo was not empty");
+	if (fifo_closeEventfd(pHandle, fd) != FIFO_NO_ERROR) print_debugs("");
+	fifo_flush(pHandle);
+	fifo_put(pHandle, &dummy32);		// no callback after close
+	fifo_deinit_free(pHandle);
+
+	// ** a consumer sleeping in epoll_wait() gets every element **
+	fifo_wide_handle_t *pWide = fifo_wide_init_malloc(256, sizeof(uint32_t));
+	fd = fifo_wide_openEventfd(pWide);
+	int epfd = epoll_create1(0);
+	struct epoll_event ev = { .events = EPOLLIN, .data.fd = fd };
+	epoll_ctl(epfd, EPOLL_CTL_ADD, fd, &ev);
+	pthread_t producer;
+	uint64_t sum = 0, signals = 0;
+	uint32_t received = 0;
+	pthread_create(&producer, NULL, eventfdProducer, pWide);
+	while (received < EVENTFD_TEST_ELEMENTS)
+	{
+		if (epoll_wait(epfd, &ev, 1, 1000) != 1)
+		{
+			print_debugs("elements lost");
+			break;
+		}
+		if (read(fd, &counter, sizeof(counter)) == sizeof(counter))		// read first, then drain
+			signals += counter;
+		while (fifo_wide_get(pWide, &dummy32) == FIFO_NO_ERROR)
+		{
+			sum += dummy32;
+			received++;
+		}
+	}
+	pthread_join(producer, NULL);
+	if (sum != (uint64_t)EVENTFD_TEST_ELEMENTS * (EVENTFD_TEST_ELEMENTS +1) / 2) print_debugs("");
+	if (signals > received) print_debugs("");
+	close(epfd);
+	fifo_wide_closeEventfd(pWide, fd);
+	fifo_wide_deinit_free(pWide);
+	printf("Test of fifo_openEventfd() ended\n");
+}
+#undef EVENTFD_TEST_ELEMENTS
+
+#define WAKEUP_TEST_TRANSITIONS 200000
+
+static void *wakeupProducer(void *pWide)
+{
+	for (uint32_t i = 1; i <= WAKEUP_TEST_TRANSITIONS; i++)
+	{
+		while (fifo_wide_hasElementsLeft(pWide));	// put right when the consumer emptied the fifo
+		fifo_wide_put(pWide, &i);
+	}
+	return NULL;
+}
+
+void testEventfdWakeup(void)
+{
+	uint32_t dummy32 = 0, received = 0;
+	uint64_t counter;
+	printf("Test of fifo_openEventfd() wakeups started\n");
+
+	// ** every put is an empty -> non-empty transition racing with the consumer that just emptied the fifo **
+	fifo_wide_handle_t *pWide = fifo_wide_init_malloc(16, sizeof(uint32_t));
+	int fd = fifo_wide_openEventfd(pWide);
+	if (fd < 0)
+	{
+		print_debugs("eventfd failed");
+		fifo_wide_deinit_free(pWide);
+		return;
+	}
+	pthread_t producer;
+	pthread_create(&producer, NULL, wakeupProducer, pWide);
+	while (received < WAKEUP_TEST_TRANSITIONS)
+	{
+		struct pollfd pfd = { .fd = fd, .events = POLLIN };
+		if (poll(&pfd, 1, 1000) != 1)
+		{
+			print_debuginfo((int)received);		// the fifo holds an element, but the eventfd was not signaled
+			break;
+		}
+		read(fd, &counter, sizeof(counter));		// read first, then drain
+		while (fifo_wide_get(pWide, &dummy32) == FIFO_NO_ERROR)
+		{
+			if (dummy32 != ++received) print_debuginfo((int)dummy32);
+		}
+	}
+	while (received < WAKEUP_TEST_TRANSITIONS)		// after a lost wakeup, let the producer finish
+	{
+		if (fifo_wide_get(pWide, &dummy32) == FIFO_NO_ERROR) received++;
+	}
+	pthread_join(producer, NULL);
+	fifo_wide_closeEventfd(pWide, fd);		// after the producer was joined
+	fifo_wide_deinit_free(pWide);
+	printf("Test of fifo_openEventfd() wakeups ended\n");
+}
+#undef WAKEUP_TEST_TRANSITIONS
+#endif
+
+#define PRIO_TEST_ELEMENTS 1000000
+
+static void *prioProducer(void *pPrio)
+{
+	for (uint32_t i = 1; i <= PRIO_TEST_ELEMENTS; i++)
+	{
+		while (fifo_prio_put(pPrio, i % 3, &i) == FIFO_FULL) sched_yield();
+	}
+	return NULL;
+}
+
+void testPrio(void)
+{
+	uint32_t dummy32 = 0;
+	size_t priority;
+	printf("Test of fifo_prio_put() and fifo_prio_get() started\n");
+
+	if (fifo_prio_init_malloc(0, 8, sizeof(uint32_t)) != NULL) 						print_debugs("");
+	if (fifo_prio_init_malloc(FIFO_PRIO_MAX_LANES +1, 8, sizeof(uint32_t)) != NULL) 	print_debugs("");
+	fifo_prio_t *pPrio = fifo_prio_init_malloc(3, 8, sizeof(uint32_t));
+	if (pPrio == NULL)
+	{
+		print_debugs("Allocation failed");
+		assert(0);
+	}
+	if (fifo_prio_put(NULL, 0, &dummy32) != FIFO_WRONG_PARAM) 	print_debugs("");
+	if (fifo_prio_put(pPrio, 3, &dummy32) != FIFO_WRONG_PARAM) 	print_debugs("");
+	if (fifo_prio_get(pPrio, NULL, NULL) != FIFO_WRONG_PARAM) 	print_debugs("");
+	if (fifo_prio_get(pPrio, &dummy32, NULL) != FIFO_EMPTY) 		print_debugs("");
+
+	// ** higher priorities overtake, every lane keeps its order **
+	for (uint32_t i = 0; i < 4; i++)
+	{
+		uint32_t value = 200 + i;
+		fifo_prio_put(pPrio, 2, &value);
+		value = 100 + i;
+		fifo_prio_put(pPrio, 1, &value);
+	}
+	if (fifo_prio_get(pPrio, &dummy32, &priority) != FIFO_NO_ERROR || dummy32 != 100 || priority != 1) print_debuginfo(dummy32);
+	dummy32 = 0;
+	fifo_prio_put(pPrio, 0, &dummy32);
+	if (fifo_prio_getLevel(pPrio) != 8) print_debugs("");
+	if (fifo_prio_get(pPrio, &dummy32, &priority) != FIFO_NO_ERROR || dummy32 != 0 || priority != 0) print_debuginfo(dummy32);
+	for (uint32_t i = 1; i < 4; i++)
+	{
+		if (fifo_prio_get(pPrio, &dummy32, NULL), dummy32 != 100 + i) print_debuginfo(dummy32);
+	}
+	for (uint32_t i = 0; i < 4; i++)
+	{
+		if (fifo_prio_get(pPrio, &dummy32, &priority), dummy32 != 200 + i || priority != 2) print_debuginfo(dummy32);
+	}
+	if (fifo_prio_get(pPrio, &dummy32, NULL) != FIFO_EMPTY) print_debugs("");
+	if (pPrio->ready != 0) print_debugs("lane still marked as ready");
+	fifo_prio_deinit_free(pPrio);
+
+	// ** a lane that already holds elements is ready after init **
+	fifo_handle_t *pLanes[2] = { fifo_init_malloc(8, sizeof(uint32_t)), fifo_init_malloc(8, sizeof(uint32_t)) };
+	fifo_prio_t prio;
+	dummy32 = 7;
+	fifo_put(pLanes[1], &dummy32);
+	if (fifo_prio_init(&prio, pLanes, 2) != 0) 	print_debugs("");
+	if (fifo_prio_get(&prio, &dummy32, &priority) != FIFO_NO_ERROR || dummy32 != 7 || priority != 1) print_debuginfo(dummy32);
+	fifo_deinit_free(pLanes[0]);
+	fifo_deinit_free(pLanes[1]);
+
+	// ** producer and consumer at the same time, no element is left behind a cleared bit **
+	pPrio = fifo_prio_init_malloc(3, 16, sizeof(uint32_t));
+	uint32_t last[3] = {0, 0, 0}, received = 0;
+	pthread_t producer;
+	pthread_create(&producer, NULL, prioProducer, pPrio);
+	while (received < PRIO_TEST_ELEMENTS)
+	{
+		if (fifo_prio_get(pPrio, &dummy32, &priority) != FIFO_NO_ERROR)
+		{
+			sched_yield();
+			continue;
+		}
+		if (priority != dummy32 % 3 || dummy32 <= last[priority])
+		{
+			print_debuginfo(dummy32);
+			break;
+		}
+		last[priority] = dummy32;
+		received++;
+	}
+	pthread_join(producer, NULL);
+	if (fifo_prio_getLevel(pPrio) != 0) print_debugs("");
+	fifo_prio_deinit_free(pPrio);
+	printf("Test of fifo_prio_put() and fifo_prio_get() ended\n");
+}
+#undef PRIO_TEST_ELEMENTS
+
+#define BANK_TEST_FIFOS 10000
+
+void testBank(void)
+{
+	uint32_t dummy32 = 0;
+	fifo_bank_t bank;
+	printf("Test of fifo_bank_put() and fifo_bank_get() started\n");
+
+	if (fifo_bank_init_malloc(8, 12, sizeof(uint32_t)) != NULL) 		print_debugs("");	// not a power of two
+	if (fifo_bank_init_malloc(8, 1 << 16, sizeof(uint32_t)) != NULL) 	print_debugs("");	// too big for the index type
+	if (fifo_bank_init_malloc(0, 4, sizeof(uint32_t)) != NULL) 		print_debugs("");	// no fifos
+	if (fifo_bank_init(&bank, &dummy32, 8, 4, 0) != -3) 				print_debugs("");
+	if (fifo_bank_init(NULL, &dummy32, 8, 4, 4) != -1) 				print_debugs("");
+	// ** the overhead per fifo is its two indices **
+	if (fifo_bank_memSize(BANK_TEST_FIFOS, 4, sizeof(uint32_t)) > BANK_TEST_FIFOS * (4 * sizeof(uint32_t) + 2 * sizeof(FIFO_BANK_INDEX_TYPE)) + FIFO_CACHE_LINE_SIZE)
+		print_debugs("");
+
+	fifo_bank_t *pBank = fifo_bank_init_malloc(BANK_TEST_FIFOS, 4, sizeof(uint32_t));
+	if (pBank == NULL)
+	{
+		print_debugs("Allocation failed");
+		assert(0);
+	}
+	if (fifo_bank_put(NULL, 0, &dummy32) != FIFO_WRONG_PARAM) 				print_debugs("");
+	if (fifo_bank_put(pBank, BANK_TEST_FIFOS, &dummy32) != FIFO_WRONG_PARAM) 	print_debugs("");
+	if (fifo_bank_get(pBank, 0, NULL) != FIFO_WRONG_PARAM) 					print_debugs("");
+	if (fifo_bank_get(pBank, 0, &dummy32) != FIFO_EMPTY) 						print_debugs("");
+	if (fifo_bank_nextNonEmpty(pBank, 0) != BANK_TEST_FIFOS) 					print_debugs("");
+	if (fifo_bank_nextNonEmpty(NULL, 0) != SIZE_MAX) 							print_debugs("");
+
+	// ** every slot can be used, the fifos do not touch each other **
+	for (uint32_t j = 0; j < 3; j++)
+	{
+		for (uint32_t i = 0; i < 4; i++)
+		{
+			uint32_t value = i + 100 * j;
+			if (fifo_bank_put(pBank, 7, &value) != FIFO_NO_ERROR) 	print_debuginfo(i);
+			value = ~value;
+			if (fifo_bank_put(pBank, 8, &value) != FIFO_NO_ERROR) 	print_debuginfo(i);
+		}
+		if (fifo_bank_put(pBank, 7, &dummy32) != FIFO_FULL) 	print_debugs("");
+		if (fifo_bank_getLevel(pBank, 7) != 4) 				print_debugs("");
+		if (fifo_bank_getLevel(pBank, 6) != 0) 				print_debugs("");
+		for (uint32_t i = 0; i < 4; i++)
+		{
+			if (fifo_bank_get(pBank, 7, &dummy32), dummy32 != i + 100 * j) 		print_debuginfo(dummy32);
+			if (fifo_bank_get(pBank, 8, &dummy32), dummy32 != ~(i + 100 * j)) 	print_debuginfo(dummy32);
+		}
+		if (fifo_bank_get(pBank, 7, &dummy32) != FIFO_EMPTY) 	print_debugs("");
+	}
+
+	// ** sweep over the fifos with data **
+	for (uint32_t i = 0; i < BANK_TEST_FIFOS; i += 7)
+	{
+		if (fifo_bank_put(pBank, i, &i) != FIFO_NO_ERROR) print_debuginfo(i);
+	}
+	uint32_t found = 0;
+	for (size_t i = fifo_bank_nextNonEmpty(pBank, 0); i < BANK_TEST_FIFOS; i = fifo_bank_nextNonEmpty(pBank, i +1))
+	{
+		if (i % 7 != 0 || (fifo_bank_get(pBank, i, &dummy32), dummy32 != i)) print_debuginfo((int)i);
+		found++;
+	}
+	if (found != (BANK_TEST_FIFOS + 6) / 7) 				print_debuginfo(found);
+	if (fifo_bank_nextNonEmpty(pBank, 0) != BANK_TEST_FIFOS) 	print_debugs("");
+	fifo_bank_put(pBank, 3, &dummy32);
+	if (fifo_bank_flush(pBank, 3) != FIFO_NO_ERROR || fifo_bank_getLevel(pBank, 3) != 0) print_debugs("");
+
+	fifo_bank_deinit_free(pBank);
+	printf("Test of fifo_bank_put() and fifo_bank_get() ended\n");
+}
+#undef BANK_TEST_FIFOS
+
+#define MPMC_TEST_THREADS   4
+#define MPMC_TEST_ELEMENTS  200000     // per producer
+
+static volatile uint64_t mpmcSum;
+
+static void *mpmcProducer(void *pHandle)
+{
+	for (uint32_t i = 1; i <= MPMC_TEST_ELEMENTS; i++)
+	{
+		while (fifo_mpmc_put(pHandle, &i) != FIFO_NO_ERROR) sched_yield();
+	}
+	return NULL;
+}
+
+static void *mpmcConsumer(void *pHandle)
+{
+	uint64_t sum = 0;
+	for (uint32_t i = 0, rcv; i < MPMC_TEST_ELEMENTS; i++)
+	{
+		while (fifo_mpmc_get(pHandle, &rcv) != FIFO_NO_ERROR) sched_yield();
+		sum += rcv;
+	}
+	__atomic_fetch_add(&mpmcSum, sum, __ATOMIC_RELAXED);
+	return NULL;
+}
+
+void testMpmc(void)
+{
+	uint32_t dummy32 = 0;
+	pthread_t producer[MPMC_TEST_THREADS], consumer[MPMC_TEST_THREADS];
+	printf("Test of fifo_mpmc_put() and fifo_mpmc_get() started\n");
+
+	if (fifo_mpmc_init_malloc(12, sizeof(uint32_t)) != NULL) 	print_debugs("");	// not a power of two
+	if (fifo_mpmc_init_malloc(16, 0) != NULL) 					print_debugs("");	// basetype size of 0
+	fifo_mpmc_handle_t *pHandle = fifo_mpmc_init_malloc(16, sizeof(uint32_t));
+	if (pHandle == NULL)
+	{
+		print_debugs("Allocation failed");
+		assert(0);
+	}
+	if (fifo_mpmc_put(NULL, &dummy32) != FIFO_WRONG_PARAM) 	print_debugs("");
+	if (fifo_mpmc_put(pHandle, NULL) != FIFO_WRONG_PARAM) 	print_debugs("");
+	if (fifo_mpmc_get(pHandle, NULL) != FIFO_WRONG_PARAM) 	print_debugs("");
+	if (fifo_mpmc_get(pHandle, &dummy32) != FIFO_EMPTY) 	print_debugs("");
+
+	// ** single thread, every slot can be used **
+	for (uint32_t j = 0; j < 3; j++)
+	{
+		for (uint32_t i = 0; i < 16; i++)
+		{
+			if (fifo_mpmc_put(pHandle, &i) != FIFO_NO_ERROR) print_debuginfo(i);
+		}
+		if (fifo_mpmc_put(pHandle, &dummy32) != FIFO_FULL) 	print_debugs("");
+		if (fifo_mpmc_getLevel(pHandle) != 16) 				print_debugs("");
+		for (uint32_t i = 0; i < 16; i++)
+		{
+			if (fifo_mpmc_get(pHandle, &dummy32), dummy32 != i) print_debuginfo(dummy32);
+		}
+		if (fifo_mpmc_get(pHandle, &dummy32) != FIFO_EMPTY) print_debugs("");
+	}
+
+	// ** multiple producers and consumers **
+	mpmcSum = 0;
+	for (uint32_t i = 0; i < MPMC_TEST_THREADS; i++)
+	{
+		pthread_create(&producer[i], NULL, mpmcProducer, pHandle);
+		pthread_create(&consumer[i], NULL, mpmcConsumer, pHandle);
+	}
+	for (uint32_t i = 0; i < MPMC_TEST_THREADS; i++)
+	{
+		pthread_join(producer[i], NULL);
+		pthread_join(consumer[i], NULL);
+	}
+	if (mpmcSum != (uint64_t)MPMC_TEST_THREADS * MPMC_TEST_ELEMENTS * (MPMC_TEST_ELEMENTS +1) / 2) print_debugs("elements lost or duplicated");
+	if (fifo_mpmc_getLevel(pHandle) != 0) print_debugs("");
+
+	fifo_mpmc_deinit_free(pHandle);
+	printf("Test of fifo_mpmc_put() and fifo_mpmc_get() ended\n");
+}
+#undef MPMC_TEST_THREADS
+#undef MPMC_TEST_ELEMENTS
+
+#define SPILL_TEST_ELEMENTS 1000000
+
+static void *spillProducer(void *pSpill)
+{
+	for (uint32_t i = 0; i < SPILL_TEST_ELEMENTS; i++)
+	{
+		if (fifo_spill_put(pSpill, &i) != FIFO_NO_ERROR) print_debuginfo(i);
+	}
+	return NULL;
+}
+
+void testSpill(void)
+{
+	fifo_spill_t spill;
+	pthread_t producer;
+	uint32_t rcv;
+	printf("Test of fifo_spill_ started\n");
+
+	if (fifo_spill_init(&spill, 64, sizeof(uint32_t), "/nonexistent_dir", 256) != -6) print_debugs("");
+	if (fifo_spill_init(&spill, 64, sizeof(uint32_t), "/tmp", SIZE_MAX / 8) != -7) print_debugs("");	// batch buffer too big
+	if (fifo_spill_init(&spill, 64, sizeof(uint32_t), "/tmp", 256) != 0)
+	{
+		print_debugs("init failed");
+		return;
+	}
+
+	// ** a burst much bigger than the ring **
+	for (uint32_t i = 0; i < SPILL_TEST_ELEMENTS; i++)
+	{
+		if (fifo_spill_put(&spill, &i) != FIFO_NO_ERROR) print_debuginfo(i);
+	}
+	if (fifo_spill_getLevel(&spill) != SPILL_TEST_ELEMENTS) print_debugs("");
+	if (fifo_wide_getLevel(spill.pRing) > 64) print_debugs("");
+	if (spill.spilled < SPILL_TEST_ELEMENTS - 64 - 256) print_debuginfo((int)spill.spilled);
+	for (uint32_t i = 0; i < SPILL_TEST_ELEMENTS; i++)
+	{
+		if (fifo_spill_get(&spill, &rcv) != FIFO_NO_ERROR || rcv != i)
+		{
+			print_debuginfo(i);
+			break;
+		}
+	}
+	if (fifo_spill_get(&spill, &rcv) != FIFO_EMPTY) print_debugs("");
+	if (spill.spilling || spill.file_written != 0) print_debugs("spill not drained");
+
+	// ** producer and consumer at the same time **
+	pthread_create(&producer, NULL, spillProducer, &spill);
+	for (uint32_t i = 0; i < SPILL_TEST_ELEMENTS; i++)
+	{
+		while (fifo_spill_get(&spill, &rcv) == FIFO_EMPTY) sched_yield();
+		if (rcv != i)
+		{
+			print_debuginfo(i);
+			break;
+		}
+	}
+	pthread_join(producer, NULL);
+	if (fifo_spill_getLevel(&spill) != 0) print_debugs("");
+
+	fifo_spill_deinit(&spill);
+	printf("Test of fifo_spill_ ended\n");
+}
+#undef SPILL_TEST_ELEMENTS
+
+#define SHM_TEST_ELEMENTS 1000000
+void testShm(void)
+{
+	char name[32];
+	fifo_shm_t shm, shm2;
+	uint32_t rcv, tx[64];
+	size_t count;
+	printf("Test of fifo_shm_ started\n");
+
+	snprintf(name, sizeof(name), "/fifo_test_%d", (int)getpid());
+	fifo_shm_unlink(name);
+	if (fifo_shm_attach(&shm, name) != -6) print_debugs("");
+	if (fifo_shm_create(&shm, name, 1000, sizeof(uint32_t)) != -2) print_debugs("");
+	if (fifo_shm_create(&shm, name, 1024, sizeof(uint32_t)) != 0)
+	{
+		print_debugs("create failed");
+		return;
+	}
+	if (fifo_shm_create(&shm2, name, 1024, sizeof(uint32_t)) != -6) print_debugs("created twice");
+
+	// ** a second mapping at another address sees the same fifo **
+	if (fifo_shm_attach(&shm2, name) != 0) print_debugs("");
+	if (shm2.pHeader == shm.pHeader) print_debugs("");
+	for (uint32_t i = 0; i < 64; i++)
+	{
+		tx[i] = i;
+	}
+	if (fifo_shm_put_n(&shm, tx, 64, &count) != FIFO_NO_ERROR || count != 64) print_debugs("");
+	if (fifo_shm_getLevel(&shm2) != 64) print_debugs("");
+	for (uint32_t i = 0; i < 64; i++)
+	{
+		if (fifo_shm_get(&shm2, &rcv) != FIFO_NO_ERROR || rcv != i) print_debuginfo(i);
+	}
+	if (fifo_shm_get(&shm2, &rcv) != FIFO_EMPTY) print_debugs("");
+	fifo_shm_detach(&shm2);
+
+	// ** an other process is the producer **
+	pid_t pid = fork();
+	if (pid == 0)
+	{
+		fifo_shm_t child;
+		if (fifo_shm_attach(&child, name) != 0) _exit(1);
+		for (uint32_t i = 0; i < SHM_TEST_ELEMENTS; i++)
+		{
+			while (fifo_shm_put(&child, &i) != FIFO_NO_ERROR) sched_yield();
+		}
+		fifo_shm_detach(&child);
+		_exit(0);
+	}
+	int status = 0;
+	bool exited = false;
+	for (uint32_t i = 0; i < SHM_TEST_ELEMENTS; i++)
+	{
+		fifoerror_t ret;
+		while ((ret = fifo_shm_get(&shm, &rcv)) != FIFO_NO_ERROR && !exited)
+		{
+			exited = (waitpid(pid, &status, WNOHANG) == pid);	// the fifo gets looked at once more after the producer is gone
+			sched_yield();
+		}
+		if (ret != FIFO_NO_ERROR)	// the producer exited before it put all elements
+		{
+			print_debuginfo((int)i);
+			break;
+		}
+		if (rcv != i)
+		{
+			print_debuginfo(i);
+			break;
+		}
+	}
+	if (!exited)
+	{
+		waitpid(pid, &status, 0);
+	}
+	if (!WIFEXITED(status) || WEXITSTATUS(status) != 0) print_debugs("producer process failed");
+
+	// ** positions more than the capacity apart are refused without a copy **
+	uint64_t read_pos = shm.pHeader->read_pos;
+	shm.pHeader->write_pos = read_pos + 5000;
+	rcv = 0xA5A5A5A5;
+	count = 1;
+	if (fifo_shm_get_n(&shm, &rcv, 1, &count) != FIFO_WRONG_PARAM || rcv != 0xA5A5A5A5) print_debugs("");
+	shm.pHeader->write_pos = read_pos;
+	shm.pHeader->read_pos = read_pos + 10;	// read_pos ahead of write_pos
+	if (fifo_shm_put_n(&shm, tx, 64, &count) != FIFO_WRONG_PARAM) print_debugs("");
+	if (fifo_shm_getLevel(&shm) != 1024) print_debugs("");
+	shm.pHeader->read_pos = read_pos;
+	if (fifo_shm_put(&shm, tx) != FIFO_NO_ERROR || fifo_shm_get(&shm, &rcv) != FIFO_NO_ERROR || rcv != 0) print_debugs("");
+
+	// ** a damaged header is refused **
+	shm.pHeader->mask = 1000;
+	if (fifo_shm_attach(&shm2, name) != -7) print_debugs("");
+	shm.pHeader->mask = 1023;
+	__atomic_store_n(&shm.pHeader->magic, 0, __ATOMIC_RELEASE);
+	if (fifo_shm_attach(&shm2, name) != -7) print_debugs("");
+
+	fifo_shm_detach(&shm);
+	if (fifo_shm_unlink(name) != 0) print_debugs("");
+	printf("Test of fifo_shm_ ended\n");
+}
+#undef SHM_TEST_ELEMENTS
+
+#if FIFO_MIRROR
+void testMirror(void)
+{
+	#define TEST_ELEMENTS 1024
+	uint32_t tx[TEST_ELEMENTS], rx[TEST_ELEMENTS];
+	FIFO_WIDE_INDEX_TYPE count, contiguous;
+	uint32_t *pSlot;
+	printf("Test of fifo_init_mirror() started\n");
+
+	if (fifo_wide_init_mirror(TEST_ELEMENTS -1, sizeof(uint32_t)) != NULL) print_debugs("size is not a multiple of the page size");
+	fifo_wide_handle_t *pHandle = fifo_wide_init_mirror(TEST_ELEMENTS, sizeof(uint32_t));
+	if (pHandle == NULL)
+	{
+		print_debugs("Allocation failed");
+		return;
+	}
+	FIFO_WIDE_INDEX_TYPE capacity = fifo_wide_getEmptySpace(pHandle);
+	for (uint32_t i = 0; i < TEST_ELEMENTS; i++)
+	{
+		tx[i] = i * 3 +1;
+	}
+
+	// ** both mappings show the same memory **
+	volatile uint32_t *pMem = pHandle->pFifo;
+	pMem[5] = 0x12345678;
+	if (pMem[TEST_ELEMENTS +5] != 0x12345678) print_debugs("");
+
+	// ** move the indices close to the end **
+	fifo_wide_put_n(pHandle, tx, capacity - 10, &count);
+	fifo_wide_get_n(pHandle, rx, capacity - 10, &count);
+
+	// ** reserve and peek across the end of the memory in one piece **
+	if (fifo_wide_write_reserve(pHandle, capacity, (void **)&pSlot, &contiguous) != FIFO_NO_ERROR) print_debugs("");
+	if (contiguous != capacity) print_debuginfo((int)contiguous);
+	for (uint32_t i = 0; i < contiguous; i++)
+	{
+		pSlot[i] = tx[i];
+	}
+	if (fifo_wide_write_commit(pHandle, contiguous) != FIFO_NO_ERROR) print_debugs("");
+	if (fifo_wide_read_peek(pHandle, capacity, (void **)&pSlot, &contiguous) != FIFO_NO_ERROR) print_debugs("");
+	if (contiguous != capacity) print_debuginfo((int)contiguous);
+	for (uint32_t i = 0; i < contiguous; i++)
+	{
+		if (pSlot[i] != tx[i])
+		{
+			print_debuginfo(i);
+			break;
+		}
+	}
+	if (fifo_wide_read_release(pHandle, 100) != FIFO_NO_ERROR) print_debugs("");
+
+	// ** copies across the end of the memory **
+	if (fifo_wide_get_n(pHandle, rx, capacity, &count) != FIFO_EMPTY || count != capacity - 100) print_debugs("");
+	if (fifo_wide_put_n(pHandle, tx, capacity, &count) != FIFO_NO_ERROR) print_debugs("");
+	if (fifo_wide_get_n(pHandle, rx, capacity, &count) != FIFO_NO_ERROR) print_debugs("");
+	for (uint32_t i = 0; i < capacity; i++)
+	{
+		if (rx[i] != tx[i])
+		{
+			print_debuginfo(i);
+			break;
+		}
+	}
+	fifo_wide_deinit_free(pHandle);
+	printf("Test of fifo_init_mirror() ended\n");
+	#undef TEST_ELEMENTS
+}
+#endif
+
+#if FIFO_WAIT && FIFO_SPSC
+#define WAIT_TEST_ELEMENTS 100000
+
+static void *waitProducer(void *pHandle)
+{
+	for (uint32_t i = 0; i < WAIT_TEST_ELEMENTS; i++)
+	{
+		if (fifo_put_wait(pHandle, &i, -1) != FIFO_NO_ERROR) print_debuginfo(i);
+	}
+	return NULL;
+}
+
+static double elapsedMs(const struct timespec *pStart)
+{
+	struct timespec now;
+	clock_gettime(CLOCK_MONOTONIC, &now);
+	return (now.tv_sec - pStart->tv_sec) * 1e3 + (now.tv_nsec - pStart->tv_nsec) / 1e6;
+}
+
+void testWait(void)
+{
+	pthread_t producer;
+	struct timespec start;
+	uint32_t rcv;
+	printf("Test of fifo_put_wait() and fifo_get_wait() started\n");
+
+	fifo_handle_t *pHandle = fifo_init_malloc(16, sizeof(uint32_t));
+
+	// ** timeouts **
+	clock_gettime(CLOCK_MONOTONIC, &start);
+	if (fifo_get_wait(pHandle, &rcv, 0) != FIFO_EMPTY) print_debugs("");
+	if (fifo_get_wait(pHandle, &rcv, 50) != FIFO_EMPTY) print_debugs("");
+	if (elapsedMs(&start) < 50) print_debugs("returned before the timeout");
+	for (uint32_t i = 0; fifo_put(pHandle, &i) == FIFO_NO_ERROR; i++);
+	clock_gettime(CLOCK_MONOTONIC, &start);
+	struct timespec deadline = start;
+	deadline.tv_nsec += 20000000;
+	if (deadline.tv_nsec >= 1000000000) { deadline.tv_sec++; deadline.tv_nsec -= 1000000000; }
+	if (fifo_put_wait_until(pHandle, &rcv, &deadline) != FIFO_FULL) print_debugs("");
+	if (elapsedMs(&start) < 20) print_debugs("returned before the deadline");
+	if (fifo_put_wait_until(pHandle, &rcv, &start) != FIFO_FULL) print_debugs("");	// passed deadline, returns right away
+	if (pHandle->_space_waiters != 0 || pHandle->_space_seq != 0) print_debugs("");
+	fifo_flush(pHandle);
+	if (fifo_get_wait_until(pHandle, &rcv, &start) != FIFO_EMPTY) print_debugs("");
+	if (pHandle->_data_waiters != 0) print_debugs("");
+
+	// ** no waiter, no wake up **
+	for (uint32_t i = 0; i < 8; i++)
+	{
+		if (fifo_put_wait(pHandle, &i, -1) != FIFO_NO_ERROR) print_debuginfo(i);
+		if (fifo_get_wait(pHandle, &rcv, -1) != FIFO_NO_ERROR || rcv != i) print_debuginfo(i);
+	}
+	if (pHandle->_data_seq != 0 || pHandle->_space_seq != 0) print_debugs("woken without a waiter");
+
+	// ** a parked consumer and a parked producer get woken **
+	pthread_create(&producer, NULL, waitProducer, pHandle);
+	for (uint32_t i = 0; i < WAIT_TEST_ELEMENTS; i++)
+	{
+		if (fifo_get_wait(pHandle, &rcv, -1) != FIFO_NO_ERROR || rcv != i)
+		{
+			print_debuginfo(i);
+			break;
+		}
+	}
+	pthread_join(producer, NULL);
+	if (fifo_hasElementsLeft(pHandle)) print_debugs("");
+	if (pHandle->_data_waiters != 0 || pHandle->_space_waiters != 0) print_debugs("");
+
+	fifo_deinit_free(pHandle);
+	printf("Test of fifo_put_wait() and fifo_get_wait() ended\n");
+}
+#undef WAIT_TEST_ELEMENTS
+#endif
+
+#if FIFO_OVERWRITE
+#define OVERWRITE_TEST_ELEMENTS 2000000
+
+static void overwriteDrain(void *pCtx, const void *pData, size_t n)
+{
+	(void)pCtx;
+	(void)pData;
+	(void)n;
+	print_debugs("");	// never called for an overwriting fifo
+}
+
+#define OVERWRITE_LAP_SLOTS 8
+#define OVERWRITE_LAP_DROPS 256		// a multiple of the slots and of the narrow FIFO_POW2 index range
+
+typedef struct{
+	uint32_t word[4];
+}lapElement_t;
+
+static fifo_handle_t *pLapHandle;
+static uint8_t *pLapPages;
+static size_t lapPageSize;
+
+/**
+ * @brief runs while fifo_get() is stopped in the copy of the element to the protected page, the producer drops a
+ * multiple of the slots so read_idx gets the same value again
+ */
+static void overwriteLap(int sig, siginfo_t *pInfo, void *pContext)
+{
+	(void)sig;
+	(void)pContext;
+	if ((uint8_t *)pInfo->si_addr < pLapPages + lapPageSize || (uint8_t *)pInfo->si_addr >= pLapPages + 2 * lapPageSize)
+	{
+		abort();
+	}
+	for (uint32_t i = 0; i < OVERWRITE_LAP_DROPS; i++)
+	{
+		lapElement_t element = {{i, i, i, i}};
+		fifo_put(pLapHandle, &element);
+	}
+	mprotect(pLapPages + lapPageSize, lapPageSize, PROT_READ | PROT_WRITE);
+}
+
+#if FIFO_SPSC
+static void *overwriteProducer(void *pHandle)
+{
+	for (uint32_t i = 1; i <= OVERWRITE_TEST_ELEMENTS; i++)
+	{
+		if (fifo_wide_put(pHandle, &i) != FIFO_NO_ERROR) print_debuginfo(i);	// never full
+		if ((i & 0xFFF) == 0) sched_yield();	// let the consumer run on a single core
+	}
+	return NULL;
+}
+#endif
+
+void testOverwrite(void)
+{
+	uint32_t dummy32 = 0;
+	printf("Test of fifo_setOverwrite() started\n");
+
+	fifo_handle_t *pHandle = fifo_init_malloc(8, sizeof(uint32_t));
+	uint32_t capacity = fifo_getEmptySpace(pHandle);
+	if (fifo_setOverwrite(NULL, true) != FIFO_WRONG_PARAM) print_debugs("");
+	while (fifo_put(pHandle, &dummy32) == FIFO_NO_ERROR);	// the default is FIFO_FULL
+	if (fifo_getDropped(pHandle) != 0) print_debugs("");
+	fifo_flush(pHandle);
+
+	// ** the newest elements are kept **
+	if (fifo_setOverwrite(pHandle, true) != FIFO_NO_ERROR) print_debugs("");
+	for (uint32_t i = 0; i < 100; i++)
+	{
+		if (fifo_put(pHandle, &i) != FIFO_NO_ERROR) print_debuginfo(i);
+	}
+	if (fifo_getDropped(pHandle) != 100 - capacity) print_debuginfo(fifo_getDropped(pHandle));
+	if (fifo_getLevel(pHandle) != capacity) print_debugs("");
+	for (uint32_t i = 100 - capacity; i < 100; i++)
+	{
+		if (fifo_get(pHandle, &dummy32), dummy32 != i) print_debuginfo(dummy32);
+	}
+	if (fifo_get(pHandle, &dummy32) != FIFO_EMPTY) print_debugs("");
+
+	// ** only fifo_get() may read an overwriting fifo, the others would move read_idx back over a drop **
+	uint32_t buf[8];
+	void *pData;
+	FIFO_INDEX_TYPE n;
+	fifo_put(pHandle, &dummy32);
+	fifo_put(pHandle, &dummy32);
+	if (fifo_get_n(pHandle, buf, 2, &n) != FIFO_WRONG_PARAM) print_debugs("");
+	if (fifo_read_peek(pHandle, 1, &pData, &n) != FIFO_WRONG_PARAM) print_debugs("");
+	if (fifo_read_release(pHandle, 1) != FIFO_WRONG_PARAM) print_debugs("");
+	if (fifo_drain(pHandle, overwriteDrain, NULL, 2, &n) != FIFO_WRONG_PARAM) print_debugs("");
+	if (fifo_skip_read_n(pHandle, 1) != FIFO_WRONG_PARAM) print_debugs("");
+	if (fifo_peek_record(pHandle, &pData, &n) != FIFO_WRONG_PARAM) print_debugs("");
+	if (fifo_flush(pHandle) != FIFO_WRONG_PARAM) print_debugs("");
+	if (fifo_getLevel(pHandle) != 2) print_debuginfo((int)fifo_getLevel(pHandle));
+	fifo_setOverwrite(pHandle, false);
+	if (fifo_get_n(pHandle, buf, 2, &n) != FIFO_NO_ERROR || n != 2) print_debugs("");
+	fifo_deinit_free(pHandle);
+
+	// ** a reader lapped by a multiple of the slots during its copy does not return the torn element it copied **
+	struct sigaction lap = {0}, old;
+	lap.sa_sigaction = overwriteLap;
+	lap.sa_flags = SA_SIGINFO;
+	sigaction(SIGSEGV, &lap, &old);
+	lapPageSize = (size_t)sysconf(_SC_PAGESIZE);
+	pLapPages = mmap(NULL, 2 * lapPageSize, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+	lapElement_t *pLapped = (lapElement_t *)(pLapPages + lapPageSize - sizeof(uint64_t));	// the copy faults on the second page
+	pLapHandle = fifo_init_malloc(OVERWRITE_LAP_SLOTS, sizeof(lapElement_t));
+	fifo_setOverwrite(pLapHandle, true);
+	capacity = fifo_getEmptySpace(pLapHandle);
+	for (uint32_t i = 1000; fifo_getEmptySpace(pLapHandle) != 0; i++)
+	{
+		lapElement_t element = {{i, i, i, i}};
+		fifo_put(pLapHandle, &element);
+	}
+	mprotect(pLapPages + lapPageSize, lapPageSize, PROT_NONE);
+	if (fifo_get(pLapHandle, pLapped) != FIFO_NO_ERROR) print_debugs("");
+	for (uint8_t i = 0; i < 4; i++)
+	{
+		if (pLapped->word[i] != OVERWRITE_LAP_DROPS - capacity) print_debuginfo((int)pLapped->word[i]);	// the oldest element after the lap
+	}
+	if (fifo_getDropped(pLapHandle) != OVERWRITE_LAP_DROPS) print_debuginfo((int)fifo_getDropped(pLapHandle));
+	if (fifo_getLevel(pLapHandle) != capacity - 1) print_debuginfo((int)fifo_getLevel(pLapHandle));
+	sigaction(SIGSEGV, &old, NULL);
+	munmap(pLapPages, 2 * lapPageSize);
+	fifo_deinit_free(pLapHandle);
+
+#if FIFO_SPSC
+	// ** a lapped reader gets every element at most once and in order **
+	fifo_wide_handle_t *pWide = fifo_wide_init_malloc(64, sizeof(uint32_t));
+	fifo_wide_setOverwrite(pWide, true);
+	pthread_t producer;
+	uint32_t last = 0, received = 0;
+	pthread_create(&producer, NULL, overwriteProducer, pWide);
+	while (last != OVERWRITE_TEST_ELEMENTS)
+	{
+		if (fifo_wide_get(pWide, &dummy32) != FIFO_NO_ERROR)
+		{
+			sched_yield();
+			continue;
+		}
+		if (dummy32 <= last || dummy32 > OVERWRITE_TEST_ELEMENTS)
+		{
+			print_debuginfo(dummy32);
+			break;
+		}
+		last = dummy32;
+		received++;
+	}
+	pthread_join(producer, NULL);
+	if (received + fifo_wide_getDropped(pWide) != OVERWRITE_TEST_ELEMENTS) print_debugs("elements lost or duplicated");
+	fifo_wide_deinit_free(pWide);
+#endif
+	printf("Test of fifo_setOverwrite() ended\n");
+}
+#undef OVERWRITE_TEST_ELEMENTS
+#undef OVERWRITE_LAP_SLOTS
+#undef OVERWRITE_LAP_DROPS
+#endif
+
+#if FIFO_SPSC
+#define SPSC_TEST_ELEMENTS 10000000
+
+static volatile uint32_t spscBuisy;	// counts FIFO_BUISY returns, should stay 0
+
+static void *spscProducer(void *pHandle)
+{
+	for (uint32_t i = 0; i < SPSC_TEST_ELEMENTS; i++)
+	{
+		uint8_t tx = (uint8_t)i;
+		fifoerror_t ret;
+		while ((ret = fifo_put(pHandle, &tx)) != FIFO_NO_ERROR)
+		{
+			if (ret == FIFO_BUISY) spscBuisy++;
+			sched_yield();	// keep the test fast on a single core
+		}
+	}
+	return NULL;
+}
+
+void testSpscThreads(void)
+{
+	pthread_t producer;
+	struct timespec start, end;
+	uint32_t errors = 0;
+	printf("Test of fifo_put() and fifo_get() in SPSC mode started\n");
+
+	// ** the fields of the consumer and the fields after them are a cache line apart **
+	if (offsetof(fifo_handle_t, _pad2) + sizeof(((fifo_handle_t *)0)->_pad2) - offsetof(fifo_handle_t, read_idx) != FIFO_CACHE_LINE_SIZE) print_debugs("");
+	if (offsetof(fifo_wide_handle_t, _pad2) + sizeof(((fifo_wide_handle_t *)0)->_pad2) - offsetof(fifo_wide_handle_t, read_idx) != FIFO_CACHE_LINE_SIZE) print_debugs("");
+
+	fifo_handle_t *pHandle = fifo_init_malloc(MAX_FIFO_SIZE, sizeof(uint8_t));
+	spscBuisy = 0;
+	clock_gettime(CLOCK_MONOTONIC, &start);
+	pthread_create(&producer, NULL, spscProducer, pHandle);
+	for (uint32_t i = 0; i < SPSC_TEST_ELEMENTS; i++)	// this thread is the consumer
+	{
+		uint8_t rcv;
+		fifoerror_t ret;
+		while ((ret = fifo_get(pHandle, &rcv)) != FIFO_NO_ERROR)
+		{
+			if (ret == FIFO_BUISY) spscBuisy++;
+			sched_yield();	// keep the test fast on a single core
+		}
+		if (rcv != (uint8_t)i) errors++;
+	}
+	pthread_join(producer, NULL);
+	clock_gettime(CLOCK_MONOTONIC, &end);
+
+	if (errors != 0) print_debuginfo(errors);
+	if (spscBuisy != 0) print_debuginfo(spscBuisy);
+	if (fifo_hasElementsLeft(pHandle)) print_debugs("");
+	double seconds = (end.tv_sec - start.tv_sec) + (end.tv_nsec - start.tv_nsec) / 1e9;
+	printf("%u elements in %.3f s (%.1f M elements/s)\n", SPSC_TEST_ELEMENTS, seconds, SPSC_TEST_ELEMENTS / seconds / 1e6);
+	fifo_deinit_free(pHandle);
+	printf("Test of fifo_put() and fifo_get() in SPSC mode ended\n");
+}
+#undef SPSC_TEST_ELEMENTS
+#endif
+
+void testWide(void)
+{
+	#define TEST_ELEMENTS (1 << 20)
+	fifo_wide_handle_t myWideHandle;
+	uint32_t myFifo[256];
+	FIFO_WIDE_INDEX_TYPE count;
+	printf("Test of fifo_wide_ started\n");
+
+	// ** fifo memory bigger than MAX_FIFO_SIZE **
+	if (sizeof(myFifo) <= MAX_FIFO_SIZE) print_debugs("test needs a buffer bigger than MAX_FIFO_SIZE");
+	if (fifo_init_malloc(((FIFO_INDEX_TYPE)-1) / sizeof(myFifo[0]) +1, sizeof(myFifo[0])) != NULL) print_debugs("");
+	if (fifo_wide_init(&myWideHandle, myFifo, sizeof(myFifo), sizeof(myFifo[0])) != 0) print_debugs("");
+	for (uint32_t i = 0; fifo_wide_put(&myWideHandle, &i) == FIFO_NO_ERROR; i++);
+	if (fifo_wide_getEmptySpace(&myWideHandle) != 0) print_debugs("");
+	if (fifo_wide_getLevel(&myWideHandle) < 255) print_debugs("");
+	for (uint32_t i = 0, rcv; fifo_wide_get(&myWideHandle, &rcv) == FIFO_NO_ERROR; i++)
+	{
+		if (rcv != i) print_debuginfo(i);
+	}
+
+	// ** a multi megabyte fifo next to the small ones **
+	uint32_t *pTx = malloc(TEST_ELEMENTS * sizeof(uint32_t)), *pRx = malloc(TEST_ELEMENTS * sizeof(uint32_t));
+	fifo_wide_handle_t *pHandle = fifo_wide_init_malloc(TEST_ELEMENTS, sizeof(uint32_t));
+	if (pTx == NULL || pRx == NULL || pHandle == NULL)
+	{
+		print_debugs("Allocation failed");
+		assert(0);
+	}
+	FIFO_WIDE_INDEX_TYPE capacity = fifo_wide_getEmptySpace(pHandle);
+	if (capacity < TEST_ELEMENTS -1) print_debugs("");
+	for (uint32_t i = 0; i < TEST_ELEMENTS; i++)
+	{
+		pTx[i] = i * 7;
+	}
+	for (uint32_t j = 0; j < 3; j++)
+	{
+		if (fifo_wide_put_n(pHandle, pTx, TEST_ELEMENTS, &count) == FIFO_WRONG_PARAM || count != capacity) print_debugs("");
+		if (fifo_wide_getLevel(pHandle) != capacity) print_debugs("");
+		if (fifo_wide_get_n(pHandle, pRx, capacity / 2 + j, &count) != FIFO_NO_ERROR) print_debugs("");
+		if (fifo_wide_get_n(pHandle, pRx + count, TEST_ELEMENTS, &count) != FIFO_EMPTY) print_debugs("");
+		for (uint32_t i = 0; i < capacity; i++)
+		{
+			if (pRx[i] != pTx[i])
+			{
+				print_debuginfo(i);
+				break;
+			}
+		}
+	}
+	fifo_wide_deinit_free(pHandle);
+	free(pTx);
+	free(pRx);
+	printf("Test of fifo_wide_ ended\n");
+	#undef TEST_ELEMENTS
+}
+
+#if FIFO_POW2
+void testPow2(void)
+{
+	fifo_handle_t myHandle;
+	uint16_t myFifo[8], tx[8], rx[8], *pSlot;
+	FIFO_INDEX_TYPE count;
+	printf("Test of the power of two mode started\n");
+
+	if (fifo_init(&myHandle, myFifo, 6 * sizeof(uint16_t), sizeof(uint16_t)) != -5) print_debugs("");	// not a power of two
+	if (fifo_init_malloc(6, sizeof(uint16_t)) != NULL) print_debugs("");
+	if (fifo_init(&myHandle, myFifo, sizeof(myFifo), sizeof(myFifo[0])) != 0) print_debugs("");
+	if (myHandle.mask != 7) print_debugs("");
+
+	// ** every slot can be used **
+	for (uint16_t i = 0; i < 8; i++)
+	{
+		if (fifo_getEmptySpace(&myHandle) != 8 - i) print_debuginfo(i);
+		if (fifo_put(&myHandle, &i) != FIFO_NO_ERROR) print_debuginfo(i);
+		tx[i] = i;
+	}
+	if (fifo_put(&myHandle, &tx[0]) != FIFO_FULL) print_debugs("");
+	if (fifo_hasSpaceLeft(&myHandle)) print_debugs("");
+	if (fifo_getLevel(&myHandle) != 8) print_debugs("");
+	if (fifo_skip_write(&myHandle) != FIFO_FULL) print_debugs("");
+	for (uint16_t i = 0; i < 8; i++)
+	{
+		if (fifo_get(&myHandle, &rx[0]) != FIFO_NO_ERROR || rx[0] != i) print_debuginfo(i);
+	}
+	if (fifo_get(&myHandle, &rx[0]) != FIFO_EMPTY) print_debugs("");
+
+	// ** the free running counters overflow the index type many times **
+	for (uint32_t j = 0; j < 1000; j++)
+	{
+		uint16_t n = j % 8 + 1;
+		if (fifo_put_n(&myHandle, tx, n, &count) != FIFO_NO_ERROR || count != n) print_debuginfo(j);
+		if (fifo_getLevel(&myHandle) != n || fifo_getEmptySpace(&myHandle) != 8 - n) print_debuginfo(j);
+		if (fifo_get_n(&myHandle, rx, n, &count) != FIFO_NO_ERROR || count != n) print_debuginfo(j);
+		for (uint16_t i = 0; i < n; i++)
+		{
+			if (rx[i] != tx[i]) print_debuginfo(j);
+		}
+		if (fifo_hasElementsLeft(&myHandle)) print_debuginfo(j);
+	}
+
+	// ** in place access is split at the end of the fifo memory **
+	fifo_skip_write_n(&myHandle, 5);
+	fifo_skip_read_n(&myHandle, 5);
+	if (fifo_write_reserve(&myHandle, 8, (void **)&pSlot, &count) != FIFO_NO_ERROR || count != 8 - (myHandle.write_idx & 7)) print_debuginfo(count);
+	if (fifo_write_commit(&myHandle, count) != FIFO_NO_ERROR) print_debugs("");
+	if (fifo_write_reserve(&myHandle, 8, (void **)&pSlot, &count) != FIFO_NO_ERROR || pSlot != myFifo) print_debugs("");
+	if (fifo_write_commit(&myHandle, count) != FIFO_NO_ERROR) print_debugs("");
+	if (fifo_getLevel(&myHandle) != 8) print_debugs("");
+	printf("Test of the power of two mode ended\n");
+}
+#endif
+
+void testReserveCommit(void)
+{
+	uint8_t *pSlot, dummy8;
+	FIFO_INDEX_TYPE contiguous;
+	printf("Test of fifo_write_reserve() and fifo_read_peek() started\n");
+
+	fifo_handle_t *pHandle = fifo_init_malloc(8, sizeof(uint8_t));
+	if (fifo_write_reserve(NULL, 1, (void **)&pSlot, &contiguous) != FIFO_WRONG_PARAM) 	print_debugs("");
+	if (fifo_write_reserve(pHandle, 1, NULL, &contiguous) != FIFO_WRONG_PARAM) 			print_debugs("");
+	if (fifo_read_peek(pHandle, 1, (void **)&pSlot, NULL) != FIFO_WRONG_PARAM) 			print_debugs("");
+	if (fifo_read_peek(pHandle, 1, (void **)&pSlot, &contiguous) != FIFO_EMPTY || contiguous != 0) print_debugs("");
+
+	// ** write in place, limited to the free space **
+	if (fifo_write_reserve(pHandle, 10, (void **)&pSlot, &contiguous) != FIFO_NO_ERROR || contiguous != TEST_CAPACITY(8)) print_debuginfo(contiguous);
+#if !FIFO_SPSC
+	if (fifo_put(pHandle, "x") != FIFO_BUISY) print_debugs("");	// locked until commit
+#endif
+	for (uint8_t i = 0; i < 5; i++)
+	{
+		pSlot[i] = i;
+	}
+	if (fifo_write_commit(pHandle, 5) != FIFO_NO_ERROR) print_debugs("");
+	if (fifo_getLevel(pHandle) != 5) print_debugs("");
+
+	// ** read in place **
+	if (fifo_read_peek(pHandle, 10, (void **)&pSlot, &contiguous) != FIFO_NO_ERROR || contiguous != 5) print_debuginfo(contiguous);
+	for (uint8_t i = 0; i < contiguous; i++)
+	{
+		if (pSlot[i] != i) print_debuginfo(pSlot[i]);
+	}
+	if (fifo_read_release(pHandle, 6) != FIFO_WRONG_PARAM) print_debugs("");	// more than available
+	if (fifo_read_peek(pHandle, 2, (void **)&pSlot, &contiguous) != FIFO_NO_ERROR || contiguous != 2) print_debuginfo(contiguous);
+	if (fifo_read_release(pHandle, 2) != FIFO_NO_ERROR) print_debugs("");
+	if (fifo_get(pHandle, &dummy8), fifo_getLevel(pHandle) != 2) print_debugs("");	// mixed with a normal read
+
+	// ** the reserved range is split at the end of the fifo memory **
+	if (fifo_write_reserve(pHandle, 10, (void **)&pSlot, &contiguous) != FIFO_NO_ERROR || pSlot + contiguous != (uint8_t *)pHandle->pFifo + pHandle->size) print_debuginfo(contiguous);
+	FIFO_INDEX_TYPE first = contiguous;
+	for (uint8_t i = 0; i < first; i++)
+	{
+		pSlot[i] = 'a' + i;
+	}
+	if (fifo_write_commit(pHandle, first) != FIFO_NO_ERROR) print_debugs("");
+	if (fifo_write_reserve(pHandle, 10, (void **)&pSlot, &contiguous) != FIFO_NO_ERROR || contiguous != fifo_getEmptySpace(pHandle)) print_debuginfo(contiguous);
+	if (pSlot != pHandle->pFifo) print_debugs("");
+	pSlot[0] = 'c';
+	if (fifo_write_commit(pHandle, 1) != FIFO_NO_ERROR) print_debugs("");
+	if (fifo_getLevel(pHandle) != 3 + first) print_debugs("");
+	if (fifo_skip_read_n(pHandle, 2), fifo_read_peek(pHandle, 10, (void **)&pSlot, &contiguous) != FIFO_NO_ERROR || contiguous != first || pSlot[first -1] != 'a' + first -1) print_debugs("");
+	if (fifo_read_release(pHandle, first) != FIFO_NO_ERROR) print_debugs("");
+	if (fifo_read_peek(pHandle, 10, (void **)&pSlot, &contiguous) != FIFO_NO_ERROR || contiguous != 1 || pSlot[0] != 'c') print_debugs("");
+	if (fifo_read_release(pHandle, 1) != FIFO_NO_ERROR) print_debugs("");
+
+	// ** full fifo **
+	while (fifo_put(pHandle, "F") == FIFO_NO_ERROR);
+	if (fifo_write_reserve(pHandle, 1, (void **)&pSlot, &contiguous) != FIFO_FULL || contiguous != 0) print_debugs("");
+	if (fifo_put(pHandle, "F") != FIFO_FULL) print_debugs("");	// not locked after a failed reserve
+	fifo_deinit_free(pHandle);
+	printf("Test of fifo_write_reserve() and fifo_read_peek() ended\n");
+}
+
+typedef struct{
+	uint16_t rx[16];
+	size_t count;
+	uint8_t calls;
+}drainCtx_t;
+
+static void drainCallback(void *pCtx, const void *pData, size_t n)
+{
+	drainCtx_t *pDrain = pCtx;
+	memcpy(&pDrain->rx[pDrain->count], pData, n * sizeof(uint16_t));
+	pDrain->count += n;
+	pDrain->calls++;
+}
+
+void testDrain(void)
+{
+	drainCtx_t drain = {0};
+	FIFO_INDEX_TYPE count;
+	uint16_t dummy16 = 0;
+	printf("Test of fifo_drain() started\n");
+
+	fifo_handle_t *pHandle = fifo_init_malloc(8, sizeof(uint16_t));
+	if (fifo_drain(NULL, drainCallback, &drain, 8, &count) != FIFO_WRONG_PARAM) 	print_debugs("");
+	if (fifo_drain(pHandle, NULL, &drain, 8, &count) != FIFO_WRONG_PARAM) 			print_debugs("");
+	if (fifo_drain(pHandle, drainCallback, &drain, 8, &count) != FIFO_EMPTY || count != 0 || drain.calls != 0) print_debugs("");
+
+	// ** one chunk, limited to max_elems **
+	for (uint16_t i = 0; i < 5; i++)
+	{
+		fifo_put(pHandle, &i);
+	}
+	if (fifo_drain(pHandle, drainCallback, &drain, 3, &count) != FIFO_NO_ERROR || count != 3 || drain.calls != 1) print_debuginfo(count);
+	if (fifo_getLevel(pHandle) != 2) print_debugs("");
+	if (fifo_drain(pHandle, drainCallback, &drain, 8, NULL) != FIFO_NO_ERROR || drain.count != 5) print_debugs("");
+	for (uint16_t i = 0; i < 5; i++)
+	{
+		if (drain.rx[i] != i) print_debuginfo(drain.rx[i]);
+	}
+
+	// ** wrapped around the end of the fifo memory, two chunks **
+	drain.count = 0;
+	drain.calls = 0;
+	for (uint16_t i = 0; i < 6; i++)
+	{
+		fifo_put(pHandle, &i);
+	}
+	if (fifo_drain(pHandle, drainCallback, &drain, 8, &count) != FIFO_NO_ERROR || count != 6) print_debuginfo(count);
+	if (drain.calls != 2) print_debuginfo(drain.calls);
+	for (uint16_t i = 0; i < 6; i++)
+	{
+		if (drain.rx[i] != i) print_debuginfo(drain.rx[i]);
+	}
+	if (fifo_get(pHandle, &dummy16) != FIFO_EMPTY) print_debugs("");
+	if (fifo_put(pHandle, &dummy16) != FIFO_NO_ERROR) print_debugs("");	// not locked after a drain
+	fifo_deinit_free(pHandle);
+	printf("Test of fifo_drain() ended\n");
+}
+
+/**
+ * @brief fills a test record, its length and its bytes depend on its number
+ */
+static uint16_t fillRecord(uint8_t *pRecord, uint32_t number, uint16_t max_len)
+{
+	uint16_t len = (number * 7) % (max_len +1);
+	for (uint16_t i = 0; i < len; i++)
+	{
+		pRecord[i] = (uint8_t)(number + i);
+	}
+	return len;
+}
+
+#define RECORD_TEST_FRAMES 20000
+
+static void *recordProducer(void *pHandle)
+{
+	static uint8_t frame[9000];
+	for (uint32_t i = 0; i < RECORD_TEST_FRAMES; i++)
+	{
+		uint16_t len = fillRecord(frame, i, sizeof(frame));
+		while (fifo_wide_put_record(pHandle, frame, len) != FIFO_NO_ERROR) sched_yield();
+	}
+	return NULL;
+}
+
+void testRecord(void)
+{
+	uint8_t tx[40], rx[40], *pRecord;
+	FIFO_INDEX_TYPE len;
+	uint32_t put = 0, got = 0;
+	printf("Test of fifo_put_record() and fifo_get_record() started\n");
+
+	fifo_handle_t *pHandle = fifo_init_malloc(128, sizeof(uint8_t));
+	fifo_handle_t *pWords = fifo_init_malloc(16, sizeof(uint16_t));
+	if (fifo_put_record(NULL, tx, 1) != FIFO_WRONG_PARAM) 					print_debugs("");
+	if (fifo_put_record(pWords, tx, 1) != FIFO_WRONG_PARAM) 				print_debugs("");	// no byte fifo
+	if (fifo_put_record(pHandle, tx, 64 - FIFO_RECORD_HEADER_SIZE) != FIFO_WRONG_PARAM) print_debugs("");	// more than half of the fifo
+	if (fifo_get_record(pHandle, rx, sizeof(rx), NULL) != FIFO_WRONG_PARAM) print_debugs("");
+	if (fifo_get_record(pHandle, rx, sizeof(rx), &len) != FIFO_EMPTY) 		print_debugs("");
+	if (fifo_release_record(pHandle) != FIFO_WRONG_PARAM) 					print_debugs("");
+
+	// ** records of 0 to 40 bytes, wrapping around at every offset **
+	for (uint32_t round = 0; round < 2000; round++)
+	{
+		while (fifo_put_record(pHandle, tx, fillRecord(tx, put, sizeof(tx))) == FIFO_NO_ERROR)
+		{
+			put++;
+		}
+		for (uint32_t i = round % 3; i > 0 && got < put; i--)
+		{
+			uint16_t expected = fillRecord(tx, got, sizeof(tx));
+			if (fifo_get_record(pHandle, rx, sizeof(rx), &len) != FIFO_NO_ERROR || len != expected || memcmp(rx, tx, len) != 0)
+			{
+				print_debuginfo(got);
+				break;
+			}
+			got++;
+		}
+		if (got < put)	// in place
+		{
+			uint16_t expected = fillRecord(tx, got, sizeof(tx));
+			if (fifo_peek_record(pHandle, (void **)&pRecord, &len) != FIFO_NO_ERROR || len != expected || memcmp(pRecord, tx, len) != 0)
+				print_debuginfo(got);
+			if (fifo_release_record(pHandle) != FIFO_NO_ERROR) print_debugs("");
+			got++;
+		}
+	}
+	if (put < 4000) print_debuginfo(put);
+
+	// ** a record bigger than the storage stays in the fifo **
+	fifo_flush(pHandle);
+	fifo_put_record(pHandle, tx, 20);
+	if (fifo_get_record(pHandle, rx, 10, &len) != FIFO_WRONG_PARAM || len != 20) 	print_debugs("");
+	if (fifo_get_record(pHandle, rx, 20, &len) != FIFO_NO_ERROR || len != 20) 		print_debugs("");
+	if (fifo_put_record(pHandle, tx, 0) != FIFO_NO_ERROR) 							print_debugs("");
+	if (fifo_get_record(pHandle, NULL, 0, &len) != FIFO_NO_ERROR || len != 0) 		print_debugs("");
+	fifo_deinit_free(pWords);
+	fifo_deinit_free(pHandle);
+
+	// ** network frames of up to 9000 bytes through a 32 KiB wide fifo **
+	static uint8_t frame[9000], expected[9000];
+	fifo_wide_handle_t *pWide = fifo_wide_init_malloc(32768, sizeof(uint8_t));
+	pthread_t producer;
+	FIFO_WIDE_INDEX_TYPE wide_len;
+	pthread_create(&producer, NULL, recordProducer, pWide);
+	for (uint32_t i = 0; i < RECORD_TEST_FRAMES; i++)
+	{
+		fifoerror_t ret;
+		while ((ret = fifo_wide_get_record(pWide, frame, sizeof(frame), &wide_len)) == FIFO_EMPTY || ret == FIFO_BUISY) sched_yield();
+		if (ret != FIFO_NO_ERROR || wide_len != fillRecord(expected, i, sizeof(expected)) || memcmp(frame, expected, wide_len) != 0)
+		{
+			print_debuginfo(i);
+			break;
+		}
+	}
+	pthread_join(producer, NULL);
+	fifo_wide_deinit_free(pWide);
+	printf("Test of fifo_put_record() and fifo_get_record() ended\n");
+}
+#undef RECORD_TEST_FRAMES
+
+void testPutGetN(void)
+{
+	uint16_t tx[16], rx[16];
+	FIFO_INDEX_TYPE count;
+	printf("Test of fifo_put_n() and fifo_get_n() started\n");
+
+	fifo_handle_t *pHandle = fifo_init_malloc(8, sizeof(uint16_t));
+	for (uint16_t i = 0; i < 16; i++)
+	{
+		tx[i] = i;
+	}
+	if (fifo_put_n(NULL, tx, 1, &count) != FIFO_WRONG_PARAM) 		print_debugs("");
+	if (fifo_put_n(pHandle, NULL, 1, &count) != FIFO_WRONG_PARAM) 	print_debugs("");
+	if (fifo_get_n(NULL, rx, 1, &count) != FIFO_WRONG_PARAM) 		print_debugs("");
+	if (fifo_get_n(pHandle, NULL, 1, &count) != FIFO_WRONG_PARAM) 	print_debugs("");
+	if (fifo_get_n(pHandle, rx, 1, &count) != FIFO_EMPTY || count != 0) print_debugs("");
+
+	// ** partial success: the fifo can only store TEST_CAPACITY(8) elements **
+	if (fifo_put_n(pHandle, tx, 10, &count) != FIFO_FULL || count != TEST_CAPACITY(8)) print_debuginfo(count);
+	if (fifo_put_n(pHandle, tx, 1, &count) != FIFO_FULL || count != 0) print_debuginfo(count);
+	if (fifo_get_n(pHandle, rx, 10, &count) != FIFO_EMPTY || count != TEST_CAPACITY(8)) print_debuginfo(count);
+	for (uint16_t i = 0; i < TEST_CAPACITY(8); i++)
+	{
+		if (rx[i] != i) print_debuginfo(rx[i]);
+	}
+
+	// ** batches around the wrap point, mixed with single element calls **
+	for (uint16_t j = 0; j < 20; j++)
+	{
+		uint16_t n = j % 7 + 1;
+		if (fifo_put_n(pHandle, &tx[j % 8], n, NULL) != FIFO_NO_ERROR) print_debuginfo(j);
+		if (fifo_getLevel(pHandle) != n) print_debuginfo(j);
+		if (fifo_get(pHandle, &rx[0]) != FIFO_NO_ERROR || rx[0] != tx[j % 8]) print_debuginfo(j);
+		if (fifo_get_n(pHandle, &rx[1], n, &count) != FIFO_EMPTY || count != n -1) print_debuginfo(j);
+		for (uint16_t i = 0; i < n; i++)
+		{
+			if (rx[i] != tx[j % 8 + i]) print_debuginfo(j);
+		}
+	}
+#if !FIFO_SPSC
+	pHandle->_lock = 0x1;	// write lock
+	if (fifo_put_n(pHandle, tx, 1, &count) != FIFO_BUISY || count != 0) print_debugs("");
+	pHandle->_lock = 0x2;	// read lock
+	if (fifo_get_n(pHandle, rx, 1, &count) != FIFO_BUISY || count != 0) print_debugs("");
+	pHandle->_lock = 0;
+#endif
+	fifo_deinit_free(pHandle);
+	printf("Test of fifo_put_n() and fifo_get_n() ended\n");
+}
 
 void testSkipWrite(void)
 {
     printf("Test of fifo_skip_write() and _n() started\n");
 	
 		fifo_handle_t *pHandle = fifo_init_malloc(32, sizeof(uint32_t));
-		for (uint8_t i = 0; i < 31; i++)
+		for (uint8_t i = 0; i < TEST_CAPACITY(32); i++)
 		{
 			if (fifo_getLevel(pHandle) != i) print_debuginfo(i);
 			if (fifo_skip_write(pHandle) != FIFO_NO_ERROR) print_debugs("");
@@ -15,17 +1667,19 @@ void testSkipWrite(void)
 		if (fifo_skip_write(pHandle) != FIFO_FULL) print_debugs("");
 		if (fifo_skip_write_n(pHandle, 1) != FIFO_FULL) print_debugs("");
 
+		if (fifo_skip_write(NULL) != FIFO_WRONG_PARAM) print_debugs("");
+		if (fifo_skip_write_n(NULL, 1) != FIFO_WRONG_PARAM) print_debugs("");
+#if !FIFO_SPSC
 		pHandle->_lock |= 0x01; // write lock
 		if (fifo_skip_write(pHandle) != FIFO_BUISY) print_debugs("");
-		if (fifo_skip_write(NULL) != FIFO_WRONG_PARAM) print_debugs("");
 		if (fifo_skip_write_n(pHandle, 1) != FIFO_BUISY) print_debugs("");
-		if (fifo_skip_write_n(NULL, 1) != FIFO_WRONG_PARAM) print_debugs("");
 		pHandle->_lock = 0;
+#endif
 		
 		fifo_flush(pHandle);
-		if (fifo_skip_write_n(pHandle, (pHandle->size / pHandle->basetype_size) -1) != FIFO_NO_ERROR) print_debugs("");
+		if (fifo_skip_write_n(pHandle, TEST_CAPACITY(32)) != FIFO_NO_ERROR) print_debugs("");
 		fifo_skip_read_n(pHandle, 3);
-		if (fifo_skip_write_n(pHandle, 10), fifo_getLevel(pHandle) != (pHandle->size / pHandle->basetype_size) -1) print_debugs("");
+		if (fifo_skip_write_n(pHandle, 10), fifo_getLevel(pHandle) != TEST_CAPACITY(32)) print_debugs("");
 		
 		fifo_deinit_free(pHandle);
 	
@@ -45,13 +1699,15 @@ void testSkipRead(void)
     if (fifo_get(pHandle, &dummy8), dummy8 != '2') print_debugs("");
     if(fifo_skip_read(pHandle) != FIFO_EMPTY) print_debugs("");
 
+    if (fifo_skip_read(NULL) != FIFO_WRONG_PARAM) print_debugs("");
+    if (fifo_skip_read_n(NULL, 1) != FIFO_WRONG_PARAM) print_debugs("");
+#if !FIFO_SPSC
     pHandle->_lock |= 0x02; // read lock
 
     if (fifo_skip_read(pHandle) != FIFO_BUISY) print_debugs("");
-    if (fifo_skip_read(NULL) != FIFO_WRONG_PARAM) print_debugs("");
     if (fifo_skip_read_n(pHandle, 1) != FIFO_BUISY) print_debugs("");
-    if (fifo_skip_read_n(NULL, 1) != FIFO_WRONG_PARAM) print_debugs("");
     pHandle->_lock = 0;
+#endif
 
     for (uint8_t j = 0; j < 3; j++)
     {
@@ -90,21 +1746,21 @@ void testGetLevel(void)
     printf("Test of fifo_getLevel() started\n");
     fifo_handle_t *pHandle = fifo_init_malloc(32, sizeof(uint32_t));
     if (fifo_getLevel(pHandle) != 0) print_debugs("");
-    if (fifo_getEmptySpace(pHandle) != 31) print_debugs("");
-    for (uint8_t i = 0, ret; i < 31; i++)
+    if (fifo_getEmptySpace(pHandle) != TEST_CAPACITY(32)) print_debugs("");
+    for (uint8_t i = 0, ret; i < TEST_CAPACITY(32); i++)
     {
         if ((ret = fifo_getLevel(pHandle)) != i) print_debuginfo(ret);
-        if ((ret = fifo_getEmptySpace(pHandle)) != 31 - i) print_debuginfo(ret);
+        if ((ret = fifo_getEmptySpace(pHandle)) != TEST_CAPACITY(32) - i) print_debuginfo(ret);
         fifo_skip_write(pHandle);
     }
-    for (uint8_t i = 0; i < 31; i++)
+    for (uint8_t i = 0; i < TEST_CAPACITY(32); i++)
     {
         fifo_skip_read(pHandle);
     }
-    for (uint8_t i = 0, ret; i < 31; i++)
+    for (uint8_t i = 0, ret; i < TEST_CAPACITY(32); i++)
     {
         if ((ret = fifo_getLevel(pHandle)) != i) print_debuginfo(ret);
-        if ((ret = fifo_getEmptySpace(pHandle)) != 31 - i) print_debuginfo(ret);
+        if ((ret = fifo_getEmptySpace(pHandle)) != TEST_CAPACITY(32) - i) print_debuginfo(ret);
         fifo_skip_write(pHandle);
     }
     fifo_deinit_free(pHandle);
@@ -131,7 +1787,7 @@ void testGetEndPtr(void)
 
     // ** Struct test **
     fifo_handle_t myHandle3;
-    fifo_handle_t fifo_buffer3[8];
+    struct { uint8_t a; uint16_t b; } fifo_buffer3[8];     // the handle itself is too big for a fifo with FIFO_SPSC
     fifo_init(&myHandle3, &fifo_buffer3, sizeof(fifo_buffer3), sizeof(fifo_buffer3[0]));
 
     if (fifo_getEndPtr(&myHandle3) != &fifo_buffer3[7]) print_debugs("");
@@ -142,7 +1798,7 @@ void testGetEndPtr(void)
 void testHasElementsLeft(void)
 {
     #define TEST_TYPE uint32_t
-	#define TEST_BUFSIZE 11
+	#define TEST_BUFSIZE 16
 
 	fifo_handle_t *pHandle = fifo_init_malloc(TEST_BUFSIZE, sizeof(TEST_TYPE));
     if (pHandle == NULL)
@@ -153,7 +1809,7 @@ void testHasElementsLeft(void)
 	if (fifo_hasElementsLeft(pHandle)) 	print_debugs("");
 	if (!fifo_hasSpaceLeft(pHandle)) 	print_debugs("");
 
-	for (uint8_t i = 0; i < (TEST_BUFSIZE -1); i++)
+	for (uint8_t i = 0; i < TEST_CAPACITY(TEST_BUFSIZE) -1; i++)
 	{
 		if (!fifo_hasSpaceLeft(pHandle)) 	print_debugs("");
         fifo_skip_write(pHandle);
@@ -175,9 +1831,9 @@ void testHasElementsLeft(void)
 void testPutAndGet(void)
 {	
     #define TEST_TYPE uint32_t
-	#define TEST_TIMES 100	// this is only accurate when being a multiple of (TEST_BUFSIZE -1)
-	#define TEST_BUFSIZE 11
-    fifo_handle_t *pHandle = fifo_init_malloc(TEST_BUFSIZE * sizeof(TEST_TYPE), sizeof(TEST_TYPE));
+	#define TEST_TIMES 240	// this is only accurate when being a multiple of TEST_CAPACITY(TEST_BUFSIZE)
+	#define TEST_BUFSIZE 16
+    fifo_handle_t *pHandle = fifo_init_malloc(TEST_BUFSIZE, sizeof(TEST_TYPE));
 	TEST_TYPE tx, should, rcv = 0xf, dummyTestType;
 	if (pHandle == NULL)
 	{
@@ -186,18 +1842,18 @@ void testPutAndGet(void)
 	}
     printf("Test of fifo_put() and fifo_get() started\n");
 	/* This test pushes data into the fifo and then reads it out of the fifo, it always fills up the fifo and empties it afterwards */
-	for (uint32_t i = 0; i < TEST_TIMES / (TEST_BUFSIZE -1); i++)
+	for (uint32_t i = 0; i < TEST_TIMES / TEST_CAPACITY(TEST_BUFSIZE); i++)
 	{
 		// ** put data into the buffer **
-		for (uint32_t j = 0; j < (TEST_BUFSIZE-1); j++)	// load the buffer
+		for (uint32_t j = 0; j < TEST_CAPACITY(TEST_BUFSIZE); j++)	// load the buffer
 		{
-			tx = i * (TEST_BUFSIZE -1) + j;
+			tx = i * TEST_CAPACITY(TEST_BUFSIZE) + j;
 			fifo_put(pHandle, &tx);	
 		}
 		// ** get the data
-		for (uint32_t j = 0; j < (TEST_BUFSIZE-1); j++)
+		for (uint32_t j = 0; j < TEST_CAPACITY(TEST_BUFSIZE); j++)
 		{
-			should = i * (TEST_BUFSIZE -1) + j;
+			should = i * TEST_CAPACITY(TEST_BUFSIZE) + j;
 			fifo_get(pHandle, &rcv);
 			// ** Check the data **
 			if (rcv != should)
@@ -206,6 +1862,7 @@ void testPutAndGet(void)
 			}
 		}
 	}
+	fifo_deinit_free(pHandle);
 	printf("Test of fifo_put() and fifo_get() ended\n");
     #undef TEST_TYPE
     #undef TEST_TIMES
@@ -225,9 +1882,11 @@ void testGet(void)
 	printf("Test of fifo_get() started\n");
 	if ((return_value_fifoerror = fifo_get(pHandle, NULL)) 		!= FIFO_WRONG_PARAM) 	print_debugs(""); // bad call
 	if ((return_value_fifoerror = fifo_get(NULL, 	&dummy8)) 	!= FIFO_WRONG_PARAM) 	print_debugs(""); // bad call
+#if !FIFO_SPSC
 	pHandle->_lock = 0x2;	// read lock
 	if ((return_value_fifoerror = fifo_get(pHandle, &dummy8)) 	!= FIFO_BUISY) print_debuginfo(return_value_fifoerror),			print_debugs(""); // call while locked
 	pHandle->_lock = 0;		// unlock
+#endif
 	if (dummy8 != TESTVALUE) print_debugs("dummy8 got written to illegaly by fifo_get()");
 	if ((return_value_fifoerror = fifo_get(pHandle, &dummy8)) 	!= FIFO_NO_ERROR)		print_debugs(""); // good call
 	if (dummy8 != '\0') print_debugs("fifo_get() doesn't work");
@@ -249,11 +1908,13 @@ void testFlush(void)
 	printf("Test of fifo_flush() started\n");
 	while(fifo_put(pHandle, "E") != FIFO_FULL);	// fill up the fifo
 	if ((return_value_fifoerror = fifo_flush(NULL)) != FIFO_WRONG_PARAM) 	print_debugs("");	// bad call
+#if !FIFO_SPSC
 	pHandle->_lock = 0x1;	// write lock
 	if ((return_value_fifoerror = fifo_flush(pHandle)) != FIFO_BUISY) 		print_debugs("");	// call while locked
 	pHandle->_lock = 0x2;	// read lock
 	if ((return_value_fifoerror = fifo_flush(pHandle)) != FIFO_BUISY) 		print_debugs("");	// call while locked
 	pHandle->_lock = 0;		// unlock
+#endif
 	if ((return_value_fifoerror = fifo_flush(pHandle)) != FIFO_NO_ERROR) 	print_debugs("");	// good call
 	if (pHandle->read_idx != pHandle->write_idx) 							print_debugs("fifo_flush() does not work correctly");
 	printf("Test of fifo_flush() ended\n");
@@ -273,18 +1934,21 @@ void testPut(void)
 	if ((return_value_fifoerror = fifo_put(NULL, 	&string_test[1])) 	!= FIFO_WRONG_PARAM) 	print_debugs("");	// null pointer handle
 	if ((return_value_fifoerror = fifo_put(pHandle, NULL)) 				!= FIFO_WRONG_PARAM) 	print_debugs("");	// null pointer data
 	
+#if !FIFO_SPSC
 	pHandle->_lock |= 0x01;	// write lock
 	if ((return_value_fifoerror = fifo_put(pHandle, &string_test[1])) 	!= FIFO_BUISY) 			print_debugs("");	// handle locked
 	pHandle->_lock &= ~(0x01); 	// disable write lock
+#endif
 
-	for (uint8_t i = 0; i < (TESTFIFO_SIZE -1); i++)	// the fifo can only store size -1 elements
+	for (uint8_t i = 0; i < TEST_CAPACITY(TESTFIFO_SIZE); i++)	// without FIFO_POW2 the fifo can only store size -1 elements
 	{
 		if ((return_value_fifoerror = fifo_put(pHandle, &string_test[i])) != FIFO_NO_ERROR) 	print_debugs(""); // fill up the fifo
 	}
 
-	if ((return_value_fifoerror = fifo_put(pHandle, &string_test[7])) != FIFO_FULL) 	print_debugs("");	// now the fifo is full
+	if ((return_value_fifoerror = fifo_put(pHandle, &string_test[8])) != FIFO_FULL) 	print_debugs("");	// now the fifo is full
 	fifo_get(pHandle, &dummy);	// empty the fifo by one
-	if ((return_value_fifoerror = fifo_put(pHandle, &string_test[7])) != FIFO_NO_ERROR) print_debugs("");	// now write again
+	if ((return_value_fifoerror = fifo_put(pHandle, &string_test[8])) != FIFO_NO_ERROR) print_debugs("");	// now write again
+	fifo_deinit_free(pHandle);
 	printf("Test of fifo_put() ended\n");
 }
 
@@ -298,7 +1962,7 @@ void testDeinitFree(void)
 	// ** Memory leek test **
 	for (uint32_t i = 0; i < 1000000; i++)
 	{
-		pHandle = fifo_init_malloc(MAX_FIFO_SIZE, FIFO_MAX_BASETYPE_SIZE);
+		pHandle = fifo_init_malloc(MAX_FIFO_SIZE / FIFO_MAX_BASETYPE_SIZE, FIFO_MAX_BASETYPE_SIZE);
 		fifo_deinit_free(pHandle);
 	}
 	printf("Check memory usage of the test_fifo task\nPress enter to end the test\n");
@@ -323,11 +1987,42 @@ void testInitMalloc(void)
 	if (pHandle->read_idx != 0) 					print_debugs("");
 	if (pHandle->size != 16 * sizeof(uint32_t)) 	print_debugs("");
 	if (pHandle->write_idx != 0) 					print_debugs("");
+#if !FIFO_SPSC
 	if (pHandle->_lock != 0) 						print_debugs("");
+#endif
 	fifo_deinit_free(pHandle);	// cleanup
 	printf("Test of fifo_init_malloc() ended\n");    
 }
 
+void testInitMallocAligned(void)
+{
+	fifo_handle_t *pHandle;
+	uint32_t rcv;
+	printf("Test of fifo_init_malloc_aligned() started\n");
+	if (fifo_init_malloc_aligned(16, sizeof(uint32_t), 48) != NULL) print_debugs("");	// not a power of two
+	if (fifo_init_malloc_aligned(16, sizeof(uint32_t), 2) != NULL) print_debugs("");		// smaller than a pointer
+	for (size_t alignment = 64; alignment <= 4096; alignment *= 4)
+	{
+		if ((pHandle = fifo_init_malloc_aligned(16, sizeof(uint32_t), alignment)) == NULL)
+		{
+			print_debuginfo((int)alignment);
+			continue;
+		}
+		if ((uintptr_t)pHandle % alignment != 0) print_debuginfo((int)alignment);
+		if ((uintptr_t)pHandle->pFifo % alignment != 0) print_debuginfo((int)alignment);
+		if ((uint8_t *)pHandle->pFifo - (uint8_t *)pHandle >= (ptrdiff_t)(sizeof(*pHandle) + alignment)) print_debuginfo((int)alignment);	// one block
+		for (uint32_t i = 0; fifo_put(pHandle, &i) == FIFO_NO_ERROR; i++);
+		for (uint32_t i = 0; fifo_get(pHandle, &rcv) == FIFO_NO_ERROR; i++)
+		{
+			if (rcv != i) print_debuginfo(i);
+		}
+		fifo_deinit_free(pHandle);
+	}
+	if ((pHandle = fifo_init_malloc(16, sizeof(uint32_t))) == NULL || (uintptr_t)pHandle->pFifo % FIFO_CACHE_LINE_SIZE != 0) print_debugs("");
+	fifo_deinit_free(pHandle);
+	printf("Test of fifo_init_malloc_aligned() ended\n");
+}
+
 void testInit(void)
 {
     fifo_handle_t myHandle;
@@ -349,7 +2044,9 @@ void testInit(void)
 	if (myHandle.read_idx != 0) 						print_debugs("");
 	if (myHandle.size != sizeof(myFifo)) 				print_debugs("");
 	if (myHandle.write_idx != 0) 						print_debugs("");
+#if !FIFO_SPSC
 	if (myHandle._lock != 0) 							print_debugs("");
+#endif
 	printf("Test of fifo_init() ended\n");
 }
 
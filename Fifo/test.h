@@ -8,10 +8,37 @@
 #define print_debuginfo(return_value)	(printf("%sFile: %s, line: %i, returned %i%s\n", ANSI_COLOR_RED,__FILE__, __LINE__, return_value, ANSI_COLOR_RESET))
 #define print_debugs(s)					(printf("%sFile: %s, line: %i, %s%s\n", ANSI_COLOR_RED,__FILE__, __LINE__, s, ANSI_COLOR_RESET))
 
+// elements a fifo of size elements can hold, with FIFO_POW2 all of them, else one slot stays free
+#if FIFO_POW2
+#define TEST_CAPACITY(size)				(size)
+#else
+#define TEST_CAPACITY(size)				((size) -1)
+#endif
+
 void test_init(void);
 void enterCritical(void);
 void leaveCritical(void);
 void printCritical(void);
+void testBroadcast(void);
+void testDeque(void);
+void testEventfd(void);
+void testEventfdWakeup(void);
+void testSet(void);
+void testPrio(void);
+void testBank(void);
+void testSpill(void);
+void testShm(void);
+void testMirror(void);
+void testOverwrite(void);
+void testWait(void);
+void testWide(void);
+void testPow2(void);
+void testReserveCommit(void);
+void testRecord(void);
+void testDrain(void);
+void testPutGetN(void);
+void testMpmc(void);
+void testSpscThreads(void);
 void testSkipWrite(void);
 void testSkipRead(void);
 void testGetLevel(void);
@@ -23,4 +50,5 @@ void testFlush(void);
 void testPut(void);
 void testDeinitFree(void);
 void testInitMalloc(void);
+void testInitMallocAligned(void);
 void testInit(void);